@@ -4,6 +4,34 @@
 // --> report ID for keyboard.
 #define RID_KEYBOARD 1
 
+// --> HID endpoint polling interval in ms, also the fast macro step.
+#define USBD_HID_POLL_MS 5
+
+// --> scan the key matrix with PIO and DMA instead of the CPU.
+#ifndef KBD_USE_PIO_SCANNER
+#define KBD_USE_PIO_SCANNER 0
+#endif
+
+// --> repeat held keys in the firmware instead of the host.
+#ifndef KBD_USE_TYPEMATIC
+#define KBD_USE_TYPEMATIC 0
+#endif
+
+// --> hold back combo keys for chords, see kbd/handlers/combo.cpp.
+#ifndef KBD_USE_COMBOS
+#define KBD_USE_COMBOS 0
+#endif
+
+// --> scan from a repeating hardware alarm instead of the main loop.
+// the basic scanner busy-waits 2 x 10 us per row, ~100 us a scan: at the
+// 125 us fast rate that is ~80% of core0 in the interrupt, so only the PIO
+// scanner (a few us a scan) is paced by the alarm by default. the PIO
+// scanner is off by default too, so the default build still scans from the
+// main loop and its scan jitter is not bounded by the alarm.
+#ifndef KBD_USE_SCAN_TIMER
+#define KBD_USE_SCAN_TIMER KBD_USE_PIO_SCANNER
+#endif
+
 enum {
 
     GPIO_KBD_ROW_1 = 0,
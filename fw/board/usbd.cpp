@@ -3,6 +3,7 @@
 #include "usbd/hid_notifier.h"
 #include "../kbd/kbd.h"
 #include "../tft/tft.h"
+#include "../task/coro.h"
 #include <tusb.h>
 
 CFG_TUD_EXTERN void tud_mount_cb(void) {
@@ -103,6 +104,9 @@ void Usbd::setMounted(bool value) {
         _rpos = _wpos = 0;
         _rlen = 0;
     }
+
+    // --> resume coroutines waiting for mount state.
+    Coro::notifyMounted(value);
 }
 
 void Usbd::pushRbuf(uint8_t* buf, uint32_t len) {
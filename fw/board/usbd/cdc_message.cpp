@@ -3,7 +3,16 @@
 #include "../../kbd/kbd.h"
 #include "../../kbd/scancode.h"
 #include "../../kbd/handlers/userfn.h"
+#include "../../kbd/handlers/layer.h"
+#include "../../kbd/handlers/macro.h"
 #include "../../tft/tft.h"
+#include "../../task/taskstats.h"
+#include "../../kbd/latency.h"
+#include "../../kbd/scanners/basic.h"
+#include "../../kbd/pacer.h"
+#include "../../kbd/trace.h"
+#include "../../kbd/scanners/replay.h"
+#include "../config.h"
 #include "pico/bootrom.h"
 #include <string.h>
 
@@ -120,6 +129,34 @@ void UsbdCdcMessage::invoke() {
             onResetUfn();
             break;
 
+        case ECMD_GET_TASK_STATS: // --> GET_TASK_STATS:
+            onGetTaskStats();
+            break;
+
+        case ECMD_GET_KBD_LATENCY:
+            onGetKbdLatency();
+            break;
+
+        case ECMD_GET_SCAN_RATE:
+            onGetScanRate();
+            break;
+
+        case ECMD_GET_SCAN_JITTER:
+            onGetScanJitter();
+            break;
+
+        case ECMD_TRACE:
+            onTrace();
+            break;
+
+        case ECMD_UFN_HOLD:
+            onUfnHold();
+            break;
+
+        case ECMD_MACRO:
+            onMacro();
+            break;
+
         case ECMD_FLASH_MODE: // --> FLASH_MODE:
             onFlashMode();
             break;
@@ -308,6 +345,272 @@ void UsbdCdcMessage::onResetUfn() {
     UsbdTransmitEchoReply(_data, _len);
 }
 
+void UsbdCdcMessage::onGetTaskStats() {
+    // --> page 0: counters, 1-4: exec histogram, 5-8: redraw histogram.
+    //     page 9: redraw count and total redraw time.
+    uint32_t words[4] = { 0, };
+    const uint8_t page = _len > 0 ? _data[0] : 0;
+
+    STaskStats stats;
+    TaskStats::get()->snapshot(stats);
+
+    if (page == 0) {
+        words[0] = stats.enqueued;
+        words[1] = stats.enqueueFails;
+        words[2] = stats.ringHwm;   // --> deepest single ring.
+        words[3] = stats.executed;
+    }
+
+    else if (page <= 4) {
+        memcpy(words, &stats.execHist[(page - 1) * 4], sizeof(words));
+    }
+
+    else if (page <= 8) {
+        memcpy(words, &stats.redrawHist[(page - 5) * 4], sizeof(words));
+    }
+
+    else if (page == 9) {
+        words[0] = stats.redraws;
+        words[1] = uint32_t(stats.redrawUs);
+        words[2] = uint32_t(stats.redrawUs >> 32);
+    }
+
+    // --> little endian, same as the MCU.
+    UsbdTransmitEchoReply((uint8_t*) words, sizeof(words));
+}
+
+void UsbdCdcMessage::onGetKbdLatency() {
+    // --> data[0]: stage, data[1]: page.
+    //     page 0: count, min, max, p50. page 1: p90, p99, event drops, peak.
+    uint32_t words[4] = { 0, };
+    const uint8_t stage = _len > 0 ? _data[0] : 0;
+    const uint8_t page = _len > 1 ? _data[1] : 0;
+
+    SKbdLatency stats;
+    if (KbdLatency::get()->query(EKbdLatencyStage(stage), stats)) {
+        if (page == 0) {
+            words[0] = stats.count;
+            words[1] = stats.min;
+            words[2] = stats.max;
+            words[3] = stats.p50;
+        }
+
+        else {
+            const KbdEventRing* events = Kbd::get()->getEvents();
+
+            words[0] = stats.p90;
+            words[1] = stats.p99;
+            words[2] = events->getDrops();
+            words[3] = events->getPeak();
+        }
+    }
+
+    UsbdTransmitEchoReply((uint8_t*) words, sizeof(words));
+}
+
+void UsbdCdcMessage::onGetScanRate() {
+    // --> page 0: rate (Hz), period (us), level, scans.
+    //     page 1-2: time in each level, milliseconds.
+    uint32_t words[4] = { 0, };
+
+#if !KBD_USE_PIO_SCANNER
+    // --> the PIO scanner runs at a fixed rate: all zeros.
+    const uint8_t page = _len > 0 ? _data[0] : 0;
+    const KbdScanGovernor* governor = KbdBasicScanner::instance()->getGovernor();
+
+    if (page == 0) {
+        words[0] = governor->getRate();
+        words[1] = governor->getPeriod();
+        words[2] = governor->getLevel();
+        words[3] = governor->getScans();
+    }
+
+    else if (page <= 2) {
+        for(uint32_t i = 0; i < 4; ++i) {
+            const uint32_t level = (page - 1) * 4 + i;
+            words[i] = uint32_t(governor->getTimeIn(level) / 1000);
+        }
+    }
+#endif
+
+    UsbdTransmitEchoReply((uint8_t*) words, sizeof(words));
+}
+
+void UsbdCdcMessage::onGetScanJitter() {
+    // --> page 0: ticks, overruns, max late, max early (us).
+    //     page 1-4: |deviation| histogram, log2 us buckets.
+    uint32_t words[4] = { 0, };
+    const uint8_t page = _len > 0 ? _data[0] : 0;
+
+    SKbdJitter stats;
+    KbdScanPacer::get()->getJitter()->snapshot(stats);
+
+    if (page == 0) {
+        words[0] = stats.ticks;
+        words[1] = stats.overruns;
+        words[2] = stats.maxLate;
+        words[3] = stats.maxEarly;
+    }
+
+    else if (page <= 4) {
+        memcpy(words, &stats.hist[(page - 1) * 4], sizeof(words));
+    }
+
+    UsbdTransmitEchoReply((uint8_t*) words, sizeof(words));
+}
+
+void UsbdCdcMessage::onTrace() {
+    // --> data[0]: 0 start, 1 stop, 2 header, 3 records, 4 replay.
+    //     header: magic, version, count, drops.
+    //     records: two records from the index at data[1..2].
+    uint32_t words[4] = { 0, };
+    const uint8_t op = _len > 0 ? _data[0] : 2;
+
+    KbdTraceRecorder* recorder = KbdTraceRecorder::get();
+    KbdReplayScanner* replay = KbdReplayScanner::instance();
+
+    // --> the replay may be reading the recorded buffer.
+    if (op == 0 && !replay->isPlaying()) {
+        recorder->start(time_us_32());
+    }
+
+    else if (op == 1) {
+        recorder->stop();
+    }
+
+    else if (op == 3) {
+        const uint32_t index = _len > 2 ? (_data[1] | (_data[2] << 8)) : 0;
+
+        STraceRecord records[2];
+        memset(records, 0, sizeof(records));
+
+        recorder->getRecord(index, records[0]);
+        recorder->getRecord(index + 1, records[1]);
+        memcpy(words, records, sizeof(words));
+    }
+
+    else if (op == 4) {
+        // --> replay what was recorded, in real time.
+        recorder->stop();
+
+        if (replay->load(recorder->getRecords(), recorder->size()) && replay->play()) {
+            // --> the idle scan waits for a column edge: resume now.
+            Kbd::get()->getIdle()->wake();
+        }
+    }
+
+    if (op != 3) {
+        const STraceHeader header = recorder->getHeader();
+
+        words[0] = header.magic;
+        words[1] = header.version;
+        words[2] = header.count;
+        words[3] = recorder->getDrops();
+    }
+
+    UsbdTransmitEchoReply((uint8_t*) words, sizeof(words));
+}
+
+void UsbdCdcMessage::onUfnHold() {
+    // --> request: UFN_NO, [HOLD_MOD, TERM_LO, TERM_HI, [RULE, [LAYER]]], zero TERM: tap only.
+    //     reply: ERROR_CODE, UFN_NO, HOLD_MOD, TERM_LO, TERM_HI, RULE, LAYER (0xff: none)
+    uint8_t data[7] = { 0, };
+    KbdTapHold* tapHold = Kbd::get()->getTapHold();
+    KbdLayerHandler* layers = KbdLayerHandler::instance();
+
+    const uint8_t ufn = _len > 0 ? _data[0] : 0xff;
+    const EKey key = KbdUserFnHandler::keyOf(ufn);
+
+    const uint8_t layer = _len >= 6 ? _data[5] : EKLY_INVALID;
+
+    // --> validate the whole request first: nothing is applied on an error.
+    if (_len < 1 || (_len > 1 && _len < 4)) {
+        data[0] = ECERR_INV_LEN;
+    }
+
+    else if (key == EKEY_INV) {
+        data[0] = ECERR_INV_UFN;
+    }
+
+    else if (_len >= 5 && _data[4] >= EKHR_MAX_VALUE) {
+        data[0] = ECERR_INV_RULE;
+    }
+
+    else if (layer != EKLY_INVALID && (layer == EKLY_BASE || layer >= EKLY_MAX)) {
+        data[0] = ECERR_INV_LAYER;
+    }
+
+    else if (_len >= 4) {
+        tapHold->setHold(key, _data[1], _data[2] | (_data[3] << 8));
+
+        if (_len >= 5) {
+            tapHold->setRule(EKeyHoldRule(_data[4]));
+        }
+
+        if (_len >= 6) {
+            if (layer == EKLY_INVALID) {
+                layers->setAction(key, EKLA_NONE, EKLY_INVALID);
+            }
+
+            else {
+                layers->setAction(key, EKLA_MOMENTARY, EKeyLayer(layer));
+            }
+        }
+    }
+
+    data[1] = ufn;
+
+    if (data[0] == ECERR_SUCCESS) {
+        const uint16_t term = tapHold->getTerm(key);
+
+        data[2] = tapHold->getHoldMod(key);
+        data[3] = uint8_t(term & 0xff);
+        data[4] = uint8_t(term >> 8);
+        data[5] = tapHold->getRule();
+        data[6] = layers->getActionLayer(key);
+    }
+
+    UsbdTransmitEchoReply(data, sizeof(data));
+}
+
+void UsbdCdcMessage::onMacro() {
+    // --> data[0]: 0 status, 1 record, 2 play, 3 play fast, 4 stop.
+    //     reply: state, mode, size in bytes, steps.
+    uint32_t words[4] = { 0, };
+    const uint8_t op = _len > 0 ? _data[0] : 0;
+
+    Kbd* kbd = Kbd::get();
+    KbdMacroHandler* macro = KbdMacroHandler::instance();
+
+    switch(op) {
+        case 1:
+            macro->record();
+            break;
+
+        case 2:
+            macro->play(kbd, EKMM_ORIGINAL);
+            break;
+
+        case 3:
+            macro->play(kbd, EKMM_FAST);
+            break;
+
+        case 4:
+            macro->stop(kbd);
+            break;
+
+        default:
+            break;
+    }
+
+    words[0] = macro->getState();
+    words[1] = macro->getMode();
+    words[2] = macro->getMacro()->size();
+    words[3] = macro->getMacro()->getSteps();
+
+    UsbdTransmitEchoReply((uint8_t*) words, sizeof(words));
+}
+
 void UsbdCdcMessage::onFlashMode() {
     UsbdTransmitEchoReply(_data, _len);
     sleep_ms(100);
@@ -9,6 +9,13 @@ enum {
     ECMD_GET_UFN = 0x01,
     ECMD_SET_UFN = 0x02,
     ECMD_RESET_UFN = 0x03,
+    ECMD_GET_TASK_STATS = 0x04,
+    ECMD_GET_KBD_LATENCY = 0x05,
+    ECMD_GET_SCAN_RATE = 0x06,
+    ECMD_GET_SCAN_JITTER = 0x07,
+    ECMD_TRACE = 0x08,
+    ECMD_UFN_HOLD = 0x09,
+    ECMD_MACRO = 0x0a,
     ECMD_FLASH_MODE = 0x7f,
 
     // -- notifications.
@@ -22,6 +29,8 @@ enum {
     ECERR_INV_UFN = 2,
     ECERR_INV_KEY = 3,  // invalid scan code.
     ECERR_INV_TM  = 4,  // invalid toggle mode.
+    ECERR_INV_LAYER = 5,
+    ECERR_INV_RULE = 6, // invalid tap-hold rule.
 };
 
 /**
@@ -85,6 +94,13 @@ private:
     void onGetUfn();
     void onSetUfn();
     void onResetUfn();
+    void onGetTaskStats();
+    void onGetKbdLatency();
+    void onGetScanRate();
+    void onGetScanJitter();
+    void onTrace();
+    void onUfnHold();
+    void onMacro();
     void onFlashMode();
 };
 
@@ -64,7 +64,7 @@ const uint8_t g_usbd_conf[] = {
     TUD_CDC_DESCRIPTOR(ITF_NUM_CDC, 4, EPNUM_CDC_NOTIF, 8, 0x80 | EPNUM_CDC_DATA, EPNUM_CDC_DATA, 64),
 
     // --> interface number, string index, protocol, report descriptor len, EP In address, size & polling interval
-    TUD_HID_DESCRIPTOR(ITF_NUM_HID, 0, HID_ITF_PROTOCOL_NONE, sizeof(g_usbd_hid_report), EPNUM_HID, CFG_TUD_HID_EP_BUFSIZE, 5),
+    TUD_HID_DESCRIPTOR(ITF_NUM_HID, 0, HID_ITF_PROTOCOL_NONE, sizeof(g_usbd_hid_report), EPNUM_HID, CFG_TUD_HID_EP_BUFSIZE, USBD_HID_POLL_MS),
 
 };
 
@@ -3,12 +3,20 @@
 #include "../config.h"
 #include "../usbd.h"
 #include "../../kbd/scancode.h"
+#include "../../kbd/latency.h"
 #include "../../tft/tft.h"
+#include "pico/stdlib.h"
 #include <string.h>
 
 UsbdHidNotifier::UsbdHidNotifier() {
     memset(_keycodes, 0, sizeof(_keycodes));
     _modifier = 0;
+    _queued = 0;
+    _behind = 0;
+}
+
+CFG_TUD_EXTERN void tud_hid_report_complete_cb(uint8_t instance, uint8_t const* report, uint16_t len) {
+    UsbdHidNotifier::onReportComplete();
 }
 
 UsbdHidNotifier *UsbdHidNotifier::instance() {
@@ -27,7 +35,9 @@ void UsbdHidNotifier::onPostKeyNotify(const Kbd *kbd) {
     }
 
     uint8_t keycodes[MAX_REPORT_KEYS] = {0, };
+    uint8_t released[MAX_REPORT_KEYS] = {0, };
     uint8_t modifier = 0;
+    uint8_t repeats = 0;
 
     // --> get current pressing keys.
     uint8_t count = kbd->getPressingKeys(keys, 6);
@@ -40,6 +50,15 @@ void UsbdHidNotifier::onPostKeyNotify(const Kbd *kbd) {
 
         const SKeyChar ch = kbd->getKeyChar(keys[i]);
         if (ch.kc != KC_NONE) {
+            // --> repeated keys: the host must see a release first.
+            if (kbd->isKeyRepeat(keys[i])) {
+                repeats++;
+            }
+
+            else {
+                released[index - repeats] = ch.kc;
+            }
+
             keycodes[index++] = ch.kc;
         }
 
@@ -48,6 +67,31 @@ void UsbdHidNotifier::onPostKeyNotify(const Kbd *kbd) {
         }
     }
 
+    if (repeats) {
+        notifyHid(released, modifier);
+    }
+
+    // --> released keys held back by handlers: press them once first.
+    uint32_t taps = kbd->getTapKeys();
+    if (taps) {
+        uint8_t tapped[MAX_REPORT_KEYS];
+        uint8_t tapMod = modifier;
+
+        memcpy(tapped, keycodes, sizeof(tapped));
+
+        for(uint8_t n = index; taps && n < MAX_REPORT_KEYS; taps &= taps - 1) {
+            const SKeyChar ch = kbd->getKeyChar(EKey(__builtin_ctz(taps)));
+
+            if (ch.kc != KC_NONE) {
+                tapped[n++] = ch.kc;
+            }
+
+            tapMod |= ch.mod;
+        }
+
+        notifyHid(tapped, tapMod);
+    }
+
     notifyHid(keycodes, modifier);
 }
 
@@ -60,9 +104,165 @@ void UsbdHidNotifier::onUnlisten() {
 }
 
 void UsbdHidNotifier::notifyHid(uint8_t keycodes[6], uint8_t modifier) {
+    SReport next;
+
+    memcpy(next.keycodes, keycodes, MAX_REPORT_KEYS);
+    next.modifier = modifier;
+
+    // --> flushed later from the completion callback: keep the origin.
+    next.hasOrigin = KbdLatency::get()->getOrigin(next.origin) ? 1 : 0;
+    pushReport(next);
+}
+
+void UsbdHidNotifier::pushReport(const SReport& next) {
+    const SReport* last = _queued ? &_queue[_queued - 1] : nullptr;
+    const uint8_t* prev = last ? last->keycodes : _keycodes;
+
+    // --> a newer state replaces the one held back.
+    _behind = 0;
+
     // --> report if any keys are changed.
-    if (memcmp(_keycodes, keycodes, sizeof(_keycodes)) != 0 || _modifier != modifier) {
-        memcpy(_keycodes, keycodes, sizeof(_keycodes)); _modifier = modifier;
-        tud_hid_keyboard_report(RID_KEYBOARD, modifier, keycodes);
+    if (memcmp(prev, next.keycodes, MAX_REPORT_KEYS) == 0 && (last ? last->modifier : _modifier) == next.modifier) {
+        return;
+    }
+
+    if (_queued >= MAX_QUEUED && dropOnce(next) == false) {
+        // --> every report presses a key: hold them all down in the newest,
+        //     then report the actual state once the queue drains.
+        merge(_queue[_queued - 1], next);
+        _latest = next;
+        _behind = 1;
+    }
+
+    else {
+        _queue[_queued++] = next;
+    }
+
+    flushOnce();
+}
+
+void UsbdHidNotifier::flushOnce() {
+    if (_queued == 0 || tud_hid_ready() == false) {
+        return;
+    }
+
+    SReport& report = _queue[0];
+    if (tud_hid_keyboard_report(RID_KEYBOARD, report.modifier, report.keycodes) == false) {
+        return;
+    }
+
+    memcpy(_keycodes, report.keycodes, sizeof(_keycodes));
+    _modifier = report.modifier;
+
+    // --> from the GPIO sample of the oldest key the report carries.
+    if (report.hasOrigin) {
+        KbdLatency::get()->record(EKLT_HID, time_us_32() - report.origin);
+    }
+
+    memmove(_queue, _queue + 1, sizeof(SReport) * (--_queued));
+
+    if (_behind) {
+        pushReport(_latest);
+    }
+}
+
+bool UsbdHidNotifier::dropOnce(const SReport& next) {
+    SReport sent;
+    memcpy(sent.keycodes, _keycodes, MAX_REPORT_KEYS);
+    sent.modifier = _modifier;
+
+    // --> oldest first: the host sees the intermediate states it can.
+    for(uint8_t i = 0; i < _queued; ++i) {
+        const SReport& prev = i ? _queue[i - 1] : sent;
+        const SReport& after = i + 1 < _queued ? _queue[i + 1] : next;
+
+        if (isBetween(prev, _queue[i], after)) {
+            const SReport dropped = _queue[i];
+
+            memmove(_queue + i, _queue + i + 1, sizeof(SReport) * (--_queued - i));
+            _queue[_queued++] = next;
+
+            // --> its changes are carried by the report after it.
+            inherit(_queue[i], dropped);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool UsbdHidNotifier::isBetween(const SReport& prev, const SReport& report, const SReport& next) {
+    // --> presses in the report are still pressed in the next one.
+    if (report.modifier & ~(prev.modifier | next.modifier)) {
+        return false;
+    }
+
+    // --> releases in the report are still released in the next one.
+    if (prev.modifier & next.modifier & ~report.modifier) {
+        return false;
+    }
+
+    for(uint8_t i = 0; i < MAX_REPORT_KEYS; ++i) {
+        const uint8_t kc = report.keycodes[i];
+
+        if (kc != KC_NONE && !contains(prev, kc) && !contains(next, kc)) {
+            return false;
+        }
+    }
+
+    for(uint8_t i = 0; i < MAX_REPORT_KEYS; ++i) {
+        const uint8_t kc = prev.keycodes[i];
+
+        if (kc != KC_NONE && contains(next, kc) && !contains(report, kc)) {
+            return false;
+        }
     }
-}
\ No newline at end of file
+
+    return true;
+}
+
+bool UsbdHidNotifier::contains(const SReport& report, uint8_t kc) {
+    for(uint8_t i = 0; i < MAX_REPORT_KEYS; ++i) {
+        if (report.keycodes[i] == kc) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void UsbdHidNotifier::merge(SReport& report, const SReport& from) {
+    report.modifier |= from.modifier;
+
+    for(uint8_t i = 0, n = 0; i < MAX_REPORT_KEYS; ++i) {
+        const uint8_t kc = from.keycodes[i];
+
+        if (kc == KC_NONE || contains(report, kc)) {
+            continue;
+        }
+
+        // --> into the next free slot, if any.
+        while(n < MAX_REPORT_KEYS && report.keycodes[n] != KC_NONE) {
+            n++;
+        }
+
+        if (n >= MAX_REPORT_KEYS) {
+            break;
+        }
+
+        report.keycodes[n] = kc;
+    }
+
+    inherit(report, from);
+}
+
+void UsbdHidNotifier::inherit(SReport& report, const SReport& from) {
+    if (from.hasOrigin == 0) {
+        return;
+    }
+
+    if (report.hasOrigin == 0 || int32_t(report.origin - from.origin) > 0) {
+        report.origin = from.origin;
+        report.hasOrigin = 1;
+    }
+}
@@ -14,6 +14,14 @@ class UsbdHidNotifier : public IKeyListener {
 
 private:
     static constexpr uint32_t MAX_REPORT_KEYS = 6;
+    static constexpr uint32_t MAX_QUEUED = 4;
+
+    struct SReport {
+        uint8_t keycodes[MAX_REPORT_KEYS];
+        uint8_t modifier;
+        uint8_t hasOrigin;
+        uint32_t origin;    // --> sample time of the oldest key in the report.
+    };
 
 public:
     ~UsbdHidNotifier() { }
@@ -28,6 +36,14 @@ private:
     uint8_t _keycodes[MAX_REPORT_KEYS];
     uint8_t _modifier;
 
+    // --> reports waiting for the endpoint, oldest first.
+    SReport _queue[MAX_QUEUED];
+    uint8_t _queued;
+
+    // --> the actual state, if merged into the newest report on overflow.
+    SReport _latest;
+    uint8_t _behind;
+
 public:
     /* called when any key notification must be issued. */
     virtual void onKeyNotify(const Kbd* kbd, EKey key, EKeyState state) override;
@@ -40,8 +56,33 @@ public:
     virtual void onUnlisten() override;
 
 private:
-    /* notify HID report. */
+    /* notify HID report, from the origin of the running dispatch. */
     void notifyHid(uint8_t keycodes[6], uint8_t modifier);
+
+    /* queue the report if it changes anything, then flush. */
+    void pushReport(const SReport& next);
+
+    /* submit the oldest queued report if the endpoint is ready. */
+    void flushOnce();
+
+    /* drop the oldest report that `next` makes redundant, returns false if none. */
+    bool dropOnce(const SReport& next);
+
+    /* test whether the report changes nothing between its neighbours. */
+    static bool isBetween(const SReport& prev, const SReport& report, const SReport& next);
+
+    /* test whether the report has the key code or not. */
+    static bool contains(const SReport& report, uint8_t kc);
+
+    /* add keys and modifiers of `from` into the report, as many as fit. */
+    static void merge(SReport& report, const SReport& from);
+
+    /* keep the older origin of `from` in the report. */
+    static void inherit(SReport& report, const SReport& from);
+
+public:
+    /* called when the previous report is delivered to the host. */
+    static void onReportComplete() { instance()->flushOnce(); }
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,155 @@
+#include "debounce.h"
+#include <string.h>
+
+KbdDebouncer::KbdDebouncer() {
+    memset(_states, 0, sizeof(_states));
+    _out = _unsettled = _last = 0;
+
+    setModeAll(EKDB_EAGER, DEFAULT_US);
+}
+
+bool KbdDebouncer::setMode(EKey key, EKeyDebounce mode, uint32_t us) {
+    if (key >= EKEY_MAX || mode >= EKDB_MAX_VALUE) {
+        return false;
+    }
+
+    _configs[key].mode = mode;
+    _configs[key].us = us;
+
+    // --> restart filtering from the current output.
+    _states[key].raw = _states[key].out;
+    _states[key].integ = _states[key].out ? us : 0;
+
+    settle(key);
+    return true;
+}
+
+void KbdDebouncer::setModeAll(EKeyDebounce mode, uint32_t us) {
+    for(uint8_t i = 0; i < EKEY_MAX; ++i) {
+        setMode(EKey(i), mode, us);
+    }
+}
+
+EKeyDebounce KbdDebouncer::getMode(EKey key) const {
+    if (key >= EKEY_MAX) {
+        return EKDB_NONE;
+    }
+
+    return EKeyDebounce(_configs[key].mode);
+}
+
+uint32_t KbdDebouncer::getWindow(EKey key) const {
+    if (key >= EKEY_MAX) {
+        return 0;
+    }
+
+    return _configs[key].us;
+}
+
+bool KbdDebouncer::filter(EKey key, bool raw, uint32_t now) {
+    if (key >= EKEY_MAX) {
+        return raw;
+    }
+
+    const SConfig& cfg = _configs[key];
+    SState& st = _states[key];
+
+    switch(cfg.mode) {
+        case EKDB_EAGER:
+            // --> accept an edge only after the lockout window.
+            if (raw != st.out && now - st.at >= cfg.us) {
+                st.out = raw;
+                st.at = now;
+            }
+            break;
+
+        case EKDB_DEFERRED:
+            // --> every raw edge restarts the stable window.
+            if (raw != st.raw) {
+                st.at = now;
+            }
+
+            if (raw != st.out && now - st.at >= cfg.us) {
+                st.out = raw;
+            }
+            break;
+
+        case EKDB_INTEGRATOR: {
+            const uint32_t dt = now - st.at;
+            st.at = now;
+
+            if (cfg.us == 0) {
+                st.out = raw;
+                break;
+            }
+
+            // --> saturate on [0, us].
+            if (raw) {
+                st.integ = (cfg.us - st.integ > dt) ? st.integ + dt : cfg.us;
+            }
+
+            else {
+                st.integ = st.integ > dt ? st.integ - dt : 0;
+            }
+
+            if (st.integ >= cfg.us) {
+                st.out = 1;
+            }
+
+            else if (st.integ == 0) {
+                st.out = 0;
+            }
+            break;
+        }
+
+        default:
+            st.out = raw;
+            break;
+    }
+
+    st.raw = raw;
+    settle(key);
+
+    return st.out != 0;
+}
+
+void KbdDebouncer::settle(EKey key) {
+    const SConfig& cfg = _configs[key];
+    const SState& st = _states[key];
+    const uint32_t bit = 1u << key;
+
+    bool settled = st.raw == st.out;
+    if (cfg.mode == EKDB_INTEGRATOR && cfg.us) {
+        settled = settled && st.integ == (st.out ? cfg.us : 0);
+    }
+
+    _out = st.out ? (_out | bit) : (_out & ~bit);
+    _unsettled = settled ? (_unsettled & ~bit) : (_unsettled | bit);
+}
+
+uint32_t KbdDebouncer::filterAll(uint32_t raw, uint32_t present, uint32_t now) {
+    uint32_t visit = ((raw ^ _out) | _unsettled) & present;
+
+    for(; visit; visit &= visit - 1) {
+        const EKey key = EKey(__builtin_ctz(visit));
+        const uint32_t bit = 1u << key;
+
+        // --> integrate from the last sample, not from when it settled.
+        if ((_unsettled & bit) == 0 && _configs[key].mode == EKDB_INTEGRATOR) {
+            _states[key].at = _last;
+        }
+
+        filter(key, (raw & bit) != 0, now);
+    }
+
+    _last = now;
+    return _out;
+}
+
+bool KbdDebouncer::peek(EKey key) const {
+    if (key >= EKEY_MAX) {
+        return false;
+    }
+
+    return _states[key].out != 0;
+}
@@ -0,0 +1,87 @@
+#ifndef __KBD_DEBOUNCE_H__
+#define __KBD_DEBOUNCE_H__
+
+#include <stdint.h>
+#include "keys.h"
+
+/**
+ * debounce algorithms. 
+ */
+enum EKeyDebounce {
+    EKDB_NONE = 0,          // --> raw level, no filtering.
+    EKDB_EAGER,             // --> report the first edge, then ignore bounces.
+    EKDB_DEFERRED,          // --> report after the level is stable.
+    EKDB_INTEGRATOR,        // --> integrate time spent on each level.
+    EKDB_MAX_VALUE
+};
+
+/**
+ * per-key debounce stage between scanners and `Kbd::updateOnce`.
+ */
+class KbdDebouncer {
+public:
+    static constexpr uint32_t DEFAULT_US = 5000;
+
+private:
+    /* per-key configuration. */
+    struct SConfig {
+        uint8_t mode;
+        uint32_t us;
+    };
+
+    /* per-key state. */
+    struct SState {
+        uint8_t raw;        // --> last raw level.
+        uint8_t out;        // --> debounced level.
+        uint32_t at;        // --> last edge, or last sample for integrator.
+        uint32_t integ;     // --> integrated high time, integrator only.
+    };
+
+private:
+    SConfig _configs[EKEY_MAX];
+    SState _states[EKEY_MAX];
+
+    /* debounced levels and keys still filtering, bit N: EKey(N). */
+    uint32_t _out;
+    uint32_t _unsettled;
+    uint32_t _last;         // --> last `filterAll` sample time.
+
+public:
+    KbdDebouncer();
+
+public:
+    /* set the debounce mode and window for the key. */
+    bool setMode(EKey key, EKeyDebounce mode, uint32_t us);
+
+    /* set the debounce mode and window for all keys. */
+    void setModeAll(EKeyDebounce mode, uint32_t us);
+
+    /* get the debounce mode of the key. */
+    EKeyDebounce getMode(EKey key) const;
+
+    /* get the debounce window of the key, in microseconds. */
+    uint32_t getWindow(EKey key) const;
+
+public:
+    /* feed a raw level sampled at `now` (us) and get the debounced level. */
+    bool filter(EKey key, bool raw, uint32_t now);
+
+    /**
+     * feed a raw key bitmap sampled at `now` (us) and get the debounced bitmap.
+     * only keys in `present` that differ from their output or are still
+     * filtering are visited, so a quiet matrix costs a few instructions.
+     */
+    uint32_t filterAll(uint32_t raw, uint32_t present, uint32_t now);
+
+    /* get the debounced level without sampling. */
+    bool peek(EKey key) const;
+
+    /* test whether every key settled on its debounced level or not. */
+    bool isSettled() const { return _unsettled == 0; }
+
+private:
+    /* refresh the bitmaps for the key. */
+    void settle(EKey key);
+};
+
+#endif
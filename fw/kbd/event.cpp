@@ -0,0 +1,49 @@
+#include "event.h"
+
+KbdEventRing::KbdEventRing()
+    : _rpos(0), _wpos(0)
+{
+    _pushed = 0;
+    _drops = 0;
+    _peak = 0;
+}
+
+bool KbdEventRing::push(const SKeyEvent& event) {
+    const uint32_t wpos = _wpos.load(std::memory_order_relaxed);
+    const uint32_t rpos = _rpos.load(std::memory_order_acquire);
+
+    // --> full: unsigned subtraction handles the counter overflow.
+    if (wpos - rpos >= MAX_EVENTS) {
+        _drops = _drops + 1;
+        return false;
+    }
+
+    _events[wpos & MASK] = event;
+
+    // --> publish the slot to the consumer.
+    _wpos.store(wpos + 1, std::memory_order_release);
+    _pushed = _pushed + 1;
+
+    if (wpos + 1 - rpos > _peak) {
+        _peak = wpos + 1 - rpos;
+    }
+
+    return true;
+}
+
+bool KbdEventRing::pop(SKeyEvent* outEvent) {
+    const uint32_t rpos = _rpos.load(std::memory_order_relaxed);
+    const uint32_t wpos = _wpos.load(std::memory_order_acquire);
+
+    if (rpos == wpos) {
+        return false;
+    }
+
+    if (outEvent) {
+        *outEvent = _events[rpos & MASK];
+    }
+
+    // --> release the slot to the producer.
+    _rpos.store(rpos + 1, std::memory_order_release);
+    return true;
+}
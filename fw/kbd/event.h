@@ -0,0 +1,70 @@
+#ifndef __KBD_EVENT_H__
+#define __KBD_EVENT_H__
+
+#include <stdint.h>
+#include <atomic>
+#include "keys.h"
+
+/**
+ * key event, pushed by the scan stage.
+ */
+struct SKeyEvent {
+    uint32_t us;        // --> GPIO sample time, lower 32 bits of `time_us_64`.
+    uint8_t key;        // --> EKey.
+    uint8_t state;      // --> EKLS_RISE or EKLS_FALL.
+};
+
+/**
+ * lock-free single-producer, single-consumer key event ring.
+ * the scan stage pushes, the dispatch stage pops, on any core or interrupt.
+ */
+class KbdEventRing {
+public:
+    static constexpr uint32_t MAX_EVENTS = 64;
+    static constexpr uint32_t MASK = MAX_EVENTS - 1;
+
+    static_assert((MAX_EVENTS & MASK) == 0, "MAX_EVENTS must be power of two.");
+
+private:
+    SKeyEvent _events[MAX_EVENTS];
+
+    /* free running positions, wrapped by `MASK` on access. */
+    std::atomic<uint32_t> _rpos;
+    std::atomic<uint32_t> _wpos;
+
+    /* written by the producer only. */
+    volatile uint32_t _pushed;
+    volatile uint32_t _drops;
+    volatile uint32_t _peak;
+
+public:
+    KbdEventRing();
+
+public:
+    /* push an event, called from the producer only. */
+    bool push(const SKeyEvent& event);
+
+    /* pop an event, called from the consumer only. */
+    bool pop(SKeyEvent* outEvent);
+
+    /* get the count of pending events. */
+    uint32_t size() const {
+        const uint32_t wpos = _wpos.load(std::memory_order_acquire);
+        return wpos - _rpos.load(std::memory_order_acquire);
+    }
+
+    /* test whether the ring is empty or not. */
+    bool isEmpty() const { return size() == 0; }
+
+public:
+    /* get the count of pushed events. */
+    uint32_t getPushed() const { return _pushed; }
+
+    /* get the count of events refused because the ring was full. */
+    uint32_t getDrops() const { return _drops; }
+
+    /* get the highest count of pending events. */
+    uint32_t getPeak() const { return _peak; }
+};
+
+#endif
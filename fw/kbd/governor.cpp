@@ -0,0 +1,82 @@
+#include "governor.h"
+
+KbdScanGovernor::KbdScanGovernor() {
+    _config.fastUs = DEFAULT_FAST_US;
+    _config.slowUs = DEFAULT_SLOW_US;
+    _config.holdUs = DEFAULT_HOLD_US;
+    _config.decayUs = DEFAULT_DECAY_US;
+
+    _period = _config.fastUs;
+    _level = 0;
+    _last = _active = 0;
+
+    resetStats();
+}
+
+void KbdScanGovernor::setConfig(const SKbdGovernorConfig& config) {
+    _config = config;
+
+    if (_config.fastUs == 0) {
+        _config.fastUs = 1;
+    }
+
+    // --> the slow period must be reachable by doubling.
+    const uint32_t slowest = _config.fastUs << (MAX_LEVELS - 1);
+    if (_config.slowUs < _config.fastUs) {
+        _config.slowUs = _config.fastUs;
+    }
+
+    else if (_config.slowUs > slowest) {
+        _config.slowUs = slowest;
+    }
+
+    // --> restart from the fast rate.
+    _period = _config.fastUs;
+    _level = 0;
+}
+
+void KbdScanGovernor::onScan(uint32_t now, bool active) {
+    if (_scans) {
+        _timeIn[_level] += now - _last;
+    }
+
+    _last = now;
+    _scans++;
+
+    if (active) {
+        _active = now;
+        _period = _config.fastUs;
+        _level = 0;
+        return;
+    }
+
+    // --> hold the fast rate first, then one step per decay interval.
+    const uint32_t wait = _level ? _config.decayUs : _config.holdUs;
+    if (_period >= _config.slowUs || now - _active < wait) {
+        return;
+    }
+
+    _active = now;
+    _period = _period << 1;
+    _level++;
+
+    if (_period > _config.slowUs) {
+        _period = _config.slowUs;
+    }
+}
+
+uint64_t KbdScanGovernor::getTimeIn(uint32_t level) const {
+    if (level >= MAX_LEVELS) {
+        return 0;
+    }
+
+    return _timeIn[level];
+}
+
+void KbdScanGovernor::resetStats() {
+    _scans = 0;
+
+    for(uint32_t i = 0; i < MAX_LEVELS; ++i) {
+        _timeIn[i] = 0;
+    }
+}
@@ -0,0 +1,84 @@
+#ifndef __KBD_GOVERNOR_H__
+#define __KBD_GOVERNOR_H__
+
+#include <stdint.h>
+
+/**
+ * scan-rate policy.
+ */
+struct SKbdGovernorConfig {
+    uint32_t fastUs;        // --> period while keys are active.
+    uint32_t slowUs;        // --> longest period while idle.
+    uint32_t holdUs;        // --> stay fast for this long after activity.
+    uint32_t decayUs;       // --> then double the period at this interval.
+};
+
+/**
+ * adaptive scan-rate governor.
+ * scans at the fast rate while any key is down or recently changed,
+ * then halves the rate step by step until it reaches the slow rate.
+ * a press waits for the next scan, so decayed to the default slow rate
+ * it adds up to 1 ms to the press latency, before the fast rate resumes.
+ * with the scan timer, the pacer follows `getPeriod()` tick by tick.
+ */
+class KbdScanGovernor {
+public:
+    static constexpr uint32_t MAX_LEVELS = 8;   // --> level N: fastUs << N.
+
+    static constexpr uint32_t DEFAULT_FAST_US = 125;        // --> 8 kHz.
+    static constexpr uint32_t DEFAULT_SLOW_US = 1000;       // --> 1 kHz.
+    static constexpr uint32_t DEFAULT_HOLD_US = 50000;
+    static constexpr uint32_t DEFAULT_DECAY_US = 20000;
+
+private:
+    SKbdGovernorConfig _config;
+
+    uint32_t _period;
+    uint32_t _level;
+    uint32_t _last;         // --> last scan.
+    uint32_t _active;       // --> last activity, or last decay step.
+    uint32_t _scans;
+
+    /* time spent on each level, microseconds. */
+    uint64_t _timeIn[MAX_LEVELS];
+
+public:
+    KbdScanGovernor();
+
+public:
+    /* set the policy, periods are clamped to `MAX_LEVELS`. */
+    void setConfig(const SKbdGovernorConfig& config);
+
+    /* get the policy. */
+    const SKbdGovernorConfig& getConfig() const { return _config; }
+
+public:
+    /* test whether the next scan is due at `now` (us), tolerating early ticks. */
+    bool isDue(uint32_t now) const { 
+        return now - _last + (_config.fastUs >> 1) >= _period; 
+    }
+
+    /* account a scan at `now` (us) with its activity. */
+    void onScan(uint32_t now, bool active);
+
+public:
+    /* get the current scan period in microseconds. */
+    uint32_t getPeriod() const { return _period; }
+
+    /* get the current scan rate in Hz. */
+    uint32_t getRate() const { return _period ? 1000000 / _period : 0; }
+
+    /* get the current level, 0 is the fast rate. */
+    uint32_t getLevel() const { return _level; }
+
+    /* get the count of scans. */
+    uint32_t getScans() const { return _scans; }
+
+    /* get the time spent on the level in microseconds. */
+    uint64_t getTimeIn(uint32_t level) const;
+
+    /* reset the statistics. */
+    void resetStats();
+};
+
+#endif
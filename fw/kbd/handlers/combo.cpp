@@ -0,0 +1,293 @@
+#include "combo.h"
+#include "macro.h"
+#include "../scancode.h"
+#include "../../board/config.h"
+
+/**
+ * combo: keys pressed together within the window.
+ */
+struct SKeyCombo {
+    uint32_t keys;
+    uint8_t action;     // --> EKeyComboAction.
+    SKeyChar ch;        // --> EKCA_CHAR only.
+};
+
+#define KEY_COMBO2(a, b)    ((1u << (a)) | (1u << (b)))
+
+static constexpr SKeyCombo COMBOS[] = {
+    { KEY_COMBO2(EKEY_NUM_0, EKEY_DOT),         EKCA_CHAR,  { '=', '=', KC_KEYPAD_EQUAL, 0 } },
+    { KEY_COMBO2(EKEY_SLASH, EKEY_ASTEROID),    EKCA_CHAR,  { EKCTL_BACKSPACE, EKCTL_BACKSPACE, KC_BACKSPACE, 0 } },
+    { KEY_COMBO2(EKEY_NUM_0, EKEY_SLASH),       EKCA_MACRO, { 0, } },
+};
+
+static constexpr uint32_t COMBO_COUNT = sizeof(COMBOS) / sizeof(SKeyCombo);
+
+// --> keys owned by other handlers or never reported.
+static constexpr uint32_t COMBO_EXCLUDED =
+    (1u << EKEY_UFN_1) | (1u << EKEY_UFN_2) | (1u << EKEY_UFN_3) |
+    (1u << EKEY_UFN_4) | (1u << EKEY_UFN_5) | (1u << EKEY_HIDDEN) |
+    (1u << EKEY_MREC) | (1u << EKEY_MPLAY) | (1u << EKEY_NUMLOCK);
+
+/* test whether all combos are two or more of valid keys with a valid action, each set only once. */
+static constexpr bool kbdCheckCombos() {
+    for(uint32_t i = 0; i < COMBO_COUNT; ++i) {
+        const uint32_t keys = COMBOS[i].keys;
+
+        if (__builtin_popcount(keys) < 2 || (keys >> EKEY_MAX) || (keys & COMBO_EXCLUDED)) {
+            return false;
+        }
+
+        if (COMBOS[i].action >= EKCA_MAX_VALUE) {
+            return false;
+        }
+
+        if (COMBOS[i].action == EKCA_CHAR &&
+            (COMBOS[i].ch.kc == KC_NONE || COMBOS[i].ch.kc > KC_GUI_RIGHT))
+        {
+            return false;
+        }
+
+        for(uint32_t j = i + 1; j < COMBO_COUNT; ++j) {
+            if (COMBOS[j].keys == keys) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+static_assert(COMBO_COUNT <= KbdComboHandler::MAX_COMBOS, "kbd: too many combos.");
+static_assert(kbdCheckCombos(), "kbd: invalid or duplicate combo.");
+
+/**
+ * combo index, built at compile time.
+ */
+struct SKeyComboIndex {
+    uint32_t keys;                  // --> keys in any combo.
+    uint32_t candidates[EKEY_MAX];  // --> combos with the key, bit N: combo N.
+};
+
+static constexpr SKeyComboIndex kbdBuildComboIndex() {
+    SKeyComboIndex index = { };
+
+    for(uint32_t i = 0; i < COMBO_COUNT; ++i) {
+        index.keys |= COMBOS[i].keys;
+
+        for(uint32_t bits = COMBOS[i].keys; bits; bits &= bits - 1) {
+            index.candidates[__builtin_ctz(bits)] |= 1u << i;
+        }
+    }
+
+    return index;
+}
+
+static constexpr SKeyComboIndex COMBO_INDEX = kbdBuildComboIndex();
+
+KbdComboHandler::KbdComboHandler() {
+    _window = DEFAULT_WINDOW_US;
+    _since = 0;
+
+    _pending = _candidates = 0;
+    _holding = _swallow = 0;
+
+    _active = -1;
+    _enabled = KBD_USE_COMBOS;
+}
+
+KbdComboHandler* KbdComboHandler::instance() {
+    static KbdComboHandler _handler;
+    return &_handler;
+}
+
+uint32_t KbdComboHandler::size() {
+    return COMBO_COUNT;
+}
+
+uint32_t KbdComboHandler::getComboKeys(uint32_t n) {
+    if (n >= COMBO_COUNT) {
+        return 0;
+    }
+
+    return COMBOS[n].keys;
+}
+
+EKeyComboAction KbdComboHandler::getComboAction(uint32_t n) {
+    if (n >= COMBO_COUNT) {
+        return EKCA_MAX_VALUE;
+    }
+
+    return EKeyComboAction(COMBOS[n].action);
+}
+
+SKeyChar KbdComboHandler::getComboChar(uint32_t n) {
+    if (n >= COMBO_COUNT) {
+        return { 0, };
+    }
+
+    return COMBOS[n].ch;
+}
+
+bool KbdComboHandler::onKeyUpdated(Kbd* kbd, EKey key, EKeyState state) {
+    if (key >= EKEY_MAX) {
+        return false;
+    }
+
+    const uint32_t bit = 1u << key;
+    const uint32_t owned = _pending | _holding | _swallow;
+
+    // --> fast path: nothing held, and the key is in no combo.
+    if (!owned && !(COMBO_INDEX.keys & bit)) {
+        return false;
+    }
+
+    switch(state) {
+        case EKLS_RISE:
+            if (kbd->isKeyRepeat(key)) {
+                return (owned & bit) != 0;
+            }
+
+            if (_pending) {
+                const uint32_t candidates = _candidates & COMBO_INDEX.candidates[key];
+
+                if (candidates) {
+                    _candidates = candidates;
+                    hold(kbd, key);
+
+                    for(uint32_t bits = candidates; bits; bits &= bits - 1) {
+                        const uint32_t n = __builtin_ctz(bits);
+
+                        if (COMBOS[n].keys == _pending) {
+                            complete(kbd, n);
+                            break;
+                        }
+                    }
+
+                    return true;
+                }
+
+                // --> no chord with this key: release the held ones as they are.
+                flush(kbd);
+            }
+
+            // --> a new chord: not while another combo is down.
+            if (!_enabled || _active >= 0 || !(COMBO_INDEX.keys & bit)) {
+                return false;
+            }
+
+            _since = kbd->getKeyTime(key);
+            _candidates = COMBO_INDEX.candidates[key];
+            hold(kbd, key);
+
+            kbd->schedule(_since + _window);
+            return true;
+
+        case EKLS_FALL:
+            if (_pending & bit) {
+                // --> released before a chord: the host still sees its press.
+                flush(kbd);
+                kbd->tapKey(key);
+                break;
+            }
+
+            if (_holding & bit) {
+                finish(kbd);
+            }
+
+            if (_swallow & bit) {
+                _swallow &= ~bit;
+                kbd->hideKey(key, false);
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    return false;
+}
+
+bool KbdComboHandler::onTick(Kbd* kbd, uint32_t now) {
+    if (_pending == 0) {
+        return false;
+    }
+
+    // --> another handler's tick: wait for the window.
+    if (now - _since < _window) {
+        kbd->schedule(_since + _window);
+        return false;
+    }
+
+    flush(kbd);
+    return true;
+}
+
+void KbdComboHandler::onDisabled(const Kbd* kbd) {
+    Kbd* target = Kbd::get();
+
+    flush(target);
+    finish(target);
+
+    for(; _swallow; _swallow &= _swallow - 1) {
+        target->hideKey(EKey(__builtin_ctz(_swallow)), false);
+    }
+}
+
+void KbdComboHandler::hold(Kbd* kbd, EKey key) {
+    _pending |= 1u << key;
+    kbd->hideKey(key, true);
+}
+
+void KbdComboHandler::flush(Kbd* kbd) {
+    for(uint32_t bits = _pending; bits; bits &= bits - 1) {
+        kbd->hideKey(EKey(__builtin_ctz(bits)), false);
+    }
+
+    _pending = _candidates = 0;
+}
+
+void KbdComboHandler::complete(Kbd* kbd, uint32_t n) {
+    // --> the lowest key reports the combo, others stay hidden.
+    if (COMBOS[n].action == EKCA_CHAR) {
+        const EKey leader = EKey(__builtin_ctz(_pending));
+
+        kbd->overrideKeyChar(leader, &COMBOS[n].ch);
+        kbd->hideKey(leader, false);
+    }
+
+    // --> all keys stay hidden, as the macro play key.
+    else if (COMBOS[n].action == EKCA_MACRO) {
+        KbdMacroHandler::instance()->toggle(kbd);
+    }
+
+    _holding = _pending;
+
+    _active = int8_t(n);
+    _pending = _candidates = 0;
+}
+
+void KbdComboHandler::finish(Kbd* kbd) {
+    if (_active < 0) {
+        return;
+    }
+
+    const EKey leader = EKey(__builtin_ctz(_holding));
+    kbd->overrideKeyChar(leader, nullptr);
+
+    // --> keys still down must not start typing their own characters.
+    for(uint32_t bits = _holding; bits; bits &= bits - 1) {
+        const EKey key = EKey(__builtin_ctz(bits));
+
+        if (kbd->isKeyDown(key)) {
+            kbd->hideKey(key, true);
+            _swallow |= 1u << key;
+        }
+
+        else {
+            kbd->hideKey(key, false);
+        }
+    }
+
+    _holding = 0;
+    _active = -1;
+}
@@ -0,0 +1,102 @@
+#ifndef __KBD_HANDLERS_COMBO_H__
+#define __KBD_HANDLERS_COMBO_H__
+
+#include "../kbd.h"
+
+/**
+ * combo actions.
+ */
+enum EKeyComboAction {
+    EKCA_CHAR = 0,      // --> report the combo character.
+    EKCA_MACRO,         // --> play or stop the macro, as EKEY_MPLAY.
+    EKCA_MAX_VALUE
+};
+
+/**
+ * chord (combo) handler.
+ * keys that belong to any combo are held back from reports until either
+ * a combo completes or the window ends, so a missed chord costs at most
+ * the window. matching is an AND of per-key candidate sets and a compare
+ * of the pressed set against the few candidates left.
+ */
+class KbdComboHandler : public IKeyHandler {
+public:
+    ~KbdComboHandler() { }
+
+private:
+    KbdComboHandler();
+
+public:
+    static constexpr uint32_t MAX_COMBOS = 32;
+    static constexpr uint32_t DEFAULT_WINDOW_US = 40000;
+
+private:
+    uint32_t _window;       // --> us.
+    uint32_t _since;        // --> sample time of the first pending key.
+
+    uint32_t _pending;      // --> held back, undecided keys.
+    uint32_t _candidates;   // --> combos still possible, bit N: combo N.
+    uint32_t _holding;      // --> keys of the completed combo, still down.
+    uint32_t _swallow;      // --> keys hidden until released.
+
+    int8_t _active;         // --> completed combo, -1: none.
+    uint8_t _enabled;
+
+public:
+    /* get the singleton instance. */
+    static KbdComboHandler* instance();
+
+public:
+    /* set the chord window in microseconds. */
+    void setWindow(uint32_t us) { _window = us; }
+
+    /* get the chord window in microseconds. */
+    uint32_t getWindow() const { return _window; }
+
+    /* turn combos on or off. */
+    void setEnabled(bool enabled) { _enabled = enabled ? 1 : 0; }
+
+    /* test whether combos are on or not. */
+    bool isEnabled() const { return _enabled != 0; }
+
+    /* get the combo count. */
+    static uint32_t size();
+
+    /* get keys of the combo, bit N: EKey(N). */
+    static uint32_t getComboKeys(uint32_t n);
+
+    /* get the action of the combo. */
+    static EKeyComboAction getComboAction(uint32_t n);
+
+    /* get the key character of the combo, EKCA_CHAR only. */
+    static SKeyChar getComboChar(uint32_t n);
+
+public:
+    /**
+     * called when key state updated. 
+     * this will be called after applying orders.
+     * if this returns false for the key, it will yield process to other listener.
+     */
+    virtual bool onKeyUpdated(Kbd* kbd, EKey key, EKeyState state);
+
+    /* called on the chord window deadline. */
+    virtual bool onTick(Kbd* kbd, uint32_t now);
+
+    /* called when the kbd is disabled. */
+    virtual void onDisabled(const Kbd* kbd);
+
+private:
+    /* hold the key back as a part of a chord. */
+    void hold(Kbd* kbd, EKey key);
+
+    /* release pending keys to reports as they are. */
+    void flush(Kbd* kbd);
+
+    /* complete the combo on pending keys. */
+    void complete(Kbd* kbd, uint32_t n);
+
+    /* end the completed combo, keys still down stay hidden. */
+    void finish(Kbd* kbd);
+};
+
+#endif
@@ -0,0 +1,103 @@
+#include "layer.h"
+#include <string.h>
+
+KbdLayerHandler::KbdLayerHandler() {
+    memset(_actions, 0, sizeof(_actions));
+    _momentary = 0;
+}
+
+KbdLayerHandler* KbdLayerHandler::instance() {
+    static KbdLayerHandler _handler;
+    return &_handler;
+}
+
+bool KbdLayerHandler::setAction(EKey key, EKeyLayerAction action, EKeyLayer layer) {
+    if (key >= EKEY_MAX || action >= EKLA_MAX_VALUE) {
+        return false;
+    }
+
+    if (action != EKLA_NONE && (layer == EKLY_BASE || layer >= EKLY_MAX)) {
+        return false;
+    }
+
+    _actions[key].action = action;
+    _actions[key].layer = layer;
+    return true;
+}
+
+EKeyLayerAction KbdLayerHandler::getAction(EKey key) const {
+    if (key >= EKEY_MAX) {
+        return EKLA_NONE;
+    }
+
+    return EKeyLayerAction(_actions[key].action);
+}
+
+EKeyLayer KbdLayerHandler::getActionLayer(EKey key) const {
+    if (key >= EKEY_MAX || _actions[key].action == EKLA_NONE) {
+        return EKLY_INVALID;
+    }
+
+    return EKeyLayer(_actions[key].layer);
+}
+
+bool KbdLayerHandler::onKeyUpdated(Kbd* kbd, EKey key, EKeyState state) {
+    if (key >= EKEY_MAX || _actions[key].action == EKLA_NONE) {
+        return false;
+    }
+
+    const SAction& action = _actions[key];
+    KbdLayers* layers = kbd->getLayers();
+    KbdTapHold* tapHold = kbd->getTapHold();
+
+    switch(state) {
+        case EKLS_RISE:
+            // --> taps and repeats never switch layers.
+            if (kbd->isKeyRepeat(key) || (tapHold->isDual(key) && !tapHold->isHeld(key))) {
+                break;
+            }
+
+            if (action.action == EKLA_TOGGLE) {
+                layers->toggle(EKeyLayer(action.layer));
+                break;
+            }
+
+            layers->activate(EKeyLayer(action.layer));
+            _momentary |= 1u << key;
+            break;
+
+        case EKLS_FALL:
+            release(kbd, key);
+            break;
+
+        default:
+            break;
+    }
+
+    // --> yield: the key keeps its own handlers.
+    return false;
+}
+
+void KbdLayerHandler::onDisabled(const Kbd* kbd) {
+    for(; _momentary; _momentary &= _momentary - 1) {
+        const EKey key = EKey(__builtin_ctz(_momentary));
+        Kbd::get()->getLayers()->deactivate(EKeyLayer(_actions[key].layer));
+    }
+}
+
+void KbdLayerHandler::release(Kbd* kbd, EKey key) {
+    const uint32_t bit = 1u << key;
+    if ((_momentary & bit) == 0) {
+        return;
+    }
+
+    _momentary &= ~bit;
+
+    for(uint32_t bits = _momentary; bits; bits &= bits - 1) {
+        if (_actions[__builtin_ctz(bits)].layer == _actions[key].layer) {
+            return;
+        }
+    }
+
+    kbd->getLayers()->deactivate(EKeyLayer(_actions[key].layer));
+}
@@ -0,0 +1,67 @@
+#ifndef __KBD_HANDLERS_LAYER_H__
+#define __KBD_HANDLERS_LAYER_H__
+
+#include "../kbd.h"
+
+/**
+ * layer switching actions.
+ */
+enum EKeyLayerAction {
+    EKLA_NONE = 0,
+    EKLA_MOMENTARY,     // --> active while the key is held.
+    EKLA_TOGGLE,        // --> toggled on every press.
+    EKLA_MAX_VALUE
+};
+
+/**
+ * layer switching handler.
+ * dual-role keys switch only when they resolve as hold.
+ */
+class KbdLayerHandler : public IKeyHandler {
+public:
+    ~KbdLayerHandler() { }
+
+private:
+    KbdLayerHandler();
+
+private:
+    struct SAction {
+        uint8_t action;
+        uint8_t layer;
+    };
+
+private:
+    SAction _actions[EKEY_MAX];
+    uint32_t _momentary;    // --> keys holding their layer now.
+
+public:
+    /* get the singleton instance. */
+    static KbdLayerHandler* instance();
+
+public:
+    /* set the layer action of the key. */
+    bool setAction(EKey key, EKeyLayerAction action, EKeyLayer layer);
+
+    /* get the layer action of the key. */
+    EKeyLayerAction getAction(EKey key) const;
+
+    /* get the layer of the key's action. */
+    EKeyLayer getActionLayer(EKey key) const;
+
+public:
+    /**
+     * called when key state updated. 
+     * this will be called after applying orders.
+     * if this returns false for the key, it will yield process to other listener.
+     */
+    virtual bool onKeyUpdated(Kbd* kbd, EKey key, EKeyState state);
+
+    /* called when the kbd is disabled. */
+    virtual void onDisabled(const Kbd* kbd);
+
+private:
+    /* release the momentary layer of the key, unless another key holds it. */
+    void release(Kbd* kbd, EKey key);
+};
+
+#endif
@@ -0,0 +1,163 @@
+#include "macro.h"
+#include "../../board/ledctl.h"
+#include "pico/stdlib.h"
+
+KbdMacroHandler::KbdMacroHandler()
+    : _player(&_macro, this, this)
+{
+    _last = _down = 0;
+    _recording = 0;
+}
+
+KbdMacroHandler* KbdMacroHandler::instance() {
+    static KbdMacroHandler _handler;
+    return &_handler;
+}
+
+bool KbdMacroHandler::record() {
+    if (_recording || _player.getState() != EKMS_IDLE) {
+        return false;
+    }
+
+    _macro.clear();
+    _last = _down = 0;
+
+    _recording = 1;
+    updateLeds();
+    return true;
+}
+
+bool KbdMacroHandler::play(Kbd* kbd, EKbdMacroMode mode) {
+    if (_recording || _player.play(mode) == false) {
+        return false;
+    }
+
+    updateLeds();
+    return true;
+}
+
+bool KbdMacroHandler::toggle(Kbd* kbd) {
+    const EKbdMacroState current = getState();
+
+    if (current == EKMS_PLAYING) {
+        stop(kbd);
+        return false;
+    }
+
+    // --> play right after recording without another press.
+    if (current == EKMS_RECORDING) {
+        stop(kbd);
+    }
+
+    return play(kbd, getMode());
+}
+
+void KbdMacroHandler::stop(Kbd* kbd) {
+    _recording = 0;
+    _down = 0;
+
+    _player.stop();
+    updateLeds();
+}
+
+bool KbdMacroHandler::onKeyUpdated(Kbd* kbd, EKey key, EKeyState state) {
+    if (key != EKEY_MREC && key != EKEY_MPLAY) {
+        return false;
+    }
+
+    if (state != EKLS_RISE || kbd->isKeyRepeat(key)) {
+        return true;
+    }
+
+    const EKbdMacroState current = getState();
+
+    if (key == EKEY_MREC) {
+        if (current == EKMS_RECORDING) {
+            stop(kbd);
+        }
+
+        else {
+            record();
+        }
+
+        return true;
+    }
+
+    toggle(kbd);
+    return true;
+}
+
+bool KbdMacroHandler::onTick(Kbd* kbd, uint32_t now) {
+    const EKbdMacroState state = _player.getState();
+
+    _player.onTick(now);
+
+    if (_player.getState() != state) {
+        updateLeds();
+    }
+
+    return false;
+}
+
+void KbdMacroHandler::onKeyNotify(const Kbd* kbd, EKey key, EKeyState state) {
+    if (_recording == 0 || key == EKEY_MREC || key == EKEY_MPLAY) {
+        return;
+    }
+
+    if ((state != EKLS_RISE && state != EKLS_FALL) || kbd->isKeyRepeat(key)) {
+        return;
+    }
+
+    const uint32_t bit = 1u << key;
+
+    // --> keys pressed before recording: their release is not a step.
+    if (state == EKLS_FALL && (_down & bit) == 0) {
+        return;
+    }
+
+    const uint32_t ms = kbd->getKeyPtr(key)->ms;
+
+    SMacroStep step;
+    step.delay = _macro.isEmpty() ? 0 : ms - _last;
+    step.key = uint8_t(key);
+    step.state = uint8_t(state);
+
+    if (_macro.append(step) == false) {
+        // --> full: keep what fits, playback releases what is left down.
+        _recording = 0;
+        updateLeds();
+        return;
+    }
+
+    _down = state == EKLS_RISE ? (_down | bit) : (_down & ~bit);
+    _last = ms;
+}
+
+void KbdMacroHandler::onDisabled(const Kbd* kbd) {
+    stop(Kbd::get());
+}
+
+uint32_t KbdMacroHandler::getTime() const {
+    return uint32_t(Kbd::get()->getClock());
+}
+
+bool KbdMacroHandler::inject(uint8_t key, uint8_t state, uint32_t now) {
+    SKeyEvent event;
+    event.us = now;
+    event.key = key;
+    event.state = state;
+
+    return Kbd::get()->inject(event);
+}
+
+void KbdMacroHandler::schedule(uint32_t us) {
+    Kbd::get()->schedule(us);
+}
+
+void KbdMacroHandler::updateLeds() {
+    Ledctl* ledctl = Ledctl::get();
+    const EKbdMacroState state = getState();
+
+    ledctl->set(ELED_MREC, state == EKMS_RECORDING);
+    ledctl->set(ELED_MPL, state == EKMS_PLAYING);
+}
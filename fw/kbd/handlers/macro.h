@@ -0,0 +1,86 @@
+#ifndef __KBD_HANDLERS_MACRO_H__
+#define __KBD_HANDLERS_MACRO_H__
+
+#include "../kbd.h"
+#include "../macro.h"
+
+/**
+ * macro record/playback handler for EKEY_MREC and EKEY_MPLAY.
+ * records key edges as a listener, and plays them back by injecting
+ * events into the dispatch stage, so they take the whole handler chain
+ * and the HID path like scanned keys. playback runs on the keyboard clock,
+ * so it follows a replayed trace too.
+ */
+class KbdMacroHandler : public IKeyHandler, public IKeyListener, private IKbdMacroClock, private IKbdMacroSink {
+public:
+    ~KbdMacroHandler() { }
+
+private:
+    KbdMacroHandler();
+
+private:
+    KbdMacro _macro;
+    KbdMacroPlayer _player;
+
+    uint32_t _last;     // --> recording: ms of the previous step.
+    uint32_t _down;     // --> recording: keys pressed while recording.
+    uint8_t _recording;
+
+public:
+    /* get the singleton instance. */
+    static KbdMacroHandler* instance();
+
+public:
+    /* start recording into the empty macro. */
+    bool record();
+
+    /* start playing the macro. */
+    bool play(Kbd* kbd, EKbdMacroMode mode);
+
+    /* play the macro, or stop it if playing: the EKEY_MPLAY press. returns true if started. */
+    bool toggle(Kbd* kbd);
+
+    /* stop recording or playing, keys pressed by the macro are released first. */
+    void stop(Kbd* kbd);
+
+    /* get the current state. */
+    EKbdMacroState getState() const { return _recording ? EKMS_RECORDING : _player.getState(); }
+
+    /* get the mode of the last playback. */
+    EKbdMacroMode getMode() const { return _player.getMode(); }
+
+    /* get the recorded macro. */
+    const KbdMacro* getMacro() const { return &_macro; }
+
+public:
+    /**
+     * called when key state updated. 
+     * this will be called after applying orders.
+     * if this returns false for the key, it will yield process to other listener.
+     */
+    virtual bool onKeyUpdated(Kbd* kbd, EKey key, EKeyState state);
+
+    /* called on the next step. */
+    virtual bool onTick(Kbd* kbd, uint32_t now);
+
+    /* called on listener event. */
+    virtual void onKeyNotify(const Kbd* kbd, EKey key, EKeyState state);
+
+    /* called when the kbd is disabled. */
+    virtual void onDisabled(const Kbd* kbd);
+
+private:
+    /* get the keyboard clock. */
+    virtual uint32_t getTime() const;
+
+    /* inject the step as a key event, returns false if no room. */
+    virtual bool inject(uint8_t key, uint8_t state, uint32_t now);
+
+    /* request a handler tick. */
+    virtual void schedule(uint32_t us);
+
+    /* update LEDs from the state. */
+    void updateLeds();
+};
+
+#endif
@@ -53,6 +53,6 @@ bool KbdUserFnHandler::onKeyUpdated(Kbd* kbd, EKey key, EKeyState state) {
             break;
     }
 
-    // TODO: handles user function key.
+    // --> tap or hold is resolved before dispatch: see KbdTapHold.
     return true;
 }
\ No newline at end of file
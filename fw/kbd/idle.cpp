@@ -0,0 +1,103 @@
+#include "idle.h"
+#include "../board/config.h"
+#include "pico/stdlib.h"
+#include "hardware/gpio.h"
+#include "hardware/irq.h"
+
+// --> columns are consecutive pins from `COL_5` to `COL_1`.
+#define KBD_COL_MASK (0x1fu << GPIO_KBD_COL_5)
+
+/* the armed instance, for the raw GPIO handler. */
+static KbdIdle* g_kbdIdle = nullptr;
+
+KbdIdle::KbdIdle() {
+    _timeout = DEFAULT_TIMEOUT_MS;
+    _tick = DEFAULT_TICK_MS;
+    _active = 0;
+    _wakes = 0;
+    _state = EKIS_ACTIVE;
+    _installed = 0;
+}
+
+bool KbdIdle::update(bool active, uint32_t now) {
+    if (active || _timeout == 0) {
+        _active = now;
+        return false;
+    }
+
+    return _state == EKIS_ACTIVE && now - _active >= _timeout;
+}
+
+void KbdIdle::setColumnIrqs(bool enabled) {
+    for(uint32_t pin = GPIO_KBD_COL_5; pin <= GPIO_KBD_COL_1; ++pin) {
+        // --> edges are latched: drop stale ones from the last scan.
+        gpio_acknowledge_irq(pin, GPIO_IRQ_EDGE_RISE);
+        gpio_set_irq_enabled(pin, GPIO_IRQ_EDGE_RISE, enabled);
+    }
+}
+
+bool KbdIdle::arm() {
+    if (_installed == 0) {
+        // --> installed by the scanning core: interrupts wake this core.
+        g_kbdIdle = this;
+        gpio_add_raw_irq_handler_masked(KBD_COL_MASK, onGpioIrq);
+        irq_set_enabled(IO_IRQ_BANK0, true);
+        _installed = 1;
+    }
+
+    _state = EKIS_ARMED;
+    setColumnIrqs(true);
+
+    // --> a column that rose before arming never makes an edge.
+    if (gpio_get_all() & KBD_COL_MASK) {
+        setColumnIrqs(false);
+        _state = EKIS_ACTIVE;
+        return false;
+    }
+
+    return true;
+}
+
+bool KbdIdle::poll(uint32_t now) {
+    if (_state != EKIS_WOKEN) {
+        return _state == EKIS_ACTIVE;
+    }
+
+    _state = EKIS_ACTIVE;
+    _active = now;
+    _wakes++;
+    return true;
+}
+
+void KbdIdle::wake() {
+    if (_state == EKIS_ARMED) {
+        onColumnRise();
+    }
+}
+
+void KbdIdle::sleepOnce(uint32_t us) {
+    if (_state != EKIS_ARMED) {
+        return;
+    }
+
+    if (us > _tick * 1000) {
+        us = _tick * 1000;
+    }
+
+    // --> the interrupt sets the event flag, so a rise here isn't lost.
+    best_effort_wfe_or_timeout(make_timeout_time_us(us));
+}
+
+void KbdIdle::onColumnRise() {
+    setColumnIrqs(false);
+
+    if (_state == EKIS_ARMED) {
+        _state = EKIS_WOKEN;
+    }
+}
+
+void KbdIdle::onGpioIrq() {
+    if (g_kbdIdle) {
+        g_kbdIdle->onColumnRise();
+    }
+}
@@ -0,0 +1,86 @@
+#ifndef __KBD_IDLE_H__
+#define __KBD_IDLE_H__
+
+#include <stdint.h>
+
+/**
+ * idle scan states.
+ */
+enum EKbdIdleState {
+    EKIS_ACTIVE = 0,        // --> full-rate scanning.
+    EKIS_ARMED,             // --> rows held high, waiting for a column edge.
+    EKIS_WOKEN,             // --> a column rose, resume on the next scan.
+};
+
+/**
+ * idle-aware scan scheduler.
+ * once all keys are released for the timeout, scanners hold the rows high
+ * and core0 sleeps until a column rises, instead of scanning continuously.
+ */
+class KbdIdle {
+public:
+    static constexpr uint32_t DEFAULT_TIMEOUT_MS = 2000;
+    static constexpr uint32_t DEFAULT_TICK_MS = 10;
+
+private:
+    uint32_t _timeout;      // --> ms, zero disables idle scanning.
+    uint32_t _tick;         // --> ms, longest sleep for other core0 work.
+    uint32_t _active;       // --> last time a key was active.
+    uint32_t _wakes;
+    volatile uint8_t _state;
+    uint8_t _installed;
+
+public:
+    KbdIdle();
+
+public:
+    /* set the idle timeout in milliseconds, zero disables. */
+    void setTimeout(uint32_t ms) { _timeout = ms; }
+
+    /* get the idle timeout in milliseconds. */
+    uint32_t getTimeout() const { return _timeout; }
+
+    /* set the longest sleep, so LEDs, USB and modes keep stepping. */
+    void setTick(uint32_t ms) { _tick = ms ? ms : 1; }
+
+    /* get the current state. */
+    EKbdIdleState getState() const { return EKbdIdleState(_state); }
+
+    /* test whether scanning is suspended or not. */
+    bool isArmed() const { return _state != EKIS_ACTIVE; }
+
+    /* get the count of wakes by column edges. */
+    uint32_t getWakes() const { return _wakes; }
+
+public:
+    /* feed the activity at `now` (ms), returns true if it should be armed. */
+    bool update(bool active, uint32_t now);
+
+    /**
+     * arm column interrupts, rows must be held high already.
+     * returns false if a column is high, the press must be scanned then.
+     */
+    bool arm();
+
+    /* wake without a column edge, e.g. a replay started. */
+    void wake();
+
+    /* returns true if woken, then scanning should resume. */
+    bool poll(uint32_t now);
+
+    /* sleep until a column rises, an interrupt or the tick elapses. */
+    void sleepOnce() { sleepOnce(_tick * 1000); }
+
+    /* sleep as `sleepOnce()`, at most `us` microseconds. */
+    void sleepOnce(uint32_t us);
+
+private:
+    /* enable or disable column interrupts. */
+    void setColumnIrqs(bool enabled);
+
+    /* called from the GPIO interrupt. */
+    void onColumnRise();
+    static void onGpioIrq();
+};
+
+#endif
@@ -0,0 +1,69 @@
+#include "jitter.h"
+
+KbdJitter::KbdJitter() {
+    _period = 0;
+    _ideal = 0;
+    _synced = 0;
+
+    reset();
+}
+
+void KbdJitter::restart(uint32_t period) {
+    _period = period;
+    _synced = 0;
+}
+
+void KbdJitter::onTick(uint32_t now) {
+    if (_synced == 0) {
+        _ideal = now;
+        _synced = 1;
+        return;
+    }
+
+    _ideal += _period;
+
+    // --> signed: negative is early.
+    const int32_t dev = int32_t(now - _ideal);
+    const uint32_t mag = dev < 0 ? uint32_t(-dev) : uint32_t(dev);
+
+    if (dev > 0 && mag > _maxLate) {
+        _maxLate = mag;
+    }
+
+    else if (dev < 0 && mag > _maxEarly) {
+        _maxEarly = mag;
+    }
+
+    if (dev > 0 && mag >= _period) {
+        _overruns = _overruns + 1;
+
+        // --> ticks were skipped: resync to avoid counting it forever.
+        _ideal = now;
+    }
+
+    const uint32_t bucket = bucketOf(mag);
+    _hist[bucket] = _hist[bucket] + 1;
+    _ticks = _ticks + 1;
+}
+
+void KbdJitter::snapshot(SKbdJitter& out) const {
+    out.ticks = _ticks;
+    out.overruns = _overruns;
+    out.maxLate = _maxLate;
+    out.maxEarly = _maxEarly;
+
+    for(uint32_t i = 0; i < MAX_BUCKETS; ++i) {
+        out.hist[i] = _hist[i];
+    }
+}
+
+void KbdJitter::reset() {
+    _ticks = 0;
+    _overruns = 0;
+    _maxLate = 0;
+    _maxEarly = 0;
+
+    for(uint32_t i = 0; i < MAX_BUCKETS; ++i) {
+        _hist[i] = 0;
+    }
+}
@@ -0,0 +1,68 @@
+#ifndef __KBD_JITTER_H__
+#define __KBD_JITTER_H__
+
+#include <stdint.h>
+
+/**
+ * snapshot of scan jitter statistics.
+ */
+struct SKbdJitter {
+    static constexpr uint32_t MAX_BUCKETS = 16;
+
+    uint32_t ticks;                 // --> measured ticks.
+    uint32_t overruns;              // --> ticks later than a whole period.
+    uint32_t maxLate;               // --> latest tick, us after the ideal.
+    uint32_t maxEarly;              // --> earliest tick, us before the ideal.
+    uint32_t hist[MAX_BUCKETS];     // --> |deviation|, log2 us buckets.
+};
+
+/**
+ * deviation of scan ticks from the ideal fixed-period schedule.
+ * the ideal time advances by the period from the first tick,
+ * so drift shows up as growing deviation instead of being hidden.
+ */
+class KbdJitter {
+public:
+    static constexpr uint32_t MAX_BUCKETS = SKbdJitter::MAX_BUCKETS;
+
+private:
+    uint32_t _period;
+    uint32_t _ideal;
+    uint8_t _synced;
+
+    /* single writer: the tick source. */
+    volatile uint32_t _ticks;
+    volatile uint32_t _overruns;
+    volatile uint32_t _maxLate;
+    volatile uint32_t _maxEarly;
+    volatile uint32_t _hist[MAX_BUCKETS];
+
+public:
+    KbdJitter();
+
+public:
+    /* get the log2 bucket: 0 for 0 us, n for [2^(n-1), 2^n). */
+    static uint32_t bucketOf(uint32_t us) {
+        if (us == 0) {
+            return 0;
+        }
+
+        const uint32_t bucket = 32 - __builtin_clz(us);
+        return bucket < MAX_BUCKETS ? bucket : MAX_BUCKETS - 1;
+    }
+
+public:
+    /* restart the schedule with the period, the next tick becomes the origin. */
+    void restart(uint32_t period);
+
+    /* record a tick at `now` (us). */
+    void onTick(uint32_t now);
+
+    /* take the snapshot. */
+    void snapshot(SKbdJitter& out) const;
+
+    /* reset the statistics, keeping the schedule. */
+    void reset();
+};
+
+#endif
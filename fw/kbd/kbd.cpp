@@ -1,42 +1,17 @@
 #include "kbd.h"
 #include "scancode.h"
+#include "latency.h"
 #include "scanners/basic.h"
+#include "scanners/pio.h"
+#include "scanners/replay.h"
+#include "../board/config.h"
 #include "handlers/numlock.h"
 #include "handlers/userfn.h"
+#include "handlers/layer.h"
+#include "handlers/combo.h"
+#include "handlers/macro.h"
 #include "pico/stdlib.h"
 #include <string.h>
-#include <vector>
-#include <algorithm>
-
-#define KEY_MAP_UNMAPPED { 0, 0, 0, 0 }
-
-const SKeyChar Kbd::KEY_MAP[EKEY_MAX] = {
-    KEY_MAP_UNMAPPED,                        // EKEY_UFN_1
-    { '/', '/',     KC_KEYPAD_DIVIDE,   0 }, // EKEY_SLASH
-    { '*', '*',     KC_KEYPAD_MULTIPLY, 0 }, // EKEY_ASTEROID
-    { '-', '-',     KC_KEYPAD_SUBTRACT, 0 }, // EKEY_MINUS
-    { 0, 0,         KC_NUM_LOCK,        0 }, // EKEY_NUMLOCK
-    KEY_MAP_UNMAPPED,                        // EKEY_UFN_2
-    { '7', 'H',     KC_KEYPAD_7,        0 }, // EKEY_NUM_7
-    { '8', 'U',     KC_KEYPAD_8,        0 }, // EKEY_NUM_8
-    { '9', 'P',     KC_KEYPAD_9,        0 }, // EKEY_NUM_9
-    { '+', '+',     KC_KEYPAD_ADD,      0 }, // EKEY_PLUS
-    KEY_MAP_UNMAPPED,                        // EKEY_UFN_3
-    { '4', 'L',     KC_KEYPAD_4,        0 }, // EKEY_NUM_4
-    { '5', ' ',     KC_KEYPAD_5,        0 }, // EKEY_NUM_5
-    { '6', 'R',     KC_KEYPAD_6,        0 }, // EKEY_NUM_6
-    { '\n', '\n',   KC_KEYPAD_ENTER,    0 }, // EKEY_ENTER
-    KEY_MAP_UNMAPPED,                        // EKEY_UFN_4
-    { '1', 'E',     KC_KEYPAD_1,        0 }, // EKEY_NUM_1
-    { '2', 'D',     KC_KEYPAD_2,        0 }, // EKEY_NUM_2
-    { '3', 'S',     KC_KEYPAD_3,        0 }, // EKEY_NUM_3
-    KEY_MAP_UNMAPPED,                        // EKEY_HIDDEN
-    KEY_MAP_UNMAPPED,                        // EKEY_UFN_5
-    { '0', 'I',     KC_KEYPAD_0,        0 }, // EKEY_NUM_0
-    { '.', 'B',     KC_KEYPAD_DECIMAL,  0 }, // EKEY_DOT
-    KEY_MAP_UNMAPPED,                        // EKEY_MREC
-    KEY_MAP_UNMAPPED                         // EKEY_MPLAY
-};
 
 Kbd* Kbd::get() {
     static Kbd _kbd;
@@ -48,7 +23,8 @@ Kbd::Kbd() {
 
     uint8_t order = 0;
     for(uint8_t i = 0; i < EKEY_MAX; ++i) {
-        _keys[i].ch = KEY_MAP[i];
+        _keys[i].ch = KbdLayers::getDefaultKeyChar(EKey(i));
+        _keys[i].ly = EKLY_BASE;
 
         if (i == EKEY_HIDDEN) {
             _keys[i].order = 24;
@@ -60,10 +36,23 @@ Kbd::Kbd() {
     }
     
     _orderedKeys[order++] = EKEY_HIDDEN;
+    _downKeys = _edgeKeys = _pendingKeys = 0;
+    _repeatKeys = _scanKeys = 0;
+    _tapKeys = _hiddenKeys = _overKeys = 0;
+    _tickAt = 0;
+    _tickArmed = 0;
+    _typematic.setActive(KBD_USE_TYPEMATIC);
     _enabled = 0;
 
-    // --> push basic scanner here.
+    // --> push the matrix scanner here, both own the same pins.
+#if KBD_USE_PIO_SCANNER
+    push(KbdPioScanner::instance());
+#else
     push(KbdBasicScanner::instance());
+#endif
+
+    // --> idle until a trace is played, then it takes priority.
+    push(KbdReplayScanner::instance());
 
     // --> push numlock handler here.
     push(KbdNumlockHandler::instance());
@@ -71,291 +60,394 @@ Kbd::Kbd() {
 
     // --> push user-fn handler here.
     push(KbdUserFnHandler::instance());
+
+    // --> macro keys, recording as a listener.
+    push(KbdMacroHandler::instance());
+    listen(KbdMacroHandler::instance());
+
+    // --> layer switches run before user-fn keys, then yield to others.
+    push(KbdLayerHandler::instance());
+
+    // --> chords hold keys back before anyone else sees them.
+    push(KbdComboHandler::instance());
 }
 
 bool Kbd::push(IKeyScanner* scanner) {
-    if (scanner) {
-        _scanners.push_back(scanner);
-        return true;
-    }
-
-    return false;
+    return _scanners.push(scanner);
 }
 
 bool Kbd::pop(IKeyScanner* scanner) {
-    if (_scanners.size() <= 0) {
+    // --> null pops the last scanner.
+    return _scanners.remove(scanner);
+}
+
+bool Kbd::push(IKeyHandler* handler) {
+    return _handlers.push(handler);
+}
+
+bool Kbd::pop(IKeyHandler* handler) {
+    // --> null pops the last handler.
+    return _handlers.remove(handler);
+}
+
+bool Kbd::listen(IKeyListener* listener) {
+    if (listener == nullptr || _listeners.contains(listener)) {
         return false;
     }
 
-    if (scanner == nullptr) {
-        _scanners.pop_back();
-        return true;
+    if (_listeners.push(listener) == false) {
+        return false;
     }
 
-    auto iter = _scanners.begin();
-    auto sel = _scanners.end();
-
-    // --> find a last handler.
-    while(iter != sel) {
-        if (*iter == scanner) {
-            sel = iter;
-        }
+    listener->onListen();
+    return true;
+}
 
-        iter++;
+bool Kbd::unlisten(IKeyListener* listener) {
+    if (listener == nullptr) {
+        return false;
     }
 
-    if (sel != _scanners.end()) {
-        _scanners.erase(sel);
-        return true;
+    if (_listeners.remove(listener) == false) {
+        return false;
     }
-    
+
+    listener->onUnlisten();
     return true;
 }
 
-bool Kbd::push(IKeyHandler* handler) {
-    if (handler) {
-        _handlers.push_back(handler);
-        return true;
+bool Kbd::handle(EKey key) {
+    if (key >= EKEY_MAX || _handlers.size() <= 0) {
+        return false;
     }
 
-    return false;
+    // --> latch the layer on press: releasing the layer key first must not
+    //     change the character of a key held since, nor repeat another one.
+    if (_keys[key].ls == EKLS_RISE && (_repeatKeys & (1u << key)) == 0) {
+        _keys[key].ly = _layers.resolve(key);
+    }
+
+    // --> invoke key handlers in reverse order, until one takes the key.
+    const bool retval = _handlers.forEachReverse([this, key](IKeyHandler* handler) {
+        const EKeyState state = EKeyState(_keys[key].ls);
+        return handler->onKeyUpdated(this, key, state);
+    });
+
+    // --> notify key state.
+    _listeners.forEachReverse([this, key](IKeyListener* listener) {
+        const EKeyState state = EKeyState(_keys[key].ls);
+        listener->onKeyNotify(this, key, state);
+        return false;
+    });
+
+    return retval;
 }
 
-bool Kbd::pop(IKeyHandler* handler) {
-    if (_handlers.size() <= 0) {
+bool Kbd::scanOnce() {
+    if (!_enabled) {
         return false;
     }
 
-    if (handler == nullptr) {
-        _handlers.pop_back();
-        _handlers.shrink_to_fit();
-        return true;
+    const uint32_t now = to_ms_since_boot(get_absolute_time());
+
+    // --> rows are held for the wake: nothing to scan until a column rises.
+    if (_idle.isArmed()) {
+        if (_idle.poll(now) == false) {
+            return false;
+        }
+
+        leaveIdle();
     }
 
-    auto iter = _handlers.begin();
-    auto sel = _handlers.end();
+    IKeyScanner* scanners[MAX_SCANNERS];
+    uint32_t count = 0;
 
-    // --> find a last handler.
-    while(iter != sel) {
-        if (*iter == handler) {
-            sel = iter;
+    // --> reverse pushed order: later scanners take priority.
+    _scanners.forEachReverse([&scanners, &count](IKeyScanner* scanner) {
+        if (scanner->scanOnce()) {
+            scanners[count++] = scanner;
         }
 
-        iter++;
-    }
+        return false;
+    });
 
-    if (sel != _handlers.end()) {
-        _handlers.erase(sel);
-        return true;
+    // --> no key level change exists.
+    if (count <= 0) {
+        return false;
     }
     
-    return true;
-}
+    // --> filter levels and push changes to the dispatch stage.
+    const bool pushed = updateOnce(scanners, count);
 
-bool Kbd::listen(IKeyListener* listener) {
-    if (listener == nullptr) {
-        return false;
-    }
+    // --> handler deadlines (chord windows, macro steps) keep full-rate scanning.
+    const bool active = pushed || isAnyKeyActive() || _tickArmed;
 
-    for(IKeyListener* other : _listeners) {
-        if (other == listener) {
-            return false;
-        }
+    if (_idle.update(active, now) && !enterIdle()) {
+        // --> couldn't arm: retry after another timeout.
+        _idle.update(true, now);
     }
 
-    _listeners.push_back(listener);
-    listener->onListen();
-    return true;
+    return pushed;
 }
 
-bool Kbd::unlisten(IKeyListener* listener) {
-    if (listener == nullptr) {
+bool Kbd::dispatchOnce() {
+    if (!_enabled) {
         return false;
     }
 
-    auto iter = _listeners.begin();
-    while(iter != _listeners.end()) {
+    // --> settle edges from the last dispatch: RISE -> HIGH, FALL -> LOW.
+    uint32_t changed = _edgeKeys;
+    for(uint32_t bits = changed; bits; bits &= bits - 1) {
+        const EKey key = EKey(__builtin_ctz(bits));
+        setLevel(key, _keys[key].ls == EKLS_RISE ? EKLS_HIGH : EKLS_LOW);
+    }
 
-        if ((*iter) == listener) {
-            _listeners.erase(iter);
-            listener->onUnlisten();
-            return true;
-        }
+    SKeyEvent event;
+    KbdLatency* latency = KbdLatency::get();
 
-        iter++;
-    }
+    uint32_t evented = 0;
+    _repeatKeys = _tapKeys = 0;
 
-    return false;
-}
+    // --> handler deadlines: may change reports without any key event.
+    const bool ticked = _tickArmed && tickOnce();
+
+    if (_events.isEmpty() == false || _tapHold.isPending()) {
+        const uint64_t nowUs = getClock();
+        const uint32_t now = uint32_t(nowUs);
+        uint32_t age = 0;
+
+        // --> later stages are measured from the oldest event.
+        //     held events are measured when the resolver lets them go.
+        auto take = [&](const SKeyEvent& event) {
+            latency->record(EKLT_DISPATCH, now - event.us);
+            evented |= apply(event, nowUs);
+
+            if (now - event.us >= age) {
+                age = now - event.us;
+                latency->setOrigin(event.us);
+            }
+        };
+
+        // --> a full resolver leaves events in the ring.
+        while(!_tapHold.isFull() && _events.pop(&event)) {
+            // --> one edge per key and dispatch: a later edge of the key
+            //     waits in the resolver, and everything after it in order.
+            if (_tapHold.isPassing(event) && (evented & (1u << event.key)) == 0) {
+                take(event);
+            }
 
-template<typename T>
-bool kbdHasInstance(const std::vector<T*>& list, T* ptr) {
-    for(const T* item : list) {
-        if (item == ptr) {
-            return true;
+            else {
+                _tapHold.push(event);
+            }
         }
-    }
 
-    return false;
-}
+        if (_tapHold.isPending()) {
+            _tapHold.poll(now);
 
-bool Kbd::handle(EKey key) const {
-    if (key >= EKEY_MAX || _handlers.size() <= 0) {
-        return false;
+            while(_tapHold.pop(&event, evented)) {
+                take(event);
+            }
+        }
+
+        changed |= evented;
     }
 
-    // --> copy all handlers to avoid handler-set manipulation.
-    FHandlerList handlers(_handlers);
-    FListenerList listeners(_listeners);
-    
-    // --> reverse copied list to invoke handlers in reverse order.
-    std::reverse(handlers.begin(), handlers.end());
-    std::reverse(listeners.begin(), listeners.end());
-    bool retval = false;
+    // --> typematic: synthetic RISE for held keys, through the same chain.
+    if (_typematic.isArmed()) {
+        _repeatKeys = _typematic.poll(uint32_t(getClock())) & _downKeys & ~evented;
 
-    // --> invoke key handlers.
-    for(IKeyHandler* handler: handlers) {
-        const EKeyState state = EKeyState(_keys[key].ls);
-        if (handler->onKeyUpdated(const_cast<Kbd*>(this), key, state)) {
-            retval = true;
-            break;
+        for(uint32_t bits = _repeatKeys; bits; bits &= bits - 1) {
+            setLevel(EKey(__builtin_ctz(bits)), EKLS_RISE);
+        }
+
+        changed |= _repeatKeys;
+    }
+
+    if (changed == 0) {
+        if (ticked) {
+            notifyPost();
         }
+
+        return ticked;
     }
 
-    // --> notify key state.
-    for(IKeyListener* listener: listeners) {
-        const EKeyState state = EKeyState(_keys[key].ls);
-        listener->onKeyNotify(this, key, state);
+    for(uint32_t bits = changed; bits; bits &= bits - 1) {
+        _keys[__builtin_ctz(bits)].ht = EKHT_PENDING;
     }
 
-    return retval;
+    _pendingKeys |= changed;
+    promote(changed);
+
+    // --> then, trigger key handlers.
+    const bool triggered = trigger();
+
+    latency->clearOrigin();
+    return triggered;
 }
 
-void Kbd::scanOnce() {
-    if (!_enabled) {
-        return;
+uint32_t Kbd::apply(const SKeyEvent& event, uint64_t nowUs) {
+    const EKey index = EKey(event.key);
+    if (index >= EKEY_MAX) {
+        return 0;
     }
 
-    FScannerList scanners;
-    for(IKeyScanner* scanner : _scanners) {
-        if (scanner->scanOnce()) {
-            scanners.push_back(scanner);
-        }
+    SKey* key = &_keys[index];
+
+    // --> widen the event time back to milliseconds since boot.
+    const uint32_t age = uint32_t(nowUs) - event.us;
+    key->ms = uint32_t((nowUs - age) / 1000);
+    key->us = event.us;
+
+    setLevel(index, EKeyState(event.state));
+
+    if (event.state == EKLS_RISE) {
+        _typematic.arm(index, event.us);
     }
 
-    // --> no key level change exists.
-    if (scanners.size() <= 0) {
-        // --> reverse pushed list to invoke scanners in reverse order.
-        return;
+    else {
+        _typematic.disarm(index);
+        _tapHold.release(index);
     }
 
-    std::reverse(scanners.begin(), scanners.end());
-    
-    // --> update level state and order-set.
-    updateOnce(scanners);
-    
-    // --> then, trigger key handlers.
-    trigger();
+    return 1u << index;
 }
 
-bool kbdGetKeyState(const Kbd::FScannerList& scanners, EKey key, bool& nextOut) {
-    for(IKeyScanner* scanner: scanners) {
-        if (scanner->takeState(key, nextOut)) {
-            return true;
-        }
+bool Kbd::isAnyKeyActive() const {
+    return _scanKeys != 0 || !_debouncer.isSettled() || !_events.isEmpty();
+}
+
+bool Kbd::enterIdle() {
+    bool supported = true;
+
+    _scanners.forEach([&supported](IKeyScanner* scanner) {
+        supported = scanner->enterIdle() && supported;
+        return false;
+    });
+
+    // --> a key is already down: keep scanning at full rate.
+    if (supported && _idle.arm()) {
+        return true;
     }
 
-    nextOut = false;
+    leaveIdle();
     return false;
 }
 
-void Kbd::updateOnce(const FScannerList& scanners) {
-    uint8_t order = 0, repos = 0;
-    EKey reorder[EKEY_MAX];
+void Kbd::leaveIdle() {
+    _scanners.forEach([](IKeyScanner* scanner) {
+        scanner->leaveIdle();
+        return false;
+    });
+}
+
+bool Kbd::updateOnce(IKeyScanner* const* scanners, uint32_t count) {
+    uint32_t present = 0, raw = 0;
+    uint32_t sampled = 0, age = 0;
+
+    const uint32_t now = uint32_t(getClock());
 
-    for(uint8_t index = 0; index < EKEY_MAX; ++index) {
-        const EKey defKey = EKey(index);
-        bool next = false;
+    // --> earlier scanners win the keys they present.
+    for(uint32_t i = 0; i < count; ++i) {
+        const uint32_t mask = scanners[i]->getMask() & ~present;
 
-        if (kbdGetKeyState(scanners, defKey, next) == false) {
-            reorder[repos++] = defKey;
+        // --> fully masked: its samples aren't used.
+        if (mask == 0) {
             continue;
         }
 
-        // --> current key.
-        SKey* key = &_keys[index];
-        bool prev = isKeyDown(defKey);
+        raw |= scanners[i]->getKeys() & mask;
+        present |= mask;
 
-        // --> this key has fixed order.
-        if (index == EKEY_HIDDEN) {
-            continue;
+        // --> keep the oldest sample time.
+        const uint32_t at = scanners[i]->getSampleTime();
+        if (at && now - at >= age) {
+            sampled = at;
+            age = now - at;
         }
+    }
 
-        if (prev == next) {
-            // --> same state.
-            if (key->ls == EKLS_RISE) {
-                key->ls = EKLS_HIGH;
-            }
+    if (sampled == 0) {
+        sampled = now;
+    }
 
-            else if (key->ls == EKLS_FALL) {
-                key->ls = EKLS_LOW;
-            }
+    // --> filter contact bouncing.
+    const uint32_t next = _debouncer.filterAll(raw, present, now);
+    const uint32_t levels = (_scanKeys ^ next) & present & ~(1u << EKEY_HIDDEN);
 
-            else {
-                key->ht = EKHT_TRIGGERED;
-                reorder[repos++] = defKey;
-                continue;
-            }
+    bool pushed = false;
+    for(uint32_t bits = levels; bits; bits &= bits - 1) {
+        const uint32_t index = __builtin_ctz(bits);
+        const uint32_t bit = 1u << index;
 
-            key->ht = EKHT_PENDING;
-            key->order = order++;
-            _orderedKeys[key->order] = defKey;
-            continue;
-        }
+        SKeyEvent event;
+        event.us = sampled;
+        event.key = uint8_t(index);
+        event.state = uint8_t((next & bit) ? EKLS_RISE : EKLS_FALL);
 
-        // --> different.
-        key->ht = EKHT_PENDING;
-        key->order = order++;
-        
-        if (next) {
-            key->ls = EKLS_RISE;
+        // --> full: the level stays unpushed and retries on the next scan.
+        if (_events.push(event) == false) {
+            break;
         }
 
-        else {
-            key->ls = EKLS_FALL;
-        }
-        
-        _orderedKeys[key->order] = defKey;
+        _scanKeys ^= bit;
+        pushed = true;
+
+        KbdLatency::get()->record(EKLT_CHANGE, age);
     }
 
-    // --> bubble sort.
-    for(uint8_t i = 0; i < repos; ++i) {
-        for(uint8_t j = 0; j < repos; ++j) {
-            const uint8_t left = _keys[reorder[i]].order;
-            const uint8_t right = _keys[reorder[j]].order;
+    return pushed;
+}
 
-            if (left > right) {
-                EKey temp = reorder[i];
-                reorder[i] = reorder[j];
-                reorder[j] = temp;
-            }
+void Kbd::setLevel(EKey key, EKeyState state) {
+    const uint32_t bit = 1u << key;
+    _keys[key].ls = state;
+
+    _downKeys &= ~bit;
+    _edgeKeys &= ~bit;
+
+    if (state == EKLS_RISE || state == EKLS_HIGH) {
+        _downKeys |= bit;
+    }
+
+    if (state == EKLS_RISE || state == EKLS_FALL) {
+        _edgeKeys |= bit;
+    }
+}
+
+void Kbd::promote(uint32_t keys) {
+    EKey rest[EKEY_MAX];
+    uint8_t order = 0, count = 0;
+
+    // --> others keep their previous order.
+    for(uint8_t i = 0; i < EKEY_MAX; ++i) {
+        const EKey key = _orderedKeys[i];
+
+        if ((keys & (1u << key)) == 0) {
+            rest[count++] = key;
         }
     }
 
-    // --> then assign keys to order set.
-    const uint8_t offset = order;
-    for(;order < EKEY_MAX; ++order) {
-        const EKey key = reorder[order - offset];
+    for(; keys; keys &= keys - 1) {
+        const EKey key = EKey(__builtin_ctz(keys));
 
         _keys[key].order = order;
-        _orderedKeys[order] = key;
+        _orderedKeys[order++] = key;
+    }
+
+    for(uint8_t i = 0; i < count; ++i) {
+        _keys[rest[i]].order = order;
+        _orderedKeys[order++] = rest[i];
     }
 }
 
-void Kbd::trigger() {
+bool Kbd::trigger() {
     EKey orderedKeys[EKEY_MAX];
     if (_handlers.size() <= 0) {
-        return; // --> no handler exists.
+        return false; // --> no handler exists.
+    }
+
+    if (_pendingKeys == 0) {
+        return false;
     }
 
     // --> make snapshot to trigger.
@@ -371,19 +463,64 @@ void Kbd::trigger() {
             }
 
             _keys[order].ht = EKHT_TRIGGERED;
+            _pendingKeys &= ~(1u << order);
             triggeredAnyway = true;
             handle(order);
         }
     }
 
     if (triggeredAnyway) {
-        FListenerList listeners(_listeners);
-        for(IKeyListener* listener: listeners) {
-            listener->onPostKeyNotify(this);
-        }
+        notifyPost();
     }
 
     //_postcb
+    return triggeredAnyway;
+}
+
+void Kbd::notifyPost() {
+    _listeners.forEach([this](IKeyListener* listener) {
+        listener->onPostKeyNotify(this);
+        return false;
+    });
+}
+
+bool Kbd::tickOnce() {
+    const uint32_t now = uint32_t(getClock());
+
+    if (int32_t(now - _tickAt) < 0) {
+        return false;
+    }
+
+    // --> handlers re-arm from their ticks if needed.
+    _tickArmed = 0;
+
+    bool changed = false;
+    _handlers.forEach([this, now, &changed](IKeyHandler* handler) {
+        changed = handler->onTick(this, now) || changed;
+        return false;
+    });
+
+    return changed;
+}
+
+void Kbd::sleepOnce() {
+    if (_tickArmed == 0) {
+        _idle.sleepOnce();
+        return;
+    }
+
+    // --> armed after idling, e.g. a macro played from the host.
+    const int32_t left = int32_t(_tickAt - uint32_t(getClock()));
+    _idle.sleepOnce(left > 0 ? uint32_t(left) : 0);
+}
+
+void Kbd::schedule(uint32_t us) {
+    if (_tickArmed && int32_t(us - _tickAt) >= 0) {
+        return;
+    }
+
+    _tickAt = us;
+    _tickArmed = 1;
 }
 
 SKey* Kbd::getKeyPtr(EKey key) const {
@@ -394,12 +531,91 @@ SKey* Kbd::getKeyPtr(EKey key) const {
     return &_keys[key];
 }
 
+bool Kbd::isKeyRepeat(EKey key) const {
+    if (key >= EKEY_MAX) {
+        return false;
+    }
+
+    return (_repeatKeys & (1u << key)) != 0;
+}
+
+bool Kbd::tapKey(EKey key) {
+    if (key >= EKEY_MAX || isKeyDown(key)) {
+        return false;
+    }
+
+    _tapKeys |= 1u << key;
+    return true;
+}
+
+bool Kbd::hideKey(EKey key, bool hidden) {
+    if (key >= EKEY_MAX) {
+        return false;
+    }
+
+    if (hidden) {
+        _hiddenKeys |= 1u << key;
+    }
+
+    else {
+        _hiddenKeys &= ~(1u << key);
+    }
+
+    return true;
+}
+
+bool Kbd::isKeyHidden(EKey key) const {
+    if (key >= EKEY_MAX) {
+        return false;
+    }
+
+    return (_hiddenKeys & (1u << key)) != 0;
+}
+
+bool Kbd::overrideKeyChar(EKey key, const SKeyChar* ch) {
+    if (key >= EKEY_MAX) {
+        return false;
+    }
+
+    if (ch) {
+        _overChars[key] = *ch;
+        _overKeys |= 1u << key;
+    }
+
+    else {
+        _overKeys &= ~(1u << key);
+    }
+
+    return true;
+}
+
+uint32_t Kbd::getKeyTime(EKey key) const {
+    if (key >= EKEY_MAX) {
+        return 0;
+    }
+
+    return _keys[key].us;
+}
+
+uint64_t Kbd::getClock() const {
+    const uint64_t now = time_us_64();
+
+    // --> replays stay deterministic: debounce, tap-hold and repeats
+    //     all run on trace times, however late the scans are.
+    const KbdReplayScanner* replay = KbdReplayScanner::instance();
+    if (replay->isPlaying()) {
+        return now + int32_t(replay->getClock() - uint32_t(now));
+    }
+
+    return now;
+}
+
 SKeyChar Kbd::getDefaultKeyChar(EKey key) const {
     if (key >= EKEY_MAX) {
         return {0, };
     }
 
-    return KEY_MAP[key];
+    return KbdLayers::getDefaultKeyChar(key);
 }
 
 SKeyChar Kbd::getKeyChar(EKey key) const {
@@ -407,6 +623,24 @@ SKeyChar Kbd::getKeyChar(EKey key) const {
         return {0, };
     }
 
+    // --> handlers' overrides win over keymaps.
+    if (_overKeys & (1u << key)) {
+        return _overChars[key];
+    }
+
+    // --> dual keys resolved as hold report their modifier only.
+    if (_tapHold.isHeld(key)) {
+        return { 0, 0, KC_NONE, _tapHold.getHoldMod(key) };
+    }
+
+    // --> the base layer is editable: it lives in key configurations.
+    const EKeyLayer layer = _keys[key].ls == EKLS_LOW
+        ? _layers.resolve(key) : EKeyLayer(_keys[key].ly);
+
+    if (layer != EKLY_BASE) {
+        return KbdLayers::getLayer(layer)->keys[key];
+    }
+
     return _keys[key].ch;
 }
 
@@ -421,7 +655,7 @@ bool Kbd::setKeyChar(EKey key, SKeyChar ch) {
 
 void Kbd::resetKeyChars() {
     for(uint8_t i = 0; i < EKEY_MAX; ++i) {
-        _keys[i].ch = KEY_MAP[i];
+        _keys[i].ch = KbdLayers::getDefaultKeyChar(EKey(i));
     }
 }
 
@@ -473,6 +707,10 @@ uint8_t Kbd::getPressingKeys(EKey* outKeys, uint8_t max) const {
         }
 
         EKey key = _orderedKeys[i];
+        if (_hiddenKeys & (1u << key)) {
+            continue;
+        }
+
         if (_keys[key].ls == EKLS_HIGH ||
             _keys[key].ls == EKLS_RISE) 
         {
@@ -503,7 +741,8 @@ bool Kbd::forceKeyState(EKey key, EKeyState state) {
 
     // --> changes the key state.
     ref.ht = EKHT_PENDING;
-    ref.ls = state;
+    _pendingKeys |= 1u << key;
+    setLevel(key, state);
 
     // --> shift all keys back.
     for(int8_t i = order; i > 0; --i) {
@@ -520,27 +759,20 @@ bool Kbd::forceKeyState(EKey key, EKeyState state) {
     return true;
 }
 
-void Kbd::getStateListeners(std::vector<IKbdState*>& listeners) {
-    for(IKeyHandler* handler : _handlers) {
-        listeners.push_back(handler);
-    }
-    
-    for(IKeyListener* listener : _listeners) {
-        listeners.push_back(listener);
-    }
-}
-
 bool Kbd::enable() {
     if (_enabled) {
         return false;
     }
 
-    std::vector<IKbdState*> listeners;
-    getStateListeners(listeners);
+    _handlers.forEach([this](IKeyHandler* handler) {
+        handler->onEnabled(this);
+        return false;
+    });
 
-    for(IKbdState* listener: listeners) {
+    _listeners.forEach([this](IKeyListener* listener) {
         listener->onEnabled(this);
-    }
+        return false;
+    });
 
     _enabled = 1;
     return false;
@@ -551,12 +783,15 @@ bool Kbd::disable() {
         return false;
     }
 
-    std::vector<IKbdState*> listeners;
-    getStateListeners(listeners);
+    _handlers.forEach([this](IKeyHandler* handler) {
+        handler->onDisabled(this);
+        return false;
+    });
 
-    for(IKbdState* listener: listeners) {
+    _listeners.forEach([this](IKeyListener* listener) {
         listener->onDisabled(this);
-    }
+        return false;
+    });
 
     _enabled = 0;
     return true;
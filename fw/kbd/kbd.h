@@ -2,8 +2,14 @@
 #define __KBD_H__
 
 #include <stdint.h>
-#include <vector>
 #include "keys.h"
+#include "debounce.h"
+#include "idle.h"
+#include "registry.h"
+#include "event.h"
+#include "typematic.h"
+#include "taphold.h"
+#include "layers.h"
 
 // --> forward decls.
 class IKeyScanner;
@@ -16,13 +22,14 @@ class IKeyListener;
  */
 class Kbd {
 public:
-    // --> shortcuts.
-    using FScannerList = std::vector<IKeyScanner*>;
-    using FHandlerList = std::vector<IKeyHandler*>;
-    using FListenerList = std::vector<IKeyListener*>;
+    static constexpr uint32_t MAX_SCANNERS = 4;
+    static constexpr uint32_t MAX_HANDLERS = 8;
+    static constexpr uint32_t MAX_LISTENERS = 8;
 
-private:
-    static const SKeyChar KEY_MAP[EKEY_MAX];
+    // --> shortcuts.
+    using FScannerList = KbdRegistry<IKeyScanner, MAX_SCANNERS>;
+    using FHandlerList = KbdRegistry<IKeyHandler, MAX_HANDLERS>;
+    using FListenerList = KbdRegistry<IKeyListener, MAX_LISTENERS>;
 
 public:
     /* get the keyboard instance. */
@@ -32,12 +39,49 @@ private:
     /* key configurations. */
     mutable SKey _keys[EKEY_MAX];
     EKey _orderedKeys[EKEY_MAX];
+
+    /* key state bitmaps, bit N: EKey(N). */
+    uint32_t _downKeys;     // --> EKLS_RISE or EKLS_HIGH.
+    uint32_t _edgeKeys;     // --> EKLS_RISE or EKLS_FALL, settle on next dispatch.
+    uint32_t _pendingKeys;  // --> EKHT_PENDING.
+    uint32_t _repeatKeys;   // --> synthetic EKLS_RISE in the last dispatch.
+    uint32_t _tapKeys;      // --> released keys to report as a tap in the last dispatch.
+    uint32_t _hiddenKeys;   // --> held back from reports by handlers.
+    uint32_t _overKeys;     // --> keys with an overridden key character.
+
+    /* key characters overridden by handlers. */
+    SKeyChar _overChars[EKEY_MAX];
+
+    /* handler tick, requested by handlers. */
+    uint32_t _tickAt;
+    uint8_t _tickArmed;
+
+    /* scan stage: debounced levels already pushed as events. */
+    uint32_t _scanKeys;
+
+    /* events from the scan stage to the dispatch stage. */
+    KbdEventRing _events;
     
     /* key handlers. */
     FScannerList _scanners;
     FHandlerList _handlers;
     FListenerList _listeners;
 
+    /* debounce stage between scanners and updates. */
+    KbdDebouncer _debouncer;
+
+    /* idle-aware scan scheduler. */
+    KbdIdle _idle;
+
+    /* key repeat engine, runs in the dispatch stage. */
+    KbdTypematic _typematic;
+
+    /* dual-role key resolver, between the event ring and key states. */
+    KbdTapHold _tapHold;
+
+    /* active keymap layers. */
+    KbdLayers _layers;
+
     /* enable/disable states. */
     uint8_t _enabled, _reserved;
     
@@ -65,23 +109,104 @@ public:
 
 private:
     /* invoke handler for the specified key. */
-    bool handle(EKey key) const;
+    bool handle(EKey key);
 
 public:
-    /* scan all key states and update. */
-    void scanOnce();
+    /* scan all key states and push level changes, returns true if any. */
+    bool scanOnce();
+
+    /**
+     * dispatch pushed events to handlers, returns true if any key triggered.
+     * this can run on either core, but only on one at the same time.
+     */
+    bool dispatchOnce();
+
+    /* sleep while idle, until the next handler tick at most. */
+    void sleepOnce();
 
 private:
-    /* update all key states. */
-    void updateOnce(const FScannerList& scanners);
+    /* filter levels from scanners, ordered by priority, and push changes. */
+    bool updateOnce(IKeyScanner* const* scanners, uint32_t count);
+
+    /* apply an event to the key state, returns the key bit. */
+    uint32_t apply(const SKeyEvent& event, uint64_t nowUs);
+
+    /* set the level state of the key and its bitmaps. */
+    void setLevel(EKey key, EKeyState state);
+
+    /* move keys to the front of the order set, keeping others' order. */
+    void promote(uint32_t keys);
+
+    /* trigger handlers for keys, returns true if any key triggered. */
+    bool trigger();
+
+    /* invoke the post notification of listeners. */
+    void notifyPost();
+
+    /* tick handlers if requested, returns true if any report changed. */
+    bool tickOnce();
+
+    /* test whether any key is held or still settling. */
+    bool isAnyKeyActive() const;
+
+    /* hold scanners idle and arm the wake, returns false if not possible. */
+    bool enterIdle();
 
-    /* trigger handlers for keys. */
-    void trigger();
+    /* resume scanners from idle. */
+    void leaveIdle();
 
 public:
+    /* get the debounce stage to configure. */
+    KbdDebouncer* getDebouncer() { return &_debouncer; }
+
+    /* get the idle scan scheduler to configure or sleep on. */
+    KbdIdle* getIdle() { return &_idle; }
+
+    /* get the key repeat engine to configure. */
+    KbdTypematic* getTypematic() { return &_typematic; }
+
+    /* get the dual-role key resolver to configure. */
+    KbdTapHold* getTapHold() { return &_tapHold; }
+
+    /* get the active keymap layers. */
+    KbdLayers* getLayers() { return &_layers; }
+
+    /* get the event ring between scanning and dispatching, for statistics. */
+    const KbdEventRing* getEvents() const { return &_events; }
+
     /* get the key pointer for the specified key. */
     SKey* getKeyPtr(EKey key) const;
 
+    /* test whether the key rose by the repeat engine in this dispatch. */
+    bool isKeyRepeat(EKey key) const;
+
+    /* get released keys to report as a tap in this dispatch, bit N: EKey(N). */
+    uint32_t getTapKeys() const { return _tapKeys; }
+
+    /* report the released key as a tap, from handlers. */
+    bool tapKey(EKey key);
+
+    /* hold the key back from reports or release it, from handlers. */
+    bool hideKey(EKey key, bool hidden);
+
+    /* test whether the key is held back from reports or not. */
+    bool isKeyHidden(EKey key) const;
+
+    /* override the key character, null restores it. */
+    bool overrideKeyChar(EKey key, const SKeyChar* ch);
+
+    /* request a handler tick at `us` (lower 32 bits), the earliest wins. */
+    void schedule(uint32_t us);
+
+    /* inject a key event ahead of the dispatch stage, from handlers. */
+    bool inject(const SKeyEvent& event) { return _tapHold.push(event); }
+
+    /* get the exact timestamp (us, lower 32 bits) of the last key event. */
+    uint32_t getKeyTime(EKey key) const;
+
+    /* get the keyboard clock (us), the replay clock while a trace plays. */
+    uint64_t getClock() const;
+
     /* get the default key character data. */
     SKeyChar getDefaultKeyChar(EKey key) const;
 
@@ -106,16 +231,12 @@ public:
     /* get the last key number in the state. */
     EKey getRecentKey(EKeyState state) const;
 
-    /* get pressing keys based on order value. */
+    /* get pressing keys based on order value, except held back ones. */
     uint8_t getPressingKeys(EKey* outKeys, uint8_t max) const;
 
     /* set the key state forcibly. */
     bool forceKeyState(EKey key, EKeyState state);
 
-private:
-    /* get all state listeners. */
-    void getStateListeners(std::vector<IKbdState*>& listeners);
-
 public:
     /* test whether the keyboard update enabled or not. */
     bool isEnabled() const { return _enabled != 0; }
@@ -142,8 +263,20 @@ public:
     /* test whether no scanning result changes or not. */
     virtual bool isEmpty() const = 0;
 
-    /* take the latest scanned state and return true if key presents. */
-    virtual bool takeState(EKey key, bool& nextOut) const = 0;
+    /* get the latest scanned key bitmap, bit N: EKey(N). */
+    virtual uint32_t getKeys() const = 0;
+
+    /* get the keys this scanner presents, others are left to other scanners. */
+    virtual uint32_t getMask() const = 0;
+
+    /* get the time (us, lower 32 bits) of the latest GPIO sample, zero if unknown. */
+    virtual uint32_t getSampleTime() const { return 0; }
+
+    /* hold all rows high for the column wake, returns false if unsupported. */
+    virtual bool enterIdle() { return false; }
+
+    /* restore rows for scanning. */
+    virtual void leaveIdle() { }
 };
 
 /**
@@ -176,6 +309,12 @@ public:
      * if this returns false for the key, it will yield process to other listener.
      */
     virtual bool onKeyUpdated(Kbd* kbd, EKey key, EKeyState state) = 0;
+
+    /**
+     * called on the time requested by `Kbd::schedule`.
+     * returns true if reported keys are changed.
+     */
+    virtual bool onTick(Kbd* kbd, uint32_t now) { return false; }
 };
 
 /**
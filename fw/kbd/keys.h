@@ -92,10 +92,12 @@ struct SKey {
     uint8_t order;  // --> level state order, 0: not needed, 1: pending.
     uint8_t ht;     // --> handler triggered or not.
     uint32_t ms;    // --> timestamp when key state changed.
+    uint32_t us;    // --> GPIO sample time of the change, lower 32 bits of `time_us_64`.
     uint8_t ls;     // --> key state.
     uint8_t ts;     // --> toggle state.
     uint8_t tm;     // --> toggle mode.
     SKeyChar ch;    // --> key character.
+    uint8_t ly;     // --> EKeyLayer latched on press, used until released.
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,123 @@
+#include "latency.h"
+#include <string.h>
+
+KbdLatency::KbdLatency() {
+    reset();
+    _origin = 0;
+    _hasOrigin = 0;
+}
+
+KbdLatency* KbdLatency::get() {
+    static KbdLatency _latency;
+    return &_latency;
+}
+
+uint32_t KbdLatency::bucketOf(uint32_t us) {
+    if (us < SUB) {
+        return us;
+    }
+
+    const uint32_t exp = 31 - __builtin_clz(us);
+    if (exp >= MAX_EXP) {
+        return MAX_BUCKETS - 1;
+    }
+
+    const uint32_t sub = (us >> (exp - SUB_BITS)) & (SUB - 1);
+    return (exp - SUB_BITS + 1) * SUB + sub;
+}
+
+uint32_t KbdLatency::upperOf(uint32_t bucket) {
+    if (bucket < SUB) {
+        return bucket;
+    }
+
+    const uint32_t exp = bucket / SUB + SUB_BITS - 1;
+    const uint32_t sub = bucket % SUB;
+    const uint32_t width = 1u << (exp - SUB_BITS);
+
+    return ((SUB + sub) << (exp - SUB_BITS)) + width - 1;
+}
+
+void KbdLatency::record(EKbdLatencyStage stage, uint32_t us) {
+    if (stage >= EKLT_MAX_VALUE) {
+        return;
+    }
+
+    SStage& st = _stages[stage];
+    if (st.count == 0 || us < st.min) {
+        st.min = us;
+    }
+
+    if (us > st.max) {
+        st.max = us;
+    }
+
+    const uint32_t bucket = bucketOf(us);
+    st.hist[bucket] = st.hist[bucket] + 1;
+    st.count = st.count + 1;
+}
+
+void KbdLatency::recordFromOrigin(EKbdLatencyStage stage, uint32_t now) {
+    if (_hasOrigin) {
+        record(stage, now - _origin);
+    }
+}
+
+uint32_t KbdLatency::percentile(EKbdLatencyStage stage, uint32_t permille) const {
+    if (stage >= EKLT_MAX_VALUE) {
+        return 0;
+    }
+
+    const SStage& st = _stages[stage];
+    const uint32_t count = st.count;
+
+    if (count == 0) {
+        return 0;
+    }
+
+    // --> rank of the record, rounded up.
+    const uint32_t rank = uint32_t((uint64_t(count) * permille + 999) / 1000);
+    uint32_t sum = 0;
+
+    for(uint32_t i = 0; i < MAX_BUCKETS; ++i) {
+        sum += st.hist[i];
+
+        if (sum >= rank) {
+            // --> never report beyond the real maximum.
+            const uint32_t upper = upperOf(i);
+            return upper < st.max ? upper : st.max;
+        }
+    }
+
+    return st.max;
+}
+
+bool KbdLatency::query(EKbdLatencyStage stage, SKbdLatency& out) const {
+    if (stage >= EKLT_MAX_VALUE) {
+        return false;
+    }
+
+    const SStage& st = _stages[stage];
+
+    out.count = st.count;
+    out.min = st.min;
+    out.max = st.max;
+    out.p50 = percentile(stage, 500);
+    out.p90 = percentile(stage, 900);
+    out.p99 = percentile(stage, 990);
+    return true;
+}
+
+void KbdLatency::reset() {
+    for(uint32_t i = 0; i < EKLT_MAX_VALUE; ++i) {
+        SStage& st = _stages[i];
+
+        st.count = 0;
+        st.min = 0;
+        st.max = 0;
+
+        for(uint32_t j = 0; j < MAX_BUCKETS; ++j) {
+            st.hist[j] = 0;
+        }
+    }
+}
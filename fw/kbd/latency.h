@@ -0,0 +1,99 @@
+#ifndef __KBD_LATENCY_H__
+#define __KBD_LATENCY_H__
+
+#include <stdint.h>
+
+/**
+ * latency stages, measured from the GPIO sample of the key.
+ */
+enum EKbdLatencyStage {
+    EKLT_CHANGE = 0,        // --> state change in `Kbd::updateOnce`.
+    EKLT_DISPATCH,          // --> handler dispatch in `Kbd::dispatchOnce`.
+    EKLT_HID,               // --> HID report submission.
+    EKLT_MAX_VALUE
+};
+
+/**
+ * summary of a latency stage, in microseconds.
+ */
+struct SKbdLatency {
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint32_t p50;
+    uint32_t p90;
+    uint32_t p99;
+};
+
+/**
+ * key-to-HID latency histograms.
+ * buckets are log-linear: 4 sub-buckets per power of two, so percentiles
+ * are within 25% of the real value. each stage has a single writer.
+ */
+class KbdLatency {
+public:
+    static constexpr uint32_t SUB_BITS = 2;
+    static constexpr uint32_t SUB = 1 << SUB_BITS;
+    static constexpr uint32_t MAX_EXP = 24;     // --> clamp at 2^24 us.
+    static constexpr uint32_t MAX_BUCKETS = (MAX_EXP - SUB_BITS + 1) * SUB;
+
+private:
+    /* per-stage counters. */
+    struct SStage {
+        volatile uint32_t count;
+        volatile uint32_t min;
+        volatile uint32_t max;
+        volatile uint32_t hist[MAX_BUCKETS];
+    };
+
+private:
+    SStage _stages[EKLT_MAX_VALUE];
+
+    /* sample time of the oldest event in the running dispatch. */
+    volatile uint32_t _origin;
+    volatile uint8_t _hasOrigin;
+
+private:
+    KbdLatency();
+
+public:
+    /* get the singleton instance. */
+    static KbdLatency* get();
+
+    /* get the bucket for microseconds. */
+    static uint32_t bucketOf(uint32_t us);
+
+    /* get the highest microseconds of the bucket. */
+    static uint32_t upperOf(uint32_t bucket);
+
+public:
+    /* record a latency for the stage. */
+    void record(EKbdLatencyStage stage, uint32_t us);
+
+    /* set the sample time that the running dispatch started from. */
+    void setOrigin(uint32_t sampled) { _origin = sampled; _hasOrigin = 1; }
+
+    /* clear the origin after the dispatch. */
+    void clearOrigin() { _hasOrigin = 0; }
+
+    /* get the origin of the running dispatch, returns false if none. */
+    bool getOrigin(uint32_t& originOut) const {
+        originOut = _origin;
+        return _hasOrigin != 0;
+    }
+
+    /* record the stage from the origin, if a dispatch is running. */
+    void recordFromOrigin(EKbdLatencyStage stage, uint32_t now);
+
+public:
+    /* get the latency under which `permille` of records fall. */
+    uint32_t percentile(EKbdLatencyStage stage, uint32_t permille) const;
+
+    /* get the summary of the stage. */
+    bool query(EKbdLatencyStage stage, SKbdLatency& out) const;
+
+    /* reset all stages. */
+    void reset();
+};
+
+#endif
@@ -0,0 +1,207 @@
+#include "layers.h"
+#include "scancode.h"
+
+/**
+ * key binding of a layer.
+ */
+struct SKeyBinding {
+    EKey key;
+    SKeyChar ch;
+};
+
+static constexpr SKeyBinding BASE_KEYS[] = {
+    { EKEY_SLASH,       { '/', '/',     KC_KEYPAD_DIVIDE,   0 } },
+    { EKEY_ASTEROID,    { '*', '*',     KC_KEYPAD_MULTIPLY, 0 } },
+    { EKEY_MINUS,       { '-', '-',     KC_KEYPAD_SUBTRACT, 0 } },
+    { EKEY_NUMLOCK,     { 0, 0,         KC_NUM_LOCK,        0 } },
+    { EKEY_NUM_7,       { '7', 'H',     KC_KEYPAD_7,        0 } },
+    { EKEY_NUM_8,       { '8', 'U',     KC_KEYPAD_8,        0 } },
+    { EKEY_NUM_9,       { '9', 'P',     KC_KEYPAD_9,        0 } },
+    { EKEY_PLUS,        { '+', '+',     KC_KEYPAD_ADD,      0 } },
+    { EKEY_NUM_4,       { '4', 'L',     KC_KEYPAD_4,        0 } },
+    { EKEY_NUM_5,       { '5', ' ',     KC_KEYPAD_5,        0 } },
+    { EKEY_NUM_6,       { '6', 'R',     KC_KEYPAD_6,        0 } },
+    { EKEY_ENTER,       { '\n', '\n',   KC_KEYPAD_ENTER,    0 } },
+    { EKEY_NUM_1,       { '1', 'E',     KC_KEYPAD_1,        0 } },
+    { EKEY_NUM_2,       { '2', 'D',     KC_KEYPAD_2,        0 } },
+    { EKEY_NUM_3,       { '3', 'S',     KC_KEYPAD_3,        0 } },
+    { EKEY_NUM_0,       { '0', 'I',     KC_KEYPAD_0,        0 } },
+    { EKEY_DOT,         { '.', 'B',     KC_KEYPAD_DECIMAL,  0 } },
+};
+
+static constexpr SKeyBinding NAV_KEYS[] = {
+    { EKEY_NUM_7,       { EKCTL_HOME, EKCTL_HOME,               KC_HOME,        0 } },
+    { EKEY_NUM_8,       { EKCTL_ARROW_UP, EKCTL_ARROW_UP,       KC_ARROW_UP,    0 } },
+    { EKEY_NUM_9,       { EKCTL_PAGE_UP, EKCTL_PAGE_UP,         KC_PAGE_UP,     0 } },
+    { EKEY_NUM_4,       { EKCTL_ARROW_LEFT, EKCTL_ARROW_LEFT,   KC_ARROW_LEFT,  0 } },
+    { EKEY_NUM_6,       { EKCTL_ARROW_RIGHT, EKCTL_ARROW_RIGHT, KC_ARROW_RIGHT, 0 } },
+    { EKEY_NUM_1,       { EKCTL_END, EKCTL_END,                 KC_END,         0 } },
+    { EKEY_NUM_2,       { EKCTL_ARROW_DOWN, EKCTL_ARROW_DOWN,   KC_ARROW_DOWN,  0 } },
+    { EKEY_NUM_3,       { EKCTL_PAGE_DOWN, EKCTL_PAGE_DOWN,     KC_PAGE_DOWN,   0 } },
+    { EKEY_NUM_0,       { EKCTL_INSERT, EKCTL_INSERT,           KC_INSERT,      0 } },
+    { EKEY_DOT,         { EKCTL_BACKSPACE, EKCTL_BACKSPACE,     KC_BACKSPACE,   0 } },
+};
+
+/**
+ * bindings of a layer and the key character of unbound keys.
+ */
+struct SKeyLayerDecl {
+    const SKeyBinding* bindings;
+    uint32_t count;
+    SKeyChar unbound;
+};
+
+#define KEY_LAYER_DECL(bindings, unbound) \
+    { bindings, sizeof(bindings) / sizeof(SKeyBinding), unbound }
+
+#define KEY_MAP_UNMAPPED     { 0, 0, KC_NONE, 0 }
+#define KEY_MAP_TRANSPARENT  { 0, 0, KC_TRNS, 0 }
+
+static constexpr SKeyLayerDecl LAYER_DECLS[EKLY_MAX] = {
+    KEY_LAYER_DECL(BASE_KEYS, KEY_MAP_UNMAPPED),    // EKLY_BASE
+    KEY_LAYER_DECL(NAV_KEYS, KEY_MAP_TRANSPARENT),  // EKLY_NAV
+};
+
+/* test whether the key code can be reported or not. */
+static constexpr bool kbdIsValidCode(uint8_t kc) {
+    return kc <= KC_F15 || (kc >= KC_CONTROL_LEFT && kc <= KC_GUI_RIGHT);
+}
+
+/* test whether all bindings are on reportable keys with valid codes. */
+static constexpr bool kbdCheckBindings(const SKeyLayerDecl& decl) {
+    for(uint32_t i = 0; i < decl.count; ++i) {
+        const SKeyBinding& binding = decl.bindings[i];
+
+        if (binding.key >= EKEY_MAX || binding.key == EKEY_HIDDEN) {
+            return false;
+        }
+
+        if (!kbdIsValidCode(binding.ch.kc)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/* test whether a key or a key code is bound twice in the layer. */
+static constexpr bool kbdHasDuplicates(const SKeyLayerDecl& decl) {
+    for(uint32_t i = 0; i < decl.count; ++i) {
+        for(uint32_t j = i + 1; j < decl.count; ++j) {
+            const SKeyBinding& a = decl.bindings[i];
+            const SKeyBinding& b = decl.bindings[j];
+
+            if (a.key == b.key || (a.ch.kc != KC_NONE && a.ch.kc == b.ch.kc)) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+/* test all layer declarations. */
+static constexpr bool kbdCheckLayers(bool (*check)(const SKeyLayerDecl&), bool expect) {
+    for(uint32_t i = 0; i < EKLY_MAX; ++i) {
+        if (check(LAYER_DECLS[i]) != expect) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static_assert(EKLY_MAX <= KbdLayers::MAX_LAYERS, "kbd: too many layers.");
+static_assert(LAYER_DECLS[EKLY_BASE].unbound.kc != KC_TRNS, "kbd: the base layer can't be transparent.");
+static_assert(kbdCheckLayers(kbdCheckBindings, true), "kbd: invalid key or key code in layers.");
+static_assert(kbdCheckLayers(kbdHasDuplicates, false), "kbd: duplicate key or key code in a layer.");
+
+/**
+ * layer tables, built from declarations.
+ */
+struct SKeyLayerSet {
+    SKeyLayer layers[EKLY_MAX];
+    uint32_t masks[EKEY_MAX];   // --> layers that define the key.
+};
+
+static constexpr SKeyLayerSet kbdBuildLayers() {
+    SKeyLayerSet set = { };
+
+    for(uint32_t n = 0; n < EKLY_MAX; ++n) {
+        const SKeyLayerDecl& decl = LAYER_DECLS[n];
+        SKeyLayer& layer = set.layers[n];
+
+        for(uint32_t i = 0; i < EKEY_MAX; ++i) {
+            layer.keys[i] = decl.unbound;
+        }
+
+        for(uint32_t i = 0; i < decl.count; ++i) {
+            layer.keys[decl.bindings[i].key] = decl.bindings[i].ch;
+        }
+
+        for(uint32_t i = 0; i < EKEY_MAX; ++i) {
+            if (layer.keys[i].kc != KC_TRNS) {
+                set.masks[i] |= 1u << n;
+            }
+        }
+    }
+
+    return set;
+}
+
+static constexpr SKeyLayerSet LAYERS = kbdBuildLayers();
+
+// --> the base layer ends every lookup.
+static_assert(LAYERS.masks[EKEY_HIDDEN] & (1u << EKLY_BASE), "kbd: the base layer must define all keys.");
+
+const SKeyLayer* KbdLayers::getLayer(EKeyLayer layer) {
+    if (layer >= EKLY_MAX) {
+        return nullptr;
+    }
+
+    return &LAYERS.layers[layer];
+}
+
+SKeyChar KbdLayers::getDefaultKeyChar(EKey key) {
+    if (key >= EKEY_MAX) {
+        return { 0, };
+    }
+
+    return LAYERS.layers[EKLY_BASE].keys[key];
+}
+
+bool KbdLayers::activate(EKeyLayer layer) {
+    if (layer >= EKLY_MAX) {
+        return false;
+    }
+
+    _active |= 1u << layer;
+    return true;
+}
+
+bool KbdLayers::deactivate(EKeyLayer layer) {
+    if (layer >= EKLY_MAX || layer == EKLY_BASE) {
+        return false;
+    }
+
+    _active &= ~(1u << layer);
+    return true;
+}
+
+bool KbdLayers::toggle(EKeyLayer layer) {
+    if (isActive(layer)) {
+        return deactivate(layer);
+    }
+
+    return activate(layer);
+}
+
+EKeyLayer KbdLayers::resolve(EKey key) const {
+    if (key >= EKEY_MAX) {
+        return EKLY_BASE;
+    }
+
+    // --> never zero: the base layer is always active and defines all keys.
+    const uint32_t layers = _active & LAYERS.masks[key];
+    return EKeyLayer(31 - __builtin_clz(layers));
+}
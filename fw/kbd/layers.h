@@ -0,0 +1,69 @@
+#ifndef __KBD_LAYERS_H__
+#define __KBD_LAYERS_H__
+
+#include <stdint.h>
+#include "keys.h"
+
+/**
+ * keymap layers, higher layers win.
+ */
+enum EKeyLayer {
+    EKLY_BASE = 0,      // --> always active, editable at runtime.
+    EKLY_NAV,           // --> navigation keys on the number pad.
+    EKLY_MAX,
+    EKLY_INVALID = 0xff
+};
+
+/**
+ * keymap layer, `KC_TRNS` falls through to lower layers.
+ */
+struct SKeyLayer {
+    SKeyChar keys[EKEY_MAX];
+};
+
+/**
+ * active layer set.
+ * keymaps are `constexpr` tables checked at compile time, with a per-key
+ * bitmask of layers that define the key. resolving a key is one AND with
+ * the active set and a count-leading-zeros, whatever the layer count.
+ */
+class KbdLayers {
+public:
+    static constexpr uint32_t MAX_LAYERS = 32;
+
+private:
+    uint32_t _active;   // --> bit N: EKeyLayer(N).
+
+public:
+    KbdLayers() : _active(1u << EKLY_BASE) { }
+
+public:
+    /* get the layer table. */
+    static const SKeyLayer* getLayer(EKeyLayer layer);
+
+    /* get the default key character of the base layer. */
+    static SKeyChar getDefaultKeyChar(EKey key);
+
+public:
+    /* activate the layer. */
+    bool activate(EKeyLayer layer);
+
+    /* deactivate the layer, the base layer can't be. */
+    bool deactivate(EKeyLayer layer);
+
+    /* toggle the layer. */
+    bool toggle(EKeyLayer layer);
+
+    /* test whether the layer is active or not. */
+    bool isActive(EKeyLayer layer) const {
+        return layer < EKLY_MAX && (_active & (1u << layer)) != 0;
+    }
+
+    /* get the active layer set, bit N: EKeyLayer(N). */
+    uint32_t getActive() const { return _active; }
+
+    /* get the highest active layer that defines the key. */
+    EKeyLayer resolve(EKey key) const;
+};
+
+#endif
@@ -0,0 +1,169 @@
+#include "macro.h"
+
+bool KbdMacro::append(const SMacroStep& step) {
+    if (step.key >= EKEY_MAX) {
+        return false;
+    }
+
+    // --> a longer pause plays as the longest one.
+    const uint32_t delay = step.delay < MAX_DELAY_MS ? step.delay : MAX_DELAY_MS;
+
+    uint32_t value = (delay << 6) | (step.key << 1);
+    if (step.state == EKLS_RISE) {
+        value |= 1;
+    }
+
+    uint8_t temp[MAX_STEP_BYTES];
+    uint32_t length = 0;
+
+    // --> LEB128: 7 bits per byte, the high bit continues.
+    do {
+        temp[length] = uint8_t(value & 0x7f);
+        value >>= 7;
+
+        if (value) {
+            temp[length] |= 0x80;
+        }
+
+        length++;
+    } while(value);
+
+    if (_size + length > MAX_BYTES) {
+        return false;
+    }
+
+    for(uint32_t i = 0; i < length; ++i) {
+        _bytes[_size++] = temp[i];
+    }
+
+    _steps++;
+    return true;
+}
+
+uint32_t KbdMacro::decode(uint32_t offset, SMacroStep& out) const {
+    uint64_t value = 0;
+    uint32_t shift = 0;
+
+    while(offset < _size && shift < 7 * MAX_STEP_BYTES) {
+        const uint8_t byte = _bytes[offset++];
+        value |= uint64_t(byte & 0x7f) << shift;
+
+        if ((byte & 0x80) == 0) {
+            out.delay = uint32_t(value >> 6);
+            out.key = uint8_t((value >> 1) & 0x1f);
+            out.state = uint8_t((value & 1) ? EKLS_RISE : EKLS_FALL);
+
+            return out.key < EKEY_MAX ? offset : 0;
+        }
+
+        shift += 7;
+    }
+
+    // --> truncated or the end.
+    return 0;
+}
+
+KbdMacroPlayer::KbdMacroPlayer(const KbdMacro* macro, const IKbdMacroClock* clock, IKbdMacroSink* sink)
+    : _macro(macro), _clock(clock), _sink(sink)
+{
+    _offset = _due = _down = 0;
+    _next = { 0, };
+
+    _state = EKMS_IDLE;
+    _mode = EKMM_ORIGINAL;
+}
+
+bool KbdMacroPlayer::play(EKbdMacroMode mode) {
+    if (_state != EKMS_IDLE || mode >= EKMM_MAX_VALUE) {
+        return false;
+    }
+
+    _offset = _macro->decode(0, _next);
+    if (_offset == 0) {
+        return false;
+    }
+
+    _mode = mode;
+    _down = 0;
+    _due = _clock->getTime();
+
+    _state = EKMS_PLAYING;
+    _sink->schedule(_due);
+    return true;
+}
+
+void KbdMacroPlayer::stop() {
+    if (_state == EKMS_IDLE) {
+        return;
+    }
+
+    const uint32_t now = _clock->getTime();
+
+    // --> never leave keys pressed by the macro: retry what is left.
+    if (release(now) == false) {
+        _state = EKMS_STOPPING;
+        _sink->schedule(now + FAST_STEP_US);
+        return;
+    }
+
+    _state = EKMS_IDLE;
+}
+
+void KbdMacroPlayer::onTick(uint32_t now) {
+    if (_state == EKMS_STOPPING) {
+        stop();
+        return;
+    }
+
+    if (_state != EKMS_PLAYING) {
+        return;
+    }
+
+    while(int32_t(now - _due) >= 0) {
+        if (!inject(_next.key, _next.state, now)) {
+            // --> no room: retry on the next HID polling interval.
+            _due = now + FAST_STEP_US;
+            break;
+        }
+
+        const uint32_t offset = _macro->decode(_offset, _next);
+        if (offset == 0) {
+            stop();
+            return;
+        }
+
+        _offset = offset;
+
+        if (_mode == EKMM_FAST) {
+            _due = now + FAST_STEP_US;
+            break;
+        }
+
+        // --> from the previous due, not from now, to keep original timing.
+        //     clamped: decoded bytes may not come from `append`.
+        const uint32_t delay = _next.delay < KbdMacro::MAX_DELAY_MS ? _next.delay : KbdMacro::MAX_DELAY_MS;
+        _due += delay * 1000u;
+    }
+
+    _sink->schedule(_due);
+}
+
+bool KbdMacroPlayer::inject(uint8_t key, uint8_t state, uint32_t now) {
+    if (_sink->inject(key, state, now) == false) {
+        return false;
+    }
+
+    const uint32_t bit = 1u << key;
+    _down = state == EKLS_RISE ? (_down | bit) : (_down & ~bit);
+    return true;
+}
+
+bool KbdMacroPlayer::release(uint32_t now) {
+    for(uint32_t bits = _down; bits; bits &= bits - 1) {
+        if (inject(uint8_t(__builtin_ctz(bits)), EKLS_FALL, now) == false) {
+            return false;
+        }
+    }
+
+    return true;
+}
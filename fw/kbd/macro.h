@@ -0,0 +1,161 @@
+#ifndef __KBD_MACRO_H__
+#define __KBD_MACRO_H__
+
+#include <stdint.h>
+#include "keys.h"
+#include "../board/config.h"
+
+/**
+ * macro playback modes.
+ */
+enum EKbdMacroMode {
+    EKMM_ORIGINAL = 0,  // --> recorded delays.
+    EKMM_FAST,          // --> a step per HID polling interval.
+    EKMM_MAX_VALUE
+};
+
+/**
+ * macro states.
+ */
+enum EKbdMacroState {
+    EKMS_IDLE = 0,
+    EKMS_RECORDING,
+    EKMS_PLAYING,
+    EKMS_STOPPING       // --> releasing keys the macro left pressed.
+};
+
+/**
+ * a macro step: the key edge after `delay` ms from the previous step.
+ */
+struct SMacroStep {
+    uint32_t delay;
+    uint8_t key;
+    uint8_t state;      // --> EKLS_RISE or EKLS_FALL.
+};
+
+/**
+ * macro buffer.
+ * each step is one varint of `delay << 6 | key << 1 | rise`, so a step
+ * within 2 ms is a byte and within a quarter second is two.
+ * longer pauses are clamped to `MAX_DELAY_MS` when appended.
+ */
+class KbdMacro {
+public:
+    static constexpr uint32_t MAX_BYTES = 1024;
+    static constexpr uint32_t MAX_DELAY_MS = 0xffff;
+    static constexpr uint32_t MAX_STEP_BYTES = 4;   // --> 22 bits: 16-bit delay + 6.
+
+private:
+    uint8_t _bytes[MAX_BYTES];
+    uint32_t _size;
+    uint32_t _steps;
+
+public:
+    KbdMacro() : _size(0), _steps(0) { }
+
+public:
+    /* clear all steps. */
+    void clear() { _size = _steps = 0; }
+
+    /* append a step, returns false if full. */
+    bool append(const SMacroStep& step);
+
+    /* decode the step at the offset, returns the next offset or zero at the end. */
+    uint32_t decode(uint32_t offset, SMacroStep& out) const;
+
+public:
+    /* get the encoded size in bytes. */
+    uint32_t size() const { return _size; }
+
+    /* get the count of steps. */
+    uint32_t getSteps() const { return _steps; }
+
+    /* test whether no step exists or not. */
+    bool isEmpty() const { return _size == 0; }
+
+    /* get the encoded bytes. */
+    const uint8_t* getBytes() const { return _bytes; }
+};
+
+/**
+ * clock of macro playback.
+ */
+class IKbdMacroClock {
+public:
+    virtual ~IKbdMacroClock() { }
+
+public:
+    /* get the current time (us, lower 32 bits). */
+    virtual uint32_t getTime() const = 0;
+};
+
+/**
+ * output of macro playback.
+ */
+class IKbdMacroSink {
+public:
+    virtual ~IKbdMacroSink() { }
+
+public:
+    /* press or release the key at `now` (us), returns false if no room. */
+    virtual bool inject(uint8_t key, uint8_t state, uint32_t now) = 0;
+
+    /* request the next `onTick` at `us`. */
+    virtual void schedule(uint32_t us) = 0;
+};
+
+/**
+ * macro playback scheduler.
+ * steps go out through the sink on the given clock, from the previous due
+ * time so recorded delays don't drift. keys it pressed are released
+ * before it stops, retried until the sink takes them all.
+ */
+class KbdMacroPlayer {
+public:
+    static constexpr uint32_t FAST_STEP_US = USBD_HID_POLL_MS * 1000;
+
+private:
+    const KbdMacro* _macro;
+    const IKbdMacroClock* _clock;
+    IKbdMacroSink* _sink;
+
+    uint32_t _offset;   // --> offset of the next step.
+    uint32_t _due;      // --> us of the next step.
+    uint32_t _down;     // --> keys pressed by the macro.
+
+    SMacroStep _next;
+    uint8_t _state;
+    uint8_t _mode;
+
+public:
+    KbdMacroPlayer(const KbdMacro* macro, const IKbdMacroClock* clock, IKbdMacroSink* sink);
+
+public:
+    /* start playing the macro. */
+    bool play(EKbdMacroMode mode);
+
+    /* stop playing, keys pressed by the macro are released first. */
+    void stop();
+
+    /* play the steps due at `now` (us). */
+    void onTick(uint32_t now);
+
+public:
+    /* get the current state: idle, playing or stopping. */
+    EKbdMacroState getState() const { return EKbdMacroState(_state); }
+
+    /* get the mode of the last playback. */
+    EKbdMacroMode getMode() const { return EKbdMacroMode(_mode); }
+
+    /* get the keys pressed by the macro, bit N: EKey(N). */
+    uint32_t getDownKeys() const { return _down; }
+
+private:
+    /* inject the key edge, returns false if no room. */
+    bool inject(uint8_t key, uint8_t state, uint32_t now);
+
+    /* release keys pressed by the macro, returns false if any is left. */
+    bool release(uint32_t now);
+};
+
+#endif
@@ -0,0 +1,88 @@
+#include "pacer.h"
+#include "kbd.h"
+#include "scanners/basic.h"
+
+KbdScanPacer::KbdScanPacer() {
+    _period = DEFAULT_PERIOD_US;
+    _running = 0;
+    _parked = 0;
+
+#if KBD_USE_PIO_SCANNER
+    _governor = nullptr;
+#else
+    // --> the basic scanner skips the ticks its governor isn't due for.
+    _governor = KbdBasicScanner::instance()->getGovernor();
+#endif
+}
+
+KbdScanPacer* KbdScanPacer::get() {
+    static KbdScanPacer _pacer;
+    return &_pacer;
+}
+
+bool KbdScanPacer::start(uint32_t period) {
+    if (_governor) {
+        period = _governor->getPeriod();
+    }
+
+    if (_running || period == 0) {
+        return false;
+    }
+
+    _period = period;
+    _parked = 0;
+    _jitter.restart(period);
+
+    // --> negative: re-armed from the previous target, not from the end.
+    if (add_repeating_timer_us(-int64_t(period), onAlarm, this, &_timer) == false) {
+        return false;
+    }
+
+    _running = 1;
+    return true;
+}
+
+void KbdScanPacer::stop() {
+    if (_running) {
+        cancel_repeating_timer(&_timer);
+    }
+
+    _running = 0;
+    _parked = 0;
+}
+
+void KbdScanPacer::stepOnce() {
+    if (_parked == 0) {
+        return;
+    }
+
+    // --> a column rose: scan again from the next period.
+    if (Kbd::get()->getIdle()->getState() != EKIS_ARMED) {
+        start(_period);
+    }
+}
+
+bool KbdScanPacer::onAlarm(repeating_timer_t* timer) {
+    KbdScanPacer* pacer = (KbdScanPacer*) timer->user_data;
+    Kbd* kbd = Kbd::get();
+
+    pacer->_jitter.onTick(time_us_32());
+    kbd->scanOnce();
+
+    // --> rows are held for the wake: park so the core can sleep.
+    if (kbd->getIdle()->getState() == EKIS_ARMED) {
+        pacer->_running = 0;
+        pacer->_parked = 1;
+        return false;
+    }
+
+    // --> the governor changed the rate: the next target is a new period away.
+    if (pacer->_governor && pacer->_governor->getPeriod() != pacer->_period) {
+        pacer->_period = pacer->_governor->getPeriod();
+        pacer->_jitter.restart(pacer->_period);
+
+        timer->delay_us = -int64_t(pacer->_period);
+    }
+
+    return true;
+}
@@ -0,0 +1,77 @@
+#ifndef __KBD_PACER_H__
+#define __KBD_PACER_H__
+
+#include <stdint.h>
+#include "pico/stdlib.h"
+#include "jitter.h"
+#include "governor.h"
+#include "../board/config.h"
+
+/**
+ * timer-paced scanning.
+ * a repeating hardware alarm runs `Kbd::scanOnce` at the period of the
+ * scan governor, or a fixed one without it, so the scan cadence no longer
+ * depends on the rest of the main loop.
+ * the main loop only dispatches the events the alarm pushed.
+ */
+class KbdScanPacer {
+public:
+    /**
+     * interrupt budget per tick, from the row settle delays:
+     * PIO: reads the last DMA sample, a few us: ~4% at 125 us.
+     * basic: 5 rows x 2 x 10 us busy-wait, ~100 us: ~10% at 1 ms.
+     */
+#if KBD_USE_PIO_SCANNER
+    static constexpr uint32_t DEFAULT_PERIOD_US = KbdScanGovernor::DEFAULT_FAST_US;
+#else
+    static constexpr uint32_t DEFAULT_PERIOD_US = KbdScanGovernor::DEFAULT_SLOW_US;
+#endif
+
+private:
+    repeating_timer_t _timer;
+    KbdJitter _jitter;
+    KbdScanGovernor* _governor;
+    uint32_t _period;
+
+    volatile uint8_t _running;
+    volatile uint8_t _parked;   // --> stopped while the scanner is idle.
+
+private:
+    KbdScanPacer();
+
+public:
+    /* get the singleton instance. */
+    static KbdScanPacer* get();
+
+public:
+    /* start scanning on the alarm of the calling core, at the governor's period if set. */
+    bool start(uint32_t period = DEFAULT_PERIOD_US);
+
+    /* stop scanning. */
+    void stop();
+
+    /* resume the alarm once the idle scanner woke, called from the main loop. */
+    void stepOnce();
+
+public:
+    /* test whether the alarm is running or not. */
+    bool isRunning() const { return _running != 0; }
+
+    /* get the scan period in microseconds. */
+    uint32_t getPeriod() const { return _period; }
+
+    /* follow the governor's period from the next tick, nullptr for a fixed period. */
+    void setGovernor(KbdScanGovernor* governor) { _governor = governor; }
+
+    /* get the governor the period follows. */
+    KbdScanGovernor* getGovernor() const { return _governor; }
+
+    /* get the jitter monitor. */
+    KbdJitter* getJitter() { return &_jitter; }
+
+private:
+    /* called from the alarm interrupt. */
+    static bool onAlarm(repeating_timer_t* timer);
+};
+
+#endif
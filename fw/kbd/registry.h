@@ -0,0 +1,139 @@
+#ifndef __KBD_REGISTRY_H__
+#define __KBD_REGISTRY_H__
+
+#include <stdint.h>
+
+/**
+ * fixed-capacity registry of scanners, handlers and listeners.
+ * items can be pushed or removed while dispatching: removed items are left
+ * as holes until the outermost dispatch ends, and items pushed meanwhile
+ * are not visited by dispatches already running. no allocation happens.
+ */
+template<typename T, uint32_t N>
+class KbdRegistry {
+public:
+    static constexpr uint32_t MAX_ITEMS = N;
+    static_assert(N > 0 && N < 256, "N must fit in uint8_t.");
+
+private:
+    T* _items[N];
+    uint8_t _count;     // --> slots in use, including holes.
+    uint8_t _holes;     // --> items removed while dispatching.
+    uint8_t _depth;     // --> nested dispatches.
+
+public:
+    KbdRegistry() : _count(0), _holes(0), _depth(0) { }
+
+public:
+    /* get the count of registered items. */
+    uint32_t size() const { return _count - _holes; }
+
+    /* test whether the item is registered or not. */
+    bool contains(const T* item) const {
+        for(uint32_t i = 0; i < _count; ++i) {
+            if (item && _items[i] == item) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    /* push an item, returns false if full. */
+    bool push(T* item) {
+        if (item == nullptr || _count >= N) {
+            return false;
+        }
+
+        _items[_count++] = item;
+        return true;
+    }
+
+    /* remove the last occurrence of the item, or the last item if null. */
+    bool remove(T* item) {
+        for(uint32_t i = _count; i > 0; --i) {
+            T* other = _items[i - 1];
+
+            if (other == nullptr || (item && other != item)) {
+                continue;
+            }
+
+            if (_depth) {
+                // --> dispatching: keep indices stable.
+                _items[i - 1] = nullptr;
+                _holes++;
+            }
+
+            else {
+                erase(i - 1);
+            }
+
+            return true;
+        }
+
+        return false;
+    }
+
+    /* invoke `fn` in pushed order until it returns true. */
+    template<typename F>
+    bool forEach(F fn) {
+        const uint32_t count = _count;
+        bool stopped = false;
+
+        _depth++;
+        for(uint32_t i = 0; i < count && !stopped; ++i) {
+            if (T* item = _items[i]) {
+                stopped = fn(item);
+            }
+        }
+
+        leave();
+        return stopped;
+    }
+
+    /* invoke `fn` in reverse pushed order until it returns true. */
+    template<typename F>
+    bool forEachReverse(F fn) {
+        const uint32_t count = _count;
+        bool stopped = false;
+
+        _depth++;
+        for(uint32_t i = count; i > 0 && !stopped; --i) {
+            if (T* item = _items[i - 1]) {
+                stopped = fn(item);
+            }
+        }
+
+        leave();
+        return stopped;
+    }
+
+private:
+    /* erase the slot, keeping order. */
+    void erase(uint32_t index) {
+        for(uint32_t i = index + 1; i < _count; ++i) {
+            _items[i - 1] = _items[i];
+        }
+
+        _count--;
+    }
+
+    /* end a dispatch, then fill holes if it was the outermost one. */
+    void leave() {
+        if (--_depth || _holes == 0) {
+            return;
+        }
+
+        uint32_t count = 0;
+        for(uint32_t i = 0; i < _count; ++i) {
+            if (_items[i]) {
+                _items[count++] = _items[i];
+            }
+        }
+
+        _count = uint8_t(count);
+        _holes = 0;
+    }
+};
+
+#endif
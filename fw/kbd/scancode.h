@@ -40,6 +40,7 @@ void kbd_set_scancodes();
 
 // -- key codes.
 #define  KC_INV                0xFF     // --> pseudo code to indicate error.
+#define  KC_TRNS               0xFE     // --> pseudo code: falls through to lower layers.
 #define  KC_NONE               0x00
 #define  KC_A                  0x04
 #define  KC_B                  0x05
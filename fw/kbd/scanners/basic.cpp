@@ -1,4 +1,5 @@
 #include "basic.h"
+#include "../trace.h"
 #include "../../board/config.h"
 #include "pico/stdlib.h"
 #include "hardware/gpio.h"
@@ -16,9 +17,8 @@ const uint8_t KbdBasicScanner::COL_PINS[5] = {
 
 KbdBasicScanner::KbdBasicScanner() {
     _empty = 1;
-
-    memset(_prevRows, 0, sizeof(_prevRows));
-    memset(_nextRows, 0, sizeof(_nextRows));
+    _prev = _next = 0;
+    _sampled = 0;
 
     for(uint8_t row = 0; row < MAX_ROWS; ++row) {
         const uint8_t pin = ROW_PINS[row];
@@ -42,26 +42,42 @@ KbdBasicScanner *KbdBasicScanner::instance() {
 }
 
 bool KbdBasicScanner::scanOnce() {
-    // --> store previous states.
-    memcpy(_prevRows, _nextRows, sizeof(_nextRows));
-    memset(_nextRows, 0, sizeof(_nextRows));
+    const uint32_t now = time_us_32();
+    if (_governor.isDue(now) == false) {
+        return false;
+    }
+
+    uint8_t rows[MAX_ROWS];
+    memset(rows, 0, sizeof(rows));
+
+    _sampled = now;
     
     // --> scan keys and fill its state to bitmap.
     for (uint8_t row = 0; row < MAX_ROWS; ++row) {
         gpio_put(ROW_PINS[row], 1);
-        sleep_us(GPIO_DELAY);
+        busy_wait_us_32(GPIO_DELAY);
 
         for(uint8_t col = 0; col < MAX_COLS; ++col) {
             if (gpio_get(COL_PINS[col])) {
-                _nextRows[row] |= (1 << col);
+                rows[row] |= (1 << col);
             }
         }
 
         gpio_put(ROW_PINS[row], 0);
-        sleep_us(GPIO_DELAY);
+        busy_wait_us_32(GPIO_DELAY);
     }
 
-    _empty = memcmp(_prevRows, _nextRows, sizeof(_nextRows)) == 0;
+    // --> store previous states.
+    _prev = _next;
+    _next = KbdMatrix::pack(rows);
+
+    _empty = KbdMatrix::changes(_prev, _next) == 0;
+
+    // --> capture raw changes while a trace is being recorded.
+    KbdTraceRecorder::get()->record(now, _next);
+
+    // --> held or changed keys keep the fast rate.
+    _governor.onScan(now, _next != 0 || !_empty);
     return true;
 }
 
@@ -69,15 +85,26 @@ bool KbdBasicScanner::isEmpty() const {
     return _empty != 0;
 }
 
-bool KbdBasicScanner::takeState(EKey key, bool& nextOut) const {
-    if (key == EKEY_INV || key == EKEY_HIDDEN || key >= EKEY_MAX) {
-        nextOut = false;
-        return false;
+bool KbdBasicScanner::enterIdle() {
+    uint32_t mask = 0;
+    for(uint8_t row = 0; row < MAX_ROWS; ++row) {
+        mask |= 1u << ROW_PINS[row];
     }
-    
-    const uint8_t row = key / MAX_COLS;
-    const uint8_t col = key % MAX_COLS;
-    
-    nextOut = (_nextRows[row] & (1 << col)) != 0;
+
+    // --> any key pressed raises its column now.
+    gpio_put_masked(mask, mask);
+
+    // --> may run from the pacer alarm: never sleep here.
+    busy_wait_us_32(GPIO_DELAY);
     return true;
 }
+
+void KbdBasicScanner::leaveIdle() {
+    uint32_t mask = 0;
+    for(uint8_t row = 0; row < MAX_ROWS; ++row) {
+        mask |= 1u << ROW_PINS[row];
+    }
+
+    gpio_put_masked(mask, 0);
+    busy_wait_us_32(GPIO_DELAY);
+}
\ No newline at end of file
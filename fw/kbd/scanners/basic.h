@@ -2,6 +2,8 @@
 #define __KBD_SCANNER_BASIC_H__
 
 #include "../kbd.h"
+#include "matrix.h"
+#include "../governor.h"
 
 /**
  * Basic key scanner.
@@ -9,19 +11,23 @@
 class KbdBasicScanner : public IKeyScanner {
 private:
     static constexpr uint8_t GPIO_DELAY = 10;
-    static constexpr uint32_t MAX_ROWS = 5;
-    static constexpr uint32_t MAX_COLS = 5;
+    static constexpr uint32_t MAX_ROWS = KbdMatrix::MAX_ROWS;
+    static constexpr uint32_t MAX_COLS = KbdMatrix::MAX_COLS;
 
 private:
     static const uint8_t ROW_PINS[5];
     static const uint8_t COL_PINS[5];
 
 private:
-    /* key state bitmap. */
-    uint8_t _prevRows[MAX_ROWS];
-    uint8_t _nextRows[MAX_ROWS];
+    /* key state bitmap, bit N: EKey(N). */
+    uint32_t _prev;
+    uint32_t _next;
+    uint32_t _sampled;
     uint8_t _empty;
 
+    /* adaptive scan rate. */
+    KbdScanGovernor _governor;
+
 private:
     KbdBasicScanner();
 
@@ -30,14 +36,30 @@ public:
     static KbdBasicScanner* instance();
 
 public:
-    /* scan once. */
+    /* get the scan-rate governor to configure or observe. */
+    KbdScanGovernor* getGovernor() { return &_governor; }
+
+public:
+    /* scan once, returns false if the governor skipped it. interrupt safe. */
     virtual bool scanOnce();
 
     /* test whether no scanning result changes or not. */
     virtual bool isEmpty() const;
 
-    /* take the latest scanned state and return true if key presents. */
-    virtual bool takeState(EKey key, bool& nextOut) const;
+    /* get the latest scanned key bitmap, bit N: EKey(N). */
+    virtual uint32_t getKeys() const { return _next; }
+
+    /* get the keys this scanner presents. */
+    virtual uint32_t getMask() const { return KbdMatrix::KEY_MASK; }
+
+    /* get the time of the latest GPIO sample. */
+    virtual uint32_t getSampleTime() const { return _sampled; }
+
+    /* hold all rows high for the column wake. */
+    virtual bool enterIdle();
+
+    /* restore rows for scanning. */
+    virtual void leaveIdle();
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,32 @@
+#include "matrix.h"
+
+/* reverse the lower 5 bits: sampled pin order to column order. */
+static const uint8_t MATRIX_REVERSE[32] = {
+    0x00, 0x10, 0x08, 0x18, 0x04, 0x14, 0x0c, 0x1c,
+    0x02, 0x12, 0x0a, 0x1a, 0x06, 0x16, 0x0e, 0x1e,
+    0x01, 0x11, 0x09, 0x19, 0x05, 0x15, 0x0d, 0x1d,
+    0x03, 0x13, 0x0b, 0x1b, 0x07, 0x17, 0x0f, 0x1f
+};
+
+uint32_t KbdMatrix::pack(const uint8_t* rows) {
+    uint32_t bitmap = 0;
+
+    for(uint32_t row = 0; row < MAX_ROWS; ++row) {
+        bitmap |= uint32_t(rows[row] & ROW_MASK) << (row * MAX_COLS);
+    }
+
+    return bitmap & KEY_MASK;
+}
+
+uint32_t KbdMatrix::fromSample(uint32_t sample) {
+    uint32_t bitmap = 0;
+
+    for(uint32_t row = 0; row < MAX_ROWS; ++row) {
+        const uint32_t shift = (MAX_ROWS - 1 - row) * MAX_COLS;
+        const uint32_t bits = (sample >> shift) & ROW_MASK;
+
+        bitmap |= uint32_t(MATRIX_REVERSE[bits]) << (row * MAX_COLS);
+    }
+
+    return bitmap & KEY_MASK;
+}
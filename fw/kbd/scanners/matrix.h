@@ -0,0 +1,58 @@
+#ifndef __KBD_SCANNER_MATRIX_H__
+#define __KBD_SCANNER_MATRIX_H__
+
+#include <stdint.h>
+#include "../keys.h"
+
+/**
+ * Key matrix layout helpers shared by matrix scanners.
+ * the key bitmap has one bit per key: bit N is `EKey(N)`.
+ */
+class KbdMatrix {
+public:
+    static constexpr uint32_t MAX_ROWS = 5;
+    static constexpr uint32_t MAX_COLS = 5;
+    static constexpr uint32_t ROW_MASK = (1 << MAX_COLS) - 1;
+
+    /* keys wired to the matrix, the hidden position has no switch. */
+    static constexpr uint32_t KEY_MASK = ((1u << EKEY_MAX) - 1) & ~(1u << EKEY_HIDDEN);
+
+public:
+    /* get the row of the key. */
+    static uint8_t rowOf(EKey key) { return uint8_t(key / MAX_COLS); }
+
+    /* get the column of the key. */
+    static uint8_t colOf(EKey key) { return uint8_t(key % MAX_COLS); }
+
+    /* get the key at the row and column. */
+    static EKey keyOf(uint8_t row, uint8_t col) { 
+        return EKey(row * MAX_COLS + col); 
+    }
+
+    /* test whether the key is wired to the matrix or not. */
+    static bool isWired(EKey key) {
+        return key < EKEY_MAX && (KEY_MASK & (1u << key)) != 0;
+    }
+
+    /* test whether the key is set in the bitmap or not. */
+    static bool test(uint32_t bitmap, EKey key) {
+        return (bitmap & (1u << key)) != 0;
+    }
+
+    /* get the keys that changed between two bitmaps. */
+    static uint32_t changes(uint32_t prev, uint32_t next) {
+        return (prev ^ next) & KEY_MASK;
+    }
+
+    /* pack per-row column bitmaps (bit N: column N) into a key bitmap. */
+    static uint32_t pack(const uint8_t* rows);
+
+    /**
+     * unpack a PIO sample into a key bitmap.
+     * the sample holds 5 bits per row with row 0 at the top,
+     * and each row is sampled from `COL_5` (lowest GPIO) to `COL_1`.
+     */
+    static uint32_t fromSample(uint32_t sample);
+};
+
+#endif
@@ -0,0 +1,151 @@
+#include "pio.h"
+#include "../../board/config.h"
+#include "pico/stdlib.h"
+#include "hardware/gpio.h"
+#include "hardware/pio.h"
+#include "hardware/dma.h"
+#include "hardware/clocks.h"
+#include "kbd_matrix.pio.h"
+
+// --> the program drives rows and samples columns as consecutive pins.
+static_assert(GPIO_KBD_ROW_5 == GPIO_KBD_ROW_1 + 4, "rows must be consecutive.");
+static_assert(GPIO_KBD_COL_1 == GPIO_KBD_COL_5 + 4, "columns must be consecutive.");
+
+#define KBD_PIO pio0
+
+KbdPioScanner::KbdPioScanner() {
+    _sample = _raw = 0;
+    _prev = _next = 0;
+    _sampled = 0;
+    _empty = 1;
+
+    _matrixEnd = _matrixFrac = 0;
+    _left = 0;
+
+    const uint32_t offset = pio_add_program(KBD_PIO, &kbd_matrix_program);
+    _offset = uint8_t(offset);
+    _sm = uint8_t(pio_claim_unused_sm(KBD_PIO, true));
+    _dma = uint8_t(dma_claim_unused_channel(true));
+
+    for(uint32_t i = 0; i < KbdMatrix::MAX_ROWS; ++i) {
+        pio_gpio_init(KBD_PIO, GPIO_KBD_ROW_1 + i);
+    }
+
+    for(uint32_t i = 0; i < KbdMatrix::MAX_COLS; ++i) {
+        const uint32_t pin = GPIO_KBD_COL_5 + i;
+
+        gpio_init(pin);
+        gpio_set_dir(pin, GPIO_IN);
+        gpio_pull_down(pin);
+    }
+
+    pio_sm_set_consecutive_pindirs(KBD_PIO, _sm, GPIO_KBD_ROW_1, KbdMatrix::MAX_ROWS, true);
+    pio_sm_set_consecutive_pindirs(KBD_PIO, _sm, GPIO_KBD_COL_5, KbdMatrix::MAX_COLS, false);
+
+    pio_sm_config config = kbd_matrix_program_get_default_config(offset);
+    sm_config_set_set_pins(&config, GPIO_KBD_ROW_1, KbdMatrix::MAX_ROWS);
+    sm_config_set_in_pins(&config, GPIO_KBD_COL_5);
+
+    // --> shift left: row 0 ends up on the top, push per full matrix.
+    sm_config_set_in_shift(&config, false, true, SAMPLE_BITS);
+    sm_config_set_fifo_join(&config, PIO_FIFO_JOIN_RX);
+    sm_config_set_clkdiv(&config, float(clock_get_hz(clk_sys)) / SM_FREQ);
+
+    pio_sm_init(KBD_PIO, _sm, offset, &config);
+    start();
+}
+
+KbdPioScanner *KbdPioScanner::instance() {
+    static KbdPioScanner _scanner;
+    return &_scanner;
+}
+
+void KbdPioScanner::start() {
+    pio_sm_set_enabled(KBD_PIO, _sm, false);
+    pio_sm_clear_fifos(KBD_PIO, _sm);
+    pio_sm_restart(KBD_PIO, _sm);
+    pio_sm_exec(KBD_PIO, _sm, pio_encode_jmp(_offset));
+
+    arm();
+
+    // --> sample N is pushed at the end of matrix N, less the tail.
+    _left = dma_channel_hw_addr(_dma)->transfer_count;
+    _matrixEnd = time_us_32();
+    _matrixFrac = 0;
+
+    pio_sm_set_enabled(KBD_PIO, _sm, true);
+}
+
+void KbdPioScanner::arm() {
+    dma_channel_config config = dma_channel_get_default_config(_dma);
+
+    channel_config_set_transfer_data_size(&config, DMA_SIZE_32);
+    channel_config_set_read_increment(&config, false);
+    channel_config_set_write_increment(&config, false);
+    channel_config_set_dreq(&config, pio_get_dreq(KBD_PIO, _sm, false));
+
+    // --> overwrite the same word with every sample.
+    dma_channel_configure(
+        _dma, &config, &_sample, &KBD_PIO->rxf[_sm], 
+        0xffffffff, true);
+}
+
+void KbdPioScanner::advance(uint32_t left) {
+    const uint32_t cycles = (_left - left) * MATRIX_CYCLES + _matrixFrac;
+
+    _left = left;
+    _matrixEnd += cycles / SM_CYCLES_US;
+    _matrixFrac = cycles % SM_CYCLES_US;
+}
+
+bool KbdPioScanner::scanOnce() {
+    // --> about 16k samples per second: the count runs out after days.
+    //     the stalled state machine lost its phase, so restart it too.
+    if (dma_channel_is_busy(_dma) == false) {
+        start();
+    }
+
+    // --> the count and the word must belong to the same sample.
+    uint32_t left = dma_channel_hw_addr(_dma)->transfer_count;
+    uint32_t raw = 0;
+
+    while (true) {
+        raw = _sample;
+
+        const uint32_t again = dma_channel_hw_addr(_dma)->transfer_count;
+        if (again == left) {
+            break;
+        }
+
+        left = again;
+    }
+
+    // --> stamp the sample from the state machine clock, not the read.
+    advance(left);
+    _sampled = _matrixEnd - TAIL_CYCLES / SM_CYCLES_US;
+
+    _prev = _next;
+    _empty = raw == _raw;
+
+    if (_empty) {
+        return true;
+    }
+
+    _raw = raw;
+    _next = KbdMatrix::fromSample(raw);
+
+    _empty = KbdMatrix::changes(_prev, _next) == 0;
+    return true;
+}
+
+bool KbdPioScanner::isEmpty() const {
+    return _empty != 0;
+}
+
+bool KbdPioScanner::enterIdle() {
+    // --> the state machine keeps strobing: a held key pulses its column.
+    return true;
+}
+
+void KbdPioScanner::leaveIdle() {
+}
\ No newline at end of file
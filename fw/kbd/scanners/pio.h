@@ -0,0 +1,85 @@
+#ifndef __KBD_SCANNER_PIO_H__
+#define __KBD_SCANNER_PIO_H__
+
+#include "../kbd.h"
+#include "matrix.h"
+
+/**
+ * PIO key scanner.
+ * a PIO state machine strobes rows and samples columns continuously,
+ * and a DMA channel keeps the latest packed sample in memory.
+ * so, scanning is only a memory read and a compare.
+ */
+class KbdPioScanner : public IKeyScanner {
+private:
+    static constexpr uint32_t SM_FREQ = 2000000;
+    static constexpr uint32_t SM_CYCLES_US = SM_FREQ / 1000000;
+    static constexpr uint32_t SAMPLE_BITS = KbdMatrix::MAX_ROWS * KbdMatrix::MAX_COLS;
+
+    /* state machine cycles per matrix, and after the push of its sample. */
+    static constexpr uint32_t MATRIX_CYCLES = KbdMatrix::MAX_ROWS * 21 + 20;
+    static constexpr uint32_t TAIL_CYCLES = 20;
+
+    static_assert(SM_FREQ % 1000000 == 0, "the SM clock must be whole MHz.");
+
+private:
+    /* latest sample, written by DMA. */
+    volatile uint32_t _sample;
+    uint32_t _raw;
+
+    /* key state bitmap, bit N: EKey(N). */
+    uint32_t _prev;
+    uint32_t _next;
+    uint32_t _sampled;
+    uint8_t _empty;
+
+    /* end of the latest matrix period the DMA copied, and its cycle remainder. */
+    uint32_t _matrixEnd;
+    uint32_t _matrixFrac;
+    uint32_t _left;
+
+    /* state machine, its program and DMA channel. */
+    uint8_t _sm, _dma;
+    uint8_t _offset;
+
+private:
+    KbdPioScanner();
+
+public:
+    /* get the singleton instance. */
+    static KbdPioScanner* instance();
+
+private:
+    /* restart the state machine and the DMA channel, from a known time. */
+    void start();
+
+    /* arm the DMA channel to copy samples endlessly. */
+    void arm();
+
+    /* advance `_matrixEnd` by the samples the DMA copied since the last call. */
+    void advance(uint32_t left);
+
+public:
+    /* scan once. */
+    virtual bool scanOnce();
+
+    /* test whether no scanning result changes or not. */
+    virtual bool isEmpty() const;
+
+    /* get the latest scanned key bitmap, bit N: EKey(N). */
+    virtual uint32_t getKeys() const { return _next; }
+
+    /* get the keys this scanner presents. */
+    virtual uint32_t getMask() const { return KbdMatrix::KEY_MASK; }
+
+    /* get the time the latest sample was pushed, the last row's read. */
+    virtual uint32_t getSampleTime() const { return _sampled; }
+
+    /* hold all rows high for the column wake. */
+    virtual bool enterIdle();
+
+    /* restore rows for scanning. */
+    virtual void leaveIdle();
+};
+
+#endif
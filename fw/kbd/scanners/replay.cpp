@@ -0,0 +1,143 @@
+#include "replay.h"
+#include "pico/stdlib.h"
+#include <string.h>
+
+KbdReplayScanner::KbdReplayScanner() {
+    _records = nullptr;
+    _count = _index = 0;
+    _start = _due = 0;
+    _clock = _tail = 0;
+
+    _prev = _next = 0;
+    _sampled = 0;
+    _empty = 1;
+
+    _playing = 0;
+    _stepped = 0;
+}
+
+KbdReplayScanner* KbdReplayScanner::instance() {
+    static KbdReplayScanner _scanner;
+    return &_scanner;
+}
+
+bool KbdReplayScanner::load(const uint8_t* data, uint32_t len) {
+    STraceHeader header;
+
+    if (data == nullptr || len < sizeof(header)) {
+        return false;
+    }
+
+    memcpy(&header, data, sizeof(header));
+
+    if (header.magic != STraceHeader::MAGIC ||
+        header.version != STraceHeader::VERSION)
+    {
+        return false;
+    }
+
+    // --> truncated trace.
+    if ((len - sizeof(header)) / sizeof(STraceRecord) < header.count) {
+        return false;
+    }
+
+    return load((const STraceRecord*)(data + sizeof(header)), header.count);
+}
+
+bool KbdReplayScanner::load(const STraceRecord* records, uint32_t count) {
+    if (_playing || (records == nullptr && count)) {
+        return false;
+    }
+
+    _records = (const uint8_t*) records;
+    _count = count;
+    _index = 0;
+    return true;
+}
+
+bool KbdReplayScanner::play(bool stepped) {
+    if (_playing || _count == 0) {
+        return false;
+    }
+
+    _index = 0;
+    _stepped = stepped ? 1 : 0;
+    _start = time_us_32();
+    _due = recordAt(0).dt;
+    _clock = 0;
+    _tail = stepped ? TAIL_US : 0;
+
+    _playing = 1;
+    return true;
+}
+
+void KbdReplayScanner::stop() {
+    _index = _count;
+    _tail = 0;
+}
+
+STraceRecord KbdReplayScanner::recordAt(uint32_t index) const {
+    STraceRecord rec;
+
+    // --> M0+ can't load unaligned words.
+    memcpy(&rec, _records + index * sizeof(STraceRecord), sizeof(rec));
+    return rec;
+}
+
+void KbdReplayScanner::advance() {
+    _next = recordAt(_index++).keys & KbdMatrix::KEY_MASK;
+    _sampled = _start + _due;
+
+    if (_index < _count) {
+        _due += recordAt(_index).dt;
+    }
+}
+
+bool KbdReplayScanner::scanOnce() {
+    if (_playing == 0) {
+        return false;
+    }
+
+    const uint32_t index = _index;
+    _prev = _next;
+
+    if (_stepped == 0) {
+        _clock = time_us_32() - _start;
+    }
+
+    // --> stepped: no waiting for records, a fixed pace after the trace.
+    else if (_index < _count) {
+        _clock = _due;
+    }
+
+    else {
+        _clock += TAIL_STEP_US;
+    }
+
+    while(_index < _count && _clock >= _due) {
+        advance();
+    }
+
+    // --> trace ended: release all keys, then stop presenting.
+    if (_index >= _count && _index == index) {
+        const uint32_t elapsed = _clock - _due;
+
+        if (_next == 0 && elapsed >= _tail * 2) {
+            _playing = 0;
+            _empty = 1;
+            return false;
+        }
+
+        if (elapsed >= _tail) {
+            _next = 0;
+            _sampled = _start + _clock;
+        }
+    }
+
+    _empty = KbdMatrix::changes(_prev, _next) == 0;
+    return true;
+}
+
+bool KbdReplayScanner::isEmpty() const {
+    return _empty != 0;
+}
@@ -0,0 +1,97 @@
+#ifndef __KBD_SCANNER_REPLAY_H__
+#define __KBD_SCANNER_REPLAY_H__
+
+#include "../kbd.h"
+#include "../trace.h"
+#include "matrix.h"
+
+/**
+ * trace replay scanner.
+ * plays a recorded matrix trace back instead of the real matrix.
+ * while playing, it presents all matrix keys and takes priority over
+ * scanners pushed before it. the trace is not copied: keep it alive.
+ * samples are stamped with their trace times, and `Kbd` runs on the
+ * replay clock while playing, so a stepped replay never depends on when
+ * scans actually happen.
+ */
+class KbdReplayScanner : public IKeyScanner {
+public:
+    static constexpr uint32_t TAIL_STEP_US = 1000;  // --> stepped: clock per scan after the trace.
+    static constexpr uint32_t TAIL_US = 50000;      // --> stepped: hold, then release, this long.
+
+private:
+    const uint8_t* _records;    // --> `STraceRecord`s, may be unaligned.
+    uint32_t _count;
+    uint32_t _index;
+
+    uint32_t _start;            // --> playback start, us.
+    uint32_t _due;              // --> offset of the next record, us.
+    uint32_t _clock;            // --> offset of the replay clock, us.
+    uint32_t _tail;             // --> hold and release time after the trace, us.
+
+    /* key state bitmap, bit N: EKey(N). */
+    uint32_t _prev;
+    uint32_t _next;
+    uint32_t _sampled;
+    uint8_t _empty;
+
+    volatile uint8_t _playing;
+    uint8_t _stepped;
+
+private:
+    KbdReplayScanner();
+
+public:
+    /* get the singleton instance. */
+    static KbdReplayScanner* instance();
+
+public:
+    /* load a trace in file format, returns false if invalid. */
+    bool load(const uint8_t* data, uint32_t len);
+
+    /* load trace records. */
+    bool load(const STraceRecord* records, uint32_t count);
+
+    /**
+     * start playing the loaded trace.
+     * stepped: the clock jumps to the next record on each scan, deterministic.
+     */
+    bool play(bool stepped = false);
+
+    /* stop playing, keys are released on the next scan. */
+    void stop();
+
+    /* test whether playing or not. */
+    bool isPlaying() const { return _playing != 0; }
+
+    /* get the replay clock (us, lower 32 bits), the trace time of the latest scan. */
+    uint32_t getClock() const { return _start + _clock; }
+
+public:
+    /* scan once, returns false if not playing. */
+    virtual bool scanOnce();
+
+    /* test whether no scanning result changes or not. */
+    virtual bool isEmpty() const;
+
+    /* get the latest replayed key bitmap. */
+    virtual uint32_t getKeys() const { return _next; }
+
+    /* get the keys this scanner presents: all matrix keys while playing. */
+    virtual uint32_t getMask() const { return KbdMatrix::KEY_MASK; }
+
+    /* get the trace time of the latest record applied. */
+    virtual uint32_t getSampleTime() const { return _sampled; }
+
+    /* nothing to hold while stopped, so never blocks the idle scan. */
+    virtual bool enterIdle() { return _playing == 0; }
+
+private:
+    /* read the record at the index. */
+    STraceRecord recordAt(uint32_t index) const;
+
+    /* apply the next record. */
+    void advance();
+};
+
+#endif
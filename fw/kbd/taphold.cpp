@@ -0,0 +1,164 @@
+#include "taphold.h"
+#include <string.h>
+
+KbdTapHold::KbdTapHold() {
+    memset(_configs, 0, sizeof(_configs));
+
+    _count = 0;
+    _pivot = -1;
+    _rule = EKHR_ON_PRESS;
+
+    _dualKeys = _heldKeys = 0;
+}
+
+bool KbdTapHold::setHold(EKey key, uint8_t mod, uint16_t term) {
+    if (key >= EKEY_MAX || key == EKEY_HIDDEN) {
+        return false;
+    }
+
+    _configs[key].mod = mod;
+    _configs[key].term = term;
+
+    if (term) {
+        _dualKeys |= 1u << key;
+    }
+
+    else {
+        _dualKeys &= ~(1u << key);
+    }
+
+    return true;
+}
+
+uint8_t KbdTapHold::getHoldMod(EKey key) const {
+    if (key >= EKEY_MAX) {
+        return 0;
+    }
+
+    return _configs[key].mod;
+}
+
+uint16_t KbdTapHold::getTerm(EKey key) const {
+    if (key >= EKEY_MAX) {
+        return 0;
+    }
+
+    return _configs[key].term;
+}
+
+bool KbdTapHold::setRule(EKeyHoldRule rule) {
+    if (rule >= EKHR_MAX_VALUE) {
+        return false;
+    }
+
+    _rule = rule;
+    return true;
+}
+
+bool KbdTapHold::push(const SKeyEvent& event) {
+    if (_count >= MAX_QUEUED) {
+        return false;
+    }
+
+    _queue[_count++] = event;
+
+    if (_pivot < 0) {
+        _pivot = findPivot(_count - 1);
+    }
+
+    resolve(0, false);
+    return true;
+}
+
+void KbdTapHold::poll(uint32_t now) {
+    if (_pivot >= 0) {
+        resolve(now, true);
+    }
+}
+
+bool KbdTapHold::pop(SKeyEvent* outEvent, uint32_t busy) {
+    // --> nothing passes the unresolved dual key.
+    if (_count == 0 || _pivot == 0) {
+        return false;
+    }
+
+    // --> one edge per key and dispatch: a tap must reach the host as two reports.
+    if (busy & (1u << _queue[0].key)) {
+        return false;
+    }
+
+    *outEvent = _queue[0];
+    memmove(_queue, _queue + 1, sizeof(SKeyEvent) * (--_count));
+
+    if (_pivot > 0) {
+        _pivot--;
+    }
+
+    return true;
+}
+
+void KbdTapHold::resolve(uint32_t now, bool timed) {
+    while(_pivot >= 0) {
+        const SKeyEvent& pivot = _queue[_pivot];
+        const uint32_t term = _configs[pivot.key].term * 1000u;
+
+        enum { UNRESOLVED = 0, TAP, HOLD } result = UNRESOLVED;
+
+        for(uint8_t i = _pivot + 1; i < _count && result == UNRESOLVED; ++i) {
+            const SKeyEvent& event = _queue[i];
+
+            if (event.us - pivot.us >= term) {
+                result = HOLD;
+            }
+
+            else if (event.key == pivot.key) {
+                result = TAP;
+            }
+
+            else if (event.state == EKLS_RISE) {
+                if (_rule == EKHR_ON_PRESS) {
+                    result = HOLD;
+                }
+            }
+
+            else if (_rule == EKHR_PERMISSIVE) {
+                // --> released, and also pressed after the dual key.
+                for(uint8_t j = _pivot + 1; j < i; ++j) {
+                    if (_queue[j].key == event.key) {
+                        result = HOLD;
+                        break;
+                    }
+                }
+            }
+        }
+
+        if (result == UNRESOLVED) {
+            // --> bounded: a full queue can't wait any longer.
+            if (_count >= MAX_QUEUED || (timed && now - pivot.us >= term)) {
+                result = HOLD;
+            }
+
+            else {
+                return;
+            }
+        }
+
+        if (result == HOLD) {
+            _heldKeys |= 1u << pivot.key;
+        }
+
+        _pivot = findPivot(_pivot + 1);
+    }
+}
+
+int8_t KbdTapHold::findPivot(uint8_t from) const {
+    for(uint8_t i = from; i < _count; ++i) {
+        const SKeyEvent& event = _queue[i];
+
+        if (event.state == EKLS_RISE && (_dualKeys & (1u << event.key))) {
+            return int8_t(i);
+        }
+    }
+
+    return -1;
+}
@@ -0,0 +1,107 @@
+#ifndef __KBD_TAPHOLD_H__
+#define __KBD_TAPHOLD_H__
+
+#include <stdint.h>
+#include "keys.h"
+#include "event.h"
+
+/**
+ * hold resolution rules.
+ */
+enum EKeyHoldRule {
+    EKHR_TIMEOUT = 0,   // --> only the hold term makes a hold.
+    EKHR_PERMISSIVE,    // --> another key pressed and released while held.
+    EKHR_ON_PRESS,      // --> another key pressed while held.
+    EKHR_MAX_VALUE
+};
+
+/**
+ * tap-hold resolver for dual-role keys.
+ * a dual key pressed alone is held back with every event after it until
+ * it resolves: released before the term, it taps its own key character;
+ * held past the term (or interrupted by the rule), it acts as the hold
+ * modifier and its layer action, if any. decisions use event times only,
+ * so traces replay identically.
+ */
+class KbdTapHold {
+public:
+    static constexpr uint32_t MAX_QUEUED = 16;
+    static constexpr uint16_t DEFAULT_TERM_MS = 200;
+
+private:
+    /* per-key hold action. */
+    struct SConfig {
+        uint16_t term;  // --> hold term, ms.
+        uint8_t mod;    // --> modifier while held.
+    };
+
+private:
+    SConfig _configs[EKEY_MAX];
+
+    /* events held back, oldest first. */
+    SKeyEvent _queue[MAX_QUEUED];
+    uint8_t _count;
+    int8_t _pivot;      // --> index of the unresolved dual key, -1: none.
+    uint8_t _rule;
+
+    uint32_t _dualKeys; // --> keys with a hold action.
+    uint32_t _heldKeys; // --> keys resolved as hold, until released.
+
+public:
+    KbdTapHold();
+
+public:
+    /* set the hold modifier and term of the key, zero term clears its dual role. */
+    bool setHold(EKey key, uint8_t mod, uint16_t term = DEFAULT_TERM_MS);
+
+    /* get the hold modifier of the key. */
+    uint8_t getHoldMod(EKey key) const;
+
+    /* get the hold term of the key, in milliseconds. */
+    uint16_t getTerm(EKey key) const;
+
+    /* set the rule for other keys pressed while a dual key is unresolved. */
+    bool setRule(EKeyHoldRule rule);
+
+    /* get the rule. */
+    EKeyHoldRule getRule() const { return EKeyHoldRule(_rule); }
+
+public:
+    /* test whether the event can skip the resolver, the fast path. */
+    bool isPassing(const SKeyEvent& event) const {
+        return _count == 0 && (event.state != EKLS_RISE || (_dualKeys & (1u << event.key)) == 0);
+    }
+
+    /* test whether any event is held back or not. */
+    bool isPending() const { return _count != 0; }
+
+    /* test whether no more event can be held back. */
+    bool isFull() const { return _count >= MAX_QUEUED; }
+
+    /* test whether the key has a dual role or not. */
+    bool isDual(EKey key) const { return (_dualKeys & (1u << key)) != 0; }
+
+    /* test whether the key acts as its hold modifier now. */
+    bool isHeld(EKey key) const { return (_heldKeys & (1u << key)) != 0; }
+
+    /* hold back an event, returns false if full. */
+    bool push(const SKeyEvent& event);
+
+    /* resolve the pending dual key against `now` (us). */
+    void poll(uint32_t now);
+
+    /* pop a resolved event, never a second one for the keys in `busy`. */
+    bool pop(SKeyEvent* outEvent, uint32_t busy);
+
+    /* forget the hold of the released key. */
+    void release(EKey key) { _heldKeys &= ~(1u << key); }
+
+private:
+    /* resolve from held back events, then move to the next dual key. */
+    void resolve(uint32_t now, bool timed);
+
+    /* find the next unresolved dual key from the index. */
+    int8_t findPivot(uint8_t from) const;
+};
+
+#endif
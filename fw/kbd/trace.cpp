@@ -0,0 +1,79 @@
+#include "trace.h"
+#include <string.h>
+
+KbdTraceRecorder::KbdTraceRecorder() {
+    _count = 0;
+    _last = 0;
+    _keys = 0;
+    _drops = 0;
+    _recording = 0;
+}
+
+KbdTraceRecorder* KbdTraceRecorder::get() {
+    static KbdTraceRecorder _recorder;
+    return &_recorder;
+}
+
+void KbdTraceRecorder::start(uint32_t now) {
+    _recording = 0;
+
+    _count = 0;
+    _last = now;
+    _drops = 0;
+
+    // --> the first scan always makes a record: the initial state.
+    _keys = 0xffffffff;
+    _recording = 1;
+}
+
+void KbdTraceRecorder::record(uint32_t now, uint32_t keys) {
+    if (_recording == 0 || keys == _keys) {
+        return;
+    }
+
+    if (_count >= MAX_RECORDS) {
+        _drops++;
+        return;
+    }
+
+    STraceRecord& rec = _records[_count++];
+    rec.dt = now - _last;
+    rec.keys = keys;
+
+    _last = now;
+    _keys = keys;
+}
+
+STraceHeader KbdTraceRecorder::getHeader() const {
+    STraceHeader header;
+
+    header.magic = STraceHeader::MAGIC;
+    header.version = STraceHeader::VERSION;
+    header.reserved = 0;
+    header.count = _count;
+
+    return header;
+}
+
+bool KbdTraceRecorder::getRecord(uint32_t index, STraceRecord& out) const {
+    if (index >= _count) {
+        return false;
+    }
+
+    out = _records[index];
+    return true;
+}
+
+uint32_t KbdTraceRecorder::serialize(uint8_t* buf, uint32_t len) const {
+    const STraceHeader header = getHeader();
+    const uint32_t total = sizeof(header) + _count * sizeof(STraceRecord);
+
+    if (buf == nullptr || len < total) {
+        return 0;
+    }
+
+    // --> the MCU is little endian, same as the file.
+    memcpy(buf, &header, sizeof(header));
+    memcpy(buf + sizeof(header), _records, _count * sizeof(STraceRecord));
+    return total;
+}
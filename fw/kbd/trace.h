@@ -0,0 +1,86 @@
+#ifndef __KBD_TRACE_H__
+#define __KBD_TRACE_H__
+
+#include <stdint.h>
+
+/**
+ * matrix trace file format, little endian:
+ * `STraceHeader` followed by `count` of `STraceRecord`.
+ */
+struct STraceHeader {
+    static constexpr uint32_t MAGIC = 0x4352544b;   // --> "KTRC".
+    static constexpr uint16_t VERSION = 1;
+
+    uint32_t magic;
+    uint16_t version;
+    uint16_t reserved;
+    uint32_t count;         // --> count of records.
+};
+
+/**
+ * a matrix change: the key bitmap after `dt` us from the previous record.
+ */
+struct STraceRecord {
+    uint32_t dt;            // --> the first record: from the start of the trace.
+    uint32_t keys;          // --> bit N: EKey(N).
+};
+
+static_assert(sizeof(STraceHeader) == 12, "trace header must be packed.");
+static_assert(sizeof(STraceRecord) == 8, "trace record must be packed.");
+
+/**
+ * records matrix changes from a scanner into a fixed buffer.
+ */
+class KbdTraceRecorder {
+public:
+    static constexpr uint32_t MAX_RECORDS = 512;
+
+private:
+    STraceRecord _records[MAX_RECORDS];
+    uint32_t _count;
+    uint32_t _last;
+    uint32_t _keys;
+    uint32_t _drops;
+    volatile uint8_t _recording;
+
+private:
+    KbdTraceRecorder();
+
+public:
+    /* get the singleton instance. */
+    static KbdTraceRecorder* get();
+
+public:
+    /* start recording from the empty trace at `now` (us). */
+    void start(uint32_t now);
+
+    /* stop recording. */
+    void stop() { _recording = 0; }
+
+    /* test whether recording or not. */
+    bool isRecording() const { return _recording != 0; }
+
+    /* record the key bitmap scanned at `now` (us), only changes are kept. */
+    void record(uint32_t now, uint32_t keys);
+
+public:
+    /* get the count of records. */
+    uint32_t size() const { return _count; }
+
+    /* get the count of changes lost because the buffer was full. */
+    uint32_t getDrops() const { return _drops; }
+
+    /* get the header for the recorded trace. */
+    STraceHeader getHeader() const;
+
+    /* get all records, valid while not recording. */
+    const STraceRecord* getRecords() const { return _records; }
+
+    /* get the record at the index. */
+    bool getRecord(uint32_t index, STraceRecord& out) const;
+
+    /* copy the trace in file format, returns the bytes written. */
+    uint32_t serialize(uint8_t* buf, uint32_t len) const;
+};
+
+#endif
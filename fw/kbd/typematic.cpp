@@ -0,0 +1,87 @@
+#include "typematic.h"
+
+KbdTypematic::KbdTypematic() {
+    _keys = DEFAULT_KEYS;
+    _armed = 0;
+    _active = 0;
+
+    for(uint8_t i = 0; i < EKEY_MAX; ++i) {
+        _due[i] = 0;
+    }
+
+    setTimingAll(DEFAULT_DELAY_MS, DEFAULT_PERIOD_MS);
+}
+
+void KbdTypematic::setActive(bool active) {
+    _active = active ? 1 : 0;
+
+    if (!active) {
+        _armed = 0;
+    }
+}
+
+bool KbdTypematic::setTiming(EKey key, uint16_t delay, uint16_t period) {
+    if (key >= EKEY_MAX || period == 0) {
+        return false;
+    }
+
+    _configs[key].delay = delay;
+    _configs[key].period = period;
+    return true;
+}
+
+void KbdTypematic::setTimingAll(uint16_t delay, uint16_t period) {
+    for(uint8_t i = 0; i < EKEY_MAX; ++i) {
+        setTiming(EKey(i), delay, period);
+    }
+}
+
+uint16_t KbdTypematic::getDelay(EKey key) const {
+    if (key >= EKEY_MAX) {
+        return 0;
+    }
+
+    return _configs[key].delay;
+}
+
+uint16_t KbdTypematic::getPeriod(EKey key) const {
+    if (key >= EKEY_MAX) {
+        return 0;
+    }
+
+    return _configs[key].period;
+}
+
+void KbdTypematic::arm(EKey key, uint32_t now) {
+    if (!_active || key >= EKEY_MAX || (_keys & (1u << key)) == 0) {
+        return;
+    }
+
+    _due[key] = now + _configs[key].delay * 1000u;
+    _armed |= 1u << key;
+}
+
+uint32_t KbdTypematic::poll(uint32_t now) {
+    uint32_t fired = 0;
+
+    for(uint32_t bits = _armed; bits; bits &= bits - 1) {
+        const uint32_t key = __builtin_ctz(bits);
+
+        // --> signed: deadlines wrap with the 32-bit clock.
+        if (int32_t(now - _due[key]) < 0) {
+            continue;
+        }
+
+        const uint32_t period = _configs[key].period * 1000u;
+        _due[key] += period;
+
+        // --> fell behind by more than a period: skip instead of bursting.
+        if (int32_t(now - _due[key]) >= 0) {
+            _due[key] = now + period;
+        }
+
+        fired |= 1u << key;
+    }
+
+    return fired;
+}
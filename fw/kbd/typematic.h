@@ -0,0 +1,84 @@
+#ifndef __KBD_TYPEMATIC_H__
+#define __KBD_TYPEMATIC_H__
+
+#include <stdint.h>
+#include "keys.h"
+
+/**
+ * typematic key repeat engine.
+ * held keys repeat after a per-key delay at a per-key rate. deadlines
+ * advance from the previous deadline, not from when they were polled,
+ * so the repeat rate stays exact regardless of main-loop load.
+ */
+class KbdTypematic {
+public:
+    static constexpr uint16_t DEFAULT_DELAY_MS = 500;
+    static constexpr uint16_t DEFAULT_PERIOD_MS = 33;    // --> about 30 per second.
+
+    /* keys allowed to repeat by default: digits, operators and enter. */
+    static constexpr uint32_t DEFAULT_KEYS =
+        (1u << EKEY_SLASH) | (1u << EKEY_ASTEROID) | (1u << EKEY_MINUS) |
+        (1u << EKEY_PLUS) | (1u << EKEY_ENTER) | (1u << EKEY_DOT) |
+        (1u << EKEY_NUM_0) | (1u << EKEY_NUM_1) | (1u << EKEY_NUM_2) |
+        (1u << EKEY_NUM_3) | (1u << EKEY_NUM_4) | (1u << EKEY_NUM_5) |
+        (1u << EKEY_NUM_6) | (1u << EKEY_NUM_7) | (1u << EKEY_NUM_8) |
+        (1u << EKEY_NUM_9);
+
+private:
+    /* per-key timing, milliseconds. */
+    struct SConfig {
+        uint16_t delay;
+        uint16_t period;
+    };
+
+private:
+    SConfig _configs[EKEY_MAX];
+    uint32_t _due[EKEY_MAX];    // --> next repeat, us.
+
+    uint32_t _keys;             // --> keys allowed to repeat.
+    uint32_t _armed;            // --> held keys waiting for repeats.
+    uint8_t _active;
+
+public:
+    KbdTypematic();
+
+public:
+    /* turn the engine on or off, off by default. */
+    void setActive(bool active);
+
+    /* test whether the engine is on or not. */
+    bool isActive() const { return _active != 0; }
+
+    /* set the keys allowed to repeat, bit N: EKey(N). */
+    void setKeys(uint32_t keys) { _keys = keys; _armed &= keys; }
+
+    /* get the keys allowed to repeat. */
+    uint32_t getKeys() const { return _keys; }
+
+    /* set the delay and the period of the key, in milliseconds. */
+    bool setTiming(EKey key, uint16_t delay, uint16_t period);
+
+    /* set the delay and the period of all keys, in milliseconds. */
+    void setTimingAll(uint16_t delay, uint16_t period);
+
+    /* get the delay of the key, in milliseconds. */
+    uint16_t getDelay(EKey key) const;
+
+    /* get the period of the key, in milliseconds. */
+    uint16_t getPeriod(EKey key) const;
+
+public:
+    /* start the delay of the key pressed at `now` (us). */
+    void arm(EKey key, uint32_t now);
+
+    /* stop repeating the key. */
+    void disarm(EKey key) { _armed &= ~(1u << key); }
+
+    /* test whether any key waits for repeats or not. */
+    bool isArmed() const { return _armed != 0; }
+
+    /* get keys to repeat at `now` (us). */
+    uint32_t poll(uint32_t now);
+};
+
+#endif
@@ -1,8 +1,11 @@
 #include "kbd/kbd.h"
+#include "kbd/pacer.h"
+#include "board/config.h"
 #include "tft/tft.h"
 #include "board/ledctl.h"
 #include "board/usbd.h"
 #include "task/taskqueue.h"
+#include "task/coro.h"
 #include "mode/mode.h"
 #include "pico/stdlib.h"
 #include <tusb.h>
@@ -12,6 +15,7 @@ int main(void) {
     TaskQueue::prepare();
 
     Kbd* kbd = Kbd::get();
+    kbd->listen(Coro::getKeyListener());
     tty_print("kbd: init.\n");
 
     Ledctl* led = Ledctl::get();
@@ -29,8 +33,22 @@ int main(void) {
 
     // --> try to enter default mode.
     IMode::trySetCurrent(nullptr);
+    TaskQueue* queue = TaskQueue::get();
+
+#if KBD_USE_SCAN_TIMER
+    KbdScanPacer* pacer = KbdScanPacer::get();
+    pacer->start();
+#endif
+
     while(true) {
-        kbd->scanOnce();
+#if KBD_USE_SCAN_TIMER
+        // --> the alarm scans: only resume it after an idle wake.
+        pacer->stepOnce();
+        const bool changed = kbd->dispatchOnce();
+#else
+        const bool scanned = kbd->scanOnce();
+        const bool changed = kbd->dispatchOnce() || scanned;
+#endif
         led->updateOnce();
         usbd->stepOnce();
         
@@ -38,5 +56,11 @@ int main(void) {
         if (IMode* mode = IMode::getCurrent()) {
             mode->stepOnce();
         }
+
+        // --> idle cycle: help core1 with shared tasks if enabled,
+        // or sleep until a key wakes the scanner.
+        if (!changed && !queue->stealOnce()) {
+            kbd->sleepOnce();
+        }
     }
 }
\ No newline at end of file
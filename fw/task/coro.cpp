@@ -0,0 +1,248 @@
+#include "coro.h"
+#include "taskqueue.h"
+
+/* get the key event. */
+static CoroEvent* coroGetKeyEvent() {
+    static CoroEvent _event;
+    return &_event;
+}
+
+/* get the USB mount event, unmounted until `Usbd` says. */
+static CoroEvent* coroGetMountEvent() {
+    static CoroEvent _event(0);
+    return &_event;
+}
+
+CoroArena::CoroArena() {
+    _free = nullptr;
+
+    for(uint32_t i = MAX_FRAMES; i > 0; --i) {
+        _frames[i - 1].next = _free;
+        _free = &_frames[i - 1];
+    }
+
+    critical_section_init(&_cs);
+}
+
+CoroArena* CoroArena::get() {
+    static CoroArena _arena;
+    return &_arena;
+}
+
+void* CoroArena::alloc(size_t size) {
+    if (size > FRAME_SIZE) {
+        return nullptr;
+    }
+
+    critical_section_enter_blocking(&_cs);
+
+    SFrame* frame = _free;
+    if (frame) {
+        _free = frame->next;
+    }
+
+    critical_section_exit(&_cs);
+    return frame;
+}
+
+void CoroArena::free(void* ptr) {
+    if (ptr == nullptr) {
+        return;
+    }
+
+    SFrame* frame = (SFrame*) ptr;
+    critical_section_enter_blocking(&_cs);
+
+    frame->next = _free;
+    _free = frame;
+
+    critical_section_exit(&_cs);
+}
+
+CoroEvent::CoroEvent()
+    : CoroEvent(NONE)
+{
+}
+
+CoroEvent::CoroEvent(uint32_t state)
+    : _state(state)
+{
+    for(uint32_t i = 0; i < MAX_WAITERS; ++i) {
+        _waiters[i].task = nullptr;
+        _waiters[i].value = nullptr;
+        _waiters[i].match = NONE;
+    }
+}
+
+ECoroWait CoroEvent::wait(Task* task, uint32_t* value, uint32_t match) {
+    volatile TaskGuard __GUARD__;
+
+    // --> `signal()` updates the state under the same guard: no lost signal.
+    if (_state != NONE && match != NONE && _state == match) {
+        *value = _state;
+        return ECORO_MATCHED;
+    }
+
+    for(uint32_t i = 0; i < MAX_WAITERS; ++i) {
+        if (_waiters[i].task == nullptr) {
+            _waiters[i].task = task;
+            _waiters[i].value = value;
+            _waiters[i].match = match;
+            return ECORO_SUSPEND;
+        }
+    }
+
+    return ECORO_FULL;
+}
+
+void CoroEvent::signal(uint32_t value) {
+    SWaiter waiters[MAX_WAITERS];
+
+    // --> take matching waiters, then resume outside of the guard.
+    {
+        volatile TaskGuard __GUARD__;
+
+        if (_state != NONE) {
+            _state = value;
+        }
+
+        for(uint32_t i = 0; i < MAX_WAITERS; ++i) {
+            waiters[i] = _waiters[i];
+
+            if (_waiters[i].match != NONE && _waiters[i].match != value) {
+                waiters[i].task = nullptr;
+                continue;
+            }
+
+            _waiters[i].task = nullptr;
+            _waiters[i].value = nullptr;
+            _waiters[i].match = NONE;
+        }
+    }
+
+    for(uint32_t i = 0; i < MAX_WAITERS; ++i) {
+        if (waiters[i].task == nullptr) {
+            continue;
+        }
+
+        *waiters[i].value = value;
+
+        // --> requeue even if the coroutine is still suspending.
+        if (waiters[i].task->reserve(true) == false) {
+            waiters[i].task->scheduleAfter(1);
+        }
+    }
+}
+
+void* Coro::promise_type::operator new(size_t size) noexcept {
+    return CoroArena::get()->alloc(size);
+}
+
+void Coro::promise_type::operator delete(void* ptr) noexcept {
+    CoroArena::get()->free(ptr);
+}
+
+bool Coro::SEventAwaiter::await_suspend(FHandle handle) {
+    switch (event->wait(handle.promise().task, &value, match)) {
+        case ECORO_SUSPEND:
+            return true;
+
+        case ECORO_MATCHED:
+            return false;
+
+        default:
+            break;
+    }
+
+    // --> too many waiters: resume immediately with `NONE`.
+    value = CoroEvent::NONE;
+    return false;
+}
+
+bool Coro::SSleepAwaiter::await_suspend(FHandle handle) {
+    return handle.promise().task->scheduleAfter(ms);
+}
+
+SCoroKey Coro::SKeyAwaiter::await_resume() const {
+    if (value == CoroEvent::NONE) {
+        return { EKEY_INV, EKLS_LOW };
+    }
+
+    return { EKey(value >> 8), EKeyState(value & 0xff) };
+}
+
+Coro::Coro(FHandle handle)
+    : _handle(handle)
+{
+    handle.promise().task = Task::create(onResume, handle.address());
+}
+
+Coro::~Coro() {
+    if (_handle) {
+        Task* task = _handle.promise().task;
+
+        // --> never spawned: release the frame here.
+        _handle.destroy();
+        task->drop();
+    }
+}
+
+bool Coro::spawn() {
+    if (_handle == nullptr) {
+        return false;
+    }
+
+    Task* task = _handle.promise().task;
+    if (task->reserve() == false) {
+        return false;
+    }
+
+    // --> the frame is owned by the task queue from now.
+    _handle = nullptr;
+    return true;
+}
+
+void Coro::setShared(bool value) {
+    if (_handle) {
+        _handle.promise().task->setShared(value);
+    }
+}
+
+Coro::SKeyAwaiter Coro::nextKey() {
+    SKeyAwaiter awaiter;
+
+    awaiter.event = coroGetKeyEvent();
+    awaiter.value = CoroEvent::NONE;
+    awaiter.ready = false;
+    awaiter.match = CoroEvent::NONE;
+
+    return awaiter;
+}
+
+Coro::SEventAwaiter Coro::mounted(bool value) {
+    const uint32_t state = value ? 1u : 0u;
+
+    // --> the state is tested by `CoroEvent::wait()`, under its guard.
+    return { coroGetMountEvent(), state, false, state };
+}
+
+void Coro::notifyKey(EKey key, EKeyState state) {
+    coroGetKeyEvent()->signal((uint32_t(key) << 8) | uint32_t(state));
+}
+
+void Coro::notifyMounted(bool value) {
+    coroGetMountEvent()->signal(value ? 1 : 0);
+}
+
+void Coro::onResume(const Task* task) {
+    FHandle handle = FHandle::from_address(task->getUser());
+    handle.resume();
+
+    if (handle.done()) {
+        Task* self = handle.promise().task;
+
+        // --> the executing task still holds the queue reference.
+        handle.destroy();
+        self->drop();
+    }
+}
@@ -0,0 +1,215 @@
+#ifndef __TASK_CORO_H__
+#define __TASK_CORO_H__
+
+#ifdef __INTELLISENSE__
+struct critical_section_t { };
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <coroutine>
+#include "task.h"
+#include "../kbd/keys.h"
+#include "pico/critical_section.h"
+
+// --> forward decls.
+class IKeyListener;
+
+/**
+ * fixed-size arena for coroutine frames.
+ */
+class CoroArena {
+public:
+    static constexpr uint32_t MAX_FRAMES = 8;
+    static constexpr uint32_t FRAME_SIZE = 512;
+
+private:
+    union alignas(8) SFrame {
+        SFrame* next;
+        uint8_t data[FRAME_SIZE];
+    };
+
+private:
+    SFrame _frames[MAX_FRAMES];
+    SFrame* _free;
+    critical_section_t _cs;
+
+private:
+    CoroArena();
+
+public:
+    /* get the singleton instance. */
+    static CoroArena* get();
+
+public:
+    /* allocate a frame, nullptr if exhausted or too large. */
+    void* alloc(size_t size);
+
+    /* release a frame. */
+    void free(void* ptr);
+};
+
+/**
+ * result of `CoroEvent::wait()`.
+ */
+enum ECoroWait {
+    ECORO_SUSPEND = 0,  // --> registered, resumed by `signal()`.
+    ECORO_MATCHED,      // --> the state already matches, never suspend.
+    ECORO_FULL          // --> too many waiters.
+};
+
+/**
+ * event that coroutines can wait for.
+ * `signal()` resumes the waiters that match the value, with the value.
+ * a level event also keeps the last value, so waiting on it never misses 
+ * a signal that raced with the waiter.
+ */
+class CoroEvent {
+public:
+    static constexpr uint32_t MAX_WAITERS = 4;
+    static constexpr uint32_t NONE = 0xffffffff;
+
+private:
+    struct SWaiter {
+        Task* task;
+        uint32_t* value;
+        uint32_t match;     // --> `NONE`: any value.
+    };
+
+private:
+    SWaiter _waiters[MAX_WAITERS];
+    uint32_t _state;        // --> `NONE`: edge event.
+
+public:
+    CoroEvent();
+
+    /* create a level event with the initial state. */
+    explicit CoroEvent(uint32_t state);
+
+public:
+    /**
+     * register the task to resume on the value `match`.
+     * a level event in the state `match` already returns `ECORO_MATCHED`.
+     */
+    ECoroWait wait(Task* task, uint32_t* value, uint32_t match = NONE);
+
+    /* resume the waiters that match the value, others keep waiting. */
+    void signal(uint32_t value);
+};
+
+/**
+ * key event that `Coro::nextKey()` results.
+ */
+struct SCoroKey {
+    EKey key;
+    EKeyState state;
+};
+
+/**
+ * coroutine task that runs on the core1 task queue.
+ * frames are allocated from `CoroArena`, never from heap.
+ */
+class Coro {
+public:
+    struct promise_type;
+    using FHandle = std::coroutine_handle<promise_type>;
+
+    /**
+     * coroutine promise. 
+     */
+    struct promise_type {
+        Task* task = nullptr;
+
+        static void* operator new(size_t size) noexcept;
+        static void operator delete(void* ptr) noexcept;
+
+        /* called if `CoroArena` is exhausted. */
+        static Coro get_return_object_on_allocation_failure() { return Coro(); }
+
+        Coro get_return_object() { return Coro(FHandle::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return { }; }
+        std::suspend_always final_suspend() noexcept { return { }; }
+        void return_void() { }
+        void unhandled_exception() { }
+    };
+
+    /**
+     * awaiter for `CoroEvent`. 
+     */
+    struct SEventAwaiter {
+        CoroEvent* event;
+        uint32_t value;
+        bool ready;
+        uint32_t match;     // --> `CoroEvent::NONE`: any value.
+
+        bool await_ready() const { return ready; }
+        bool await_suspend(FHandle handle);
+        uint32_t await_resume() const { return value; }
+    };
+
+    /**
+     * awaiter for `sleepFor(ms)`. 
+     */
+    struct SSleepAwaiter {
+        uint32_t ms;
+
+        bool await_ready() const { return false; }
+        bool await_suspend(FHandle handle);
+        void await_resume() const { }
+    };
+
+    /**
+     * awaiter for `nextKey()`. 
+     */
+    struct SKeyAwaiter : SEventAwaiter {
+        SCoroKey await_resume() const;
+    };
+
+private:
+    FHandle _handle;
+
+private:
+    Coro() : _handle(nullptr) { }
+    Coro(FHandle handle);
+
+public:
+    Coro(Coro&& other) : _handle(other._handle) { other._handle = nullptr; }
+    Coro(const Coro&) = delete;
+    ~Coro();
+
+public:
+    /* test whether the frame is allocated or not. */
+    bool isValid() const { return _handle != nullptr; }
+
+    /* start the coroutine on core1, the frame is freed when it ends. */
+    bool spawn();
+
+    /* mark the coroutine core-agnostic, see `Task::setShared()`. */
+    void setShared(bool value);
+
+public:
+    /* suspend for `ms` milliseconds. */
+    static SSleepAwaiter sleepFor(uint32_t ms) { return { ms }; }
+
+    /* suspend until the next key event. */
+    static SKeyAwaiter nextKey();
+
+    /* suspend until the USB device becomes mounted or unmounted. */
+    static SEventAwaiter mounted(bool value);
+
+public:
+    /* get the key listener to feed `nextKey()`, register it on `Kbd`. */
+    static IKeyListener* getKeyListener();
+
+    /* notify a key event, called by the key listener. */
+    static void notifyKey(EKey key, EKeyState state);
+
+    /* notify USB mount state, called by `Usbd::setMounted`. */
+    static void notifyMounted(bool value);
+
+private:
+    /* task callback that resumes the coroutine. */
+    static void onResume(const Task* task);
+};
+
+#endif
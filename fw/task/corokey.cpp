@@ -0,0 +1,24 @@
+#include "coro.h"
+#include "../kbd/kbd.h"
+
+/**
+ * key listener that signals `Coro::nextKey()` waiters.
+ */
+class CoroKeyListener : public IKeyListener {
+public:
+    /* get the singleton instance. */
+    static CoroKeyListener* instance() {
+        static CoroKeyListener _listener;
+        return &_listener;
+    }
+
+public:
+    /* called when key state updated. */
+    virtual void onKeyNotify(const Kbd* kbd, EKey key, EKeyState state) override {
+        Coro::notifyKey(key, state);
+    }
+};
+
+IKeyListener* Coro::getKeyListener() {
+    return CoroKeyListener::instance();
+}
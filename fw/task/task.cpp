@@ -1,7 +1,11 @@
 #include "task.h"
 #include "taskqueue.h"
+#include "taskpool.h"
+#include "tasklink.h"
+#include "taskstats.h"
 #include "pico/stdlib.h"
 #include "pico/multicore.h"
+#include <new>
 
 Task::Task()
     : Task(nullptr, nullptr)
@@ -11,19 +15,60 @@ Task::Task()
 Task::Task(task_cb_t cb)
     : _state(ETASK_NONE), _cb(cb), 
       _user(nullptr), _result(nullptr),
-      _refs(1)
+      _refs(1), _priority(ETASK_PRIO_NORMAL), _shared(0),
+      _tslot(nullptr), _tprev(nullptr), _tnext(nullptr),
+      _deadline(0), _period(0),
+      _then(nullptr), _waits(0)
 {
 }
 
 Task::Task(task_cb_t cb, void* user)
     : _state(ETASK_NONE), _cb(cb), 
       _user(user), _result(nullptr),
-      _refs(1)
+      _refs(1), _priority(ETASK_PRIO_NORMAL), _shared(0),
+      _tslot(nullptr), _tprev(nullptr), _tnext(nullptr),
+      _deadline(0), _period(0),
+      _then(nullptr), _waits(0)
 {
 }
 
-Task* Task::create(task_cb_t cb, void* user) {
-    return new Task(cb, user);
+Task* Task::create(task_cb_t cb, void* user, ETaskPriority priority) {
+    TaskPool* pool = TaskPool::get();
+    Task* task = nullptr;
+
+    if (void* slot = pool->alloc()) {
+        task = new (slot) Task(cb, user);
+    }
+
+    else {
+        // --> pool exhausted: fallback to heap.
+        pool->markFallback();
+        task = new Task(cb, user);
+    }
+
+    task->setPriority(priority);
+    return task;
+}
+
+void Task::destroy(Task* task) {
+    TaskPool* pool = TaskPool::get();
+    TaskLinkPool* links = TaskLinkPool::get();
+
+    // --> never done: release continuations without firing.
+    while (STaskLink* link = task->_then) {
+        task->_then = link->next;
+
+        link->task->drop();
+        links->free(link);
+    }
+
+    if (pool->owns(task)) {
+        task->~Task();
+        pool->free(task);
+        return;
+    }
+
+    delete task;
 }
 
 Task* Task::createSpawn(task_cb_t cb, void* user) {
@@ -63,11 +108,16 @@ void Task::onExecute() {
         }
         
         if (_cb) {
+            const uint32_t begin = time_us_32();
             _cb(this);
+
+            TaskStats::get()->onExecute(time_us_32() - begin);
         }
 
         bool again = false;
-        while (trySetState(ETASK_DONE, ETASK_EXECUTE) == false) {
+        bool done = false;
+
+        while ((done = trySetState(ETASK_DONE, ETASK_EXECUTE)) == false) {
             if (trySetState(ETASK_QUEUED, ETASK_RESERVED)) {
                 again = true;
                 break;
@@ -87,47 +137,197 @@ void Task::onExecute() {
             continue;
         }
 
+        if (done) {
+            complete();
+        }
+
         break;
     }
 
     drop();
 }
 
+bool Task::chain(STaskLink* link) {
+    uint32_t irq = lock();
+
+    // --> already done: fire the continuation directly.
+    if (getState() == ETASK_DONE) {
+        unlock(irq);
+
+        link->task->onAntecedentDone(this);
+        return false;
+    }
+
+    link->next = _then;
+    _then = link;
+
+    unlock(irq);
+    return true;
+}
+
+void Task::onAntecedentDone(const Task* antecedent) {
+    uint32_t irq = lock();
+
+    if (antecedent) {
+        _result = antecedent->_result;
+    }
+
+    const int32_t waits = --_waits;
+    unlock(irq);
+
+    if (waits != 0) {
+        return;
+    }
+
+    // --> queue full: retry by the timer wheel.
+    if (reserve() == false) {
+        scheduleAfter(1);
+    }
+}
+
+void Task::complete() {
+    TaskLinkPool* links = TaskLinkPool::get();
+    uint32_t irq = lock();
+
+    STaskLink* link = _then;
+    _then = nullptr;
+
+    unlock(irq);
+
+    while (link) {
+        STaskLink* next = link->next;
+
+        link->task->onAntecedentDone(this);
+        link->task->drop();
+
+        links->free(link);
+        link = next;
+    }
+
+    // --> wake waiters up.
+    TaskQueue::wakeup();
+}
+
+Task* Task::then(task_cb_t cb, void* user) {
+    Task* self = this;
+    return whenAll(&self, 1, cb, user, getPriority());
+}
+
+bool Task::wait(uint32_t ms) {
+    const absolute_time_t until = make_timeout_time_ms(ms);
+
+    while (getState() != ETASK_DONE) {
+        // --> woken up by `complete()`, or timed out.
+        if (best_effort_wfe_or_timeout(until)) {
+            return getState() == ETASK_DONE;
+        }
+    }
+
+    return true;
+}
+
+Task* Task::whenAll(Task* const* tasks, uint32_t count, 
+    task_cb_t cb, void* user, ETaskPriority priority)
+{
+    TaskLinkPool* links = TaskLinkPool::get();
+    STaskLink* pending[TaskLinkPool::MAX_LINKS];
+
+    if (count > TaskLinkPool::MAX_LINKS) {
+        return nullptr;
+    }
+
+    Task* join = create(cb, user, priority);
+
+    // --> allocate all links first, so no partial chain is left.
+    for(uint32_t i = 0; i < count; ++i) {
+        if ((pending[i] = links->alloc(join)) == nullptr) {
+            while (i > 0) {
+                links->free(pending[--i]);
+            }
+
+            join->drop();
+            return nullptr;
+        }
+    }
+
+    // --> +1: guard until all links are chained.
+    join->_waits = count + 1;
+
+    for(uint32_t i = 0; i < count; ++i) {
+        join->grab(); // --> each link holds a reference.
+
+        if (tasks[i]->chain(pending[i]) == false) {
+            join->drop();
+            links->free(pending[i]);
+        }
+    }
+
+    join->onAntecedentDone(nullptr);
+    return join;
+}
+
+uint32_t Task::lock() const {
+    return spin_lock_blocking(TaskQueue::get()->lockOf(this));
+}
+
+void Task::unlock(uint32_t irq) const {
+    spin_unlock(TaskQueue::get()->lockOf(this), irq);
+}
+
 void Task::grab() {
-    ENTER_CRITICAL_SECTION();
-    
-    _refs++;
+    const uint32_t irq = lock();
+
+    // --> no LDREX/STREX on M0+: increment under the striped lock.
+    _refs.store(_refs.load(std::memory_order_relaxed) + 1, 
+        std::memory_order_release);
 
-    LEAVE_CRITICAL_SECTION();
+    unlock(irq);
 }
 
 bool Task::drop() {
-    ENTER_CRITICAL_SECTION();
+    const uint32_t irq = lock();
 
-    if ((--_refs) == 0) {
-       LEAVE_CRITICAL_SECTION();
+    const int32_t refs = _refs.load(std::memory_order_relaxed) - 1;
+    _refs.store(refs, std::memory_order_release);
 
-        delete this;
+    unlock(irq);
+
+    if (refs == 0) {
+        destroy(this);
         return true;
     }
 
-    LEAVE_CRITICAL_SECTION();
     return false;
 }
 
+void Task::setPriority(ETaskPriority priority) {
+    if (priority >= ETASK_PRIO_MAX) {
+        priority = ETASK_PRIO_BACKGROUND;
+    }
+
+    _priority = priority;
+}
+
 ETaskState Task::getState() const {
-    volatile TaskGuard __GUARD__;
-    return _state;
+    return ETaskState(_state.load(std::memory_order_acquire));
 }
 
 bool Task::trySetState(ETaskState state, ETaskState expected) {
-    volatile TaskGuard __GUARD__;
-    if (_state != expected) {
+    // --> fast path: mismatch can be rejected without locking.
+    if (_state.load(std::memory_order_acquire) != expected) {
         return false;
     }
 
-    _state = state;
-    return true;
+    // --> all writers take the striped lock, so this is compare-exchange.
+    const uint32_t irq = lock();
+    const bool matched = _state.load(std::memory_order_relaxed) == expected;
+
+    if (matched) {
+        _state.store(state, std::memory_order_release);
+    }
+
+    unlock(irq);
+    return matched;
 }
 
 bool Task::reserve(bool requeue) {
@@ -142,8 +342,9 @@ bool Task::reserve(bool requeue) {
             return true;
         }
 
-        if (trySetState(ETASK_DONE, ETASK_NONE)) {
-            return reserve();
+        // --> done: rewind to none and reserve again.
+        if (trySetState(ETASK_NONE, ETASK_DONE)) {
+            return reserve(requeue);
         }
 
         return false;
@@ -160,4 +361,25 @@ bool Task::reserve(bool requeue) {
     }
     
     return true;
+}
+
+bool Task::scheduleAfter(uint32_t ms) {
+    return TaskQueue::get()->schedule(this, ms, 0);
+}
+
+bool Task::scheduleEvery(uint32_t ms) {
+    if (ms == 0) {
+        return false;
+    }
+
+    return TaskQueue::get()->schedule(this, ms, ms);
+}
+
+bool Task::cancel() {
+    return TaskQueue::get()->cancel(this);
+}
+
+bool Task::isScheduled() const {
+    volatile TaskGuard __GUARD__;
+    return _tslot != nullptr;
 }
\ No newline at end of file
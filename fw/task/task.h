@@ -2,10 +2,13 @@
 #define __TASK_TASK_H__
 
 #include <stdint.h>
+#include <atomic>
 
 // --> forward decl.
 class Task;
 class TaskQueue;
+class TaskTimer;
+struct STaskLink;
 
 // --> task callback.
 typedef void(* task_cb_t)(const Task*);
@@ -21,31 +24,74 @@ enum ETaskState {
     ETASK_DONE
 };
 
+/**
+ * task priority.
+ */
+enum ETaskPriority {
+    ETASK_PRIO_REALTIME = 0,    // --> input-driven, runs between redraw chunks.
+    ETASK_PRIO_NORMAL,
+    ETASK_PRIO_BACKGROUND,      // --> runs only if nothing else to do.
+    ETASK_PRIO_MAX
+};
+
 /**
  * task object. 
  */
 class Task {
 public:
     friend class TaskQueue;
+    friend class TaskTimer;
     static constexpr uint32_t MAX_QUEUED = 32;
 
 private:
-    ETaskState _state;
+    std::atomic<uint8_t> _state;
     task_cb_t _cb;
 
     void* _user;
     void* _result;
 
-    int32_t _refs;
+    std::atomic<int32_t> _refs;
+    uint8_t _priority;
+    uint8_t _shared;
+
+    /* timer wheel link, armed if `_tslot` is not null. */
+    Task** _tslot;
+    Task* _tprev;
+    Task* _tnext;
+    uint32_t _deadline;
+    uint32_t _period;
+
+    /* continuations and count of antecedents not done yet. */
+    STaskLink* _then;
+    int32_t _waits;
 
 private:
     Task(); // --> default ctor.
     Task(task_cb_t cb);
     Task(task_cb_t cb, void* user);
 
+    /* take the striped lock of this task, returns saved IRQ state. */
+    uint32_t lock() const;
+
+    /* release the striped lock of this task. */
+    void unlock(uint32_t irq) const;
+
+    /* release the task to the pool or heap. */
+    static void destroy(Task* task);
+
+    /* chain the continuation that waits this task. */
+    bool chain(STaskLink* link);
+
+    /* called when an antecedent reached `ETASK_DONE`. */
+    void onAntecedentDone(const Task* antecedent);
+
+    /* fire all continuations, called after reaching `ETASK_DONE`. */
+    void complete();
+
 public:
-    /* create a task. */
-    static Task* create(task_cb_t cb, void* user);
+    /* create a task, from the task pool if available. */
+    static Task* create(task_cb_t cb, void* user, 
+        ETaskPriority priority = ETASK_PRIO_NORMAL);
 
     /* create a task and spawn it. */
     static Task* createSpawn(task_cb_t cb, void* user);
@@ -78,6 +124,22 @@ public:
     /* get the state of task. */
     ETaskState getState() const;
 
+    /* get the priority of task. */
+    ETaskPriority getPriority() const { return ETaskPriority(_priority); }
+
+    /* set the priority of task, applied from the next queueing. */
+    void setPriority(ETaskPriority priority);
+
+    /* test whether the task can run on any core or not. */
+    bool isShared() const { return _shared != 0; }
+
+    /**
+     * mark the task core-agnostic, applied from the next queueing.
+     * shared tasks run as background work, and core0 may steal them.
+     * so never mark tasks that touch the TFT or core1-only states.
+     */
+    void setShared(bool value) { _shared = value ? 1 : 0; }
+
 private:
     void setState(ETaskState state) {
         while(trySetState(state) == false);
@@ -111,6 +173,40 @@ public:
      */
     bool reserve(bool requeue);
 
+public:
+    /* schedule to reserve the task after `ms` milliseconds. */
+    bool scheduleAfter(uint32_t ms);
+
+    /* schedule to reserve the task every `ms` milliseconds. */
+    bool scheduleEvery(uint32_t ms);
+
+    /* cancel the schedule, returns false if not scheduled. */
+    bool cancel();
+
+    /* test whether the task is scheduled or not. */
+    bool isScheduled() const;
+
+public:
+    /**
+     * create a continuation that is reserved when this task is done.
+     * the continuation receives this task's result as its initial result.
+     * returns nullptr if no continuation link is available.
+     */
+    Task* then(task_cb_t cb, void* user);
+
+    /**
+     * wait until the task is done, returns false on timeout.
+     * never call this from core1, it runs the task itself.
+     */
+    bool wait(uint32_t ms);
+
+    /**
+     * create a task that is reserved when all tasks are done.
+     * returns nullptr if no continuation link is available.
+     */
+    static Task* whenAll(Task* const* tasks, uint32_t count, 
+        task_cb_t cb, void* user, ETaskPriority priority = ETASK_PRIO_NORMAL);
+
 };
 
 #endif
\ No newline at end of file
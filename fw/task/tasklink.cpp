@@ -0,0 +1,50 @@
+#include "tasklink.h"
+
+TaskLinkPool::TaskLinkPool() {
+    _free = nullptr;
+
+    for(uint32_t i = MAX_LINKS; i > 0; --i) {
+        _links[i - 1].task = nullptr;
+        _links[i - 1].next = _free;
+        _free = &_links[i - 1];
+    }
+
+    critical_section_init(&_cs);
+}
+
+TaskLinkPool* TaskLinkPool::get() {
+    static TaskLinkPool _pool;
+    return &_pool;
+}
+
+STaskLink* TaskLinkPool::alloc(Task* task) {
+    critical_section_enter_blocking(&_cs);
+
+    STaskLink* link = _free;
+    if (link) {
+        _free = link->next;
+    }
+
+    critical_section_exit(&_cs);
+
+    if (link) {
+        link->task = task;
+        link->next = nullptr;
+    }
+
+    return link;
+}
+
+void TaskLinkPool::free(STaskLink* link) {
+    if (link == nullptr) {
+        return;
+    }
+
+    link->task = nullptr;
+    critical_section_enter_blocking(&_cs);
+
+    link->next = _free;
+    _free = link;
+
+    critical_section_exit(&_cs);
+}
@@ -0,0 +1,49 @@
+#ifndef __TASK_TASKLINK_H__
+#define __TASK_TASKLINK_H__
+
+#ifdef __INTELLISENSE__
+struct critical_section_t { };
+#endif
+
+#include <stdint.h>
+#include "pico/critical_section.h"
+
+// --> forward decls.
+class Task;
+
+/**
+ * continuation link, an edge from a task to its continuation.
+ */
+struct STaskLink {
+    Task* task;
+    STaskLink* next;
+};
+
+/**
+ * fixed-size continuation link pool.
+ */
+class TaskLinkPool {
+public:
+    static constexpr uint32_t MAX_LINKS = 64;
+
+private:
+    STaskLink _links[MAX_LINKS];
+    STaskLink* _free;
+    critical_section_t _cs;
+
+private:
+    TaskLinkPool();
+
+public:
+    /* get the singleton instance. */
+    static TaskLinkPool* get();
+
+public:
+    /* allocate a link, nullptr if exhausted. */
+    STaskLink* alloc(Task* task);
+
+    /* release the link. */
+    void free(STaskLink* link);
+};
+
+#endif
@@ -0,0 +1,54 @@
+#include "taskpool.h"
+
+TaskPool::TaskPool() {
+    _free = nullptr;
+    _used = 0;
+    _fallbacks = 0;
+
+    // --> link all slots, first slot at the head.
+    for(uint32_t i = MAX_TASKS; i > 0; --i) {
+        _slots[i - 1].next = _free;
+        _free = &_slots[i - 1];
+    }
+
+    critical_section_init(&_cs);
+}
+
+TaskPool* TaskPool::get() {
+    static TaskPool _pool;
+    return &_pool;
+}
+
+void* TaskPool::alloc() {
+    critical_section_enter_blocking(&_cs);
+
+    SSlot* slot = _free;
+    if (slot) {
+        _free = slot->next;
+        _used++;
+    }
+
+    critical_section_exit(&_cs);
+    return slot;
+}
+
+void TaskPool::free(void* ptr) {
+    if (!owns(ptr)) {
+        return;
+    }
+
+    SSlot* slot = (SSlot*) ptr;
+    critical_section_enter_blocking(&_cs);
+
+    slot->next = _free;
+    _free = slot;
+    _used--;
+
+    critical_section_exit(&_cs);
+}
+
+void TaskPool::markFallback() {
+    critical_section_enter_blocking(&_cs);
+    _fallbacks++;
+    critical_section_exit(&_cs);
+}
@@ -0,0 +1,66 @@
+#ifndef __TASK_TASKPOOL_H__
+#define __TASK_TASKPOOL_H__
+
+#ifdef __INTELLISENSE__
+struct critical_section_t { };
+#endif
+
+#include <stdint.h>
+#include "task.h"
+#include "pico/critical_section.h"
+
+/**
+ * fixed-size task object pool.
+ * slots are linked through an intrusive free list, so alloc/free are O(1).
+ */
+class TaskPool {
+public:
+    static constexpr uint32_t MAX_TASKS = 64;
+    static constexpr uint32_t ALIGN = 32;
+
+private:
+    /* a slot: free list link while free, task storage while used. */
+    union alignas(ALIGN) SSlot {
+        SSlot* next;
+        uint8_t data[sizeof(Task)];
+    };
+
+private:
+    SSlot _slots[MAX_TASKS];
+    SSlot* _free;
+    uint32_t _used;
+    uint32_t _fallbacks;
+    critical_section_t _cs;
+
+private:
+    TaskPool();
+
+public:
+    /* get the singleton instance. */
+    static TaskPool* get();
+
+public:
+    /* allocate storage for a task, nullptr if exhausted. */
+    void* alloc();
+
+    /* release storage that allocated by `alloc()`. */
+    void free(void* ptr);
+
+    /* test whether the pointer is a slot of this pool or not. */
+    bool owns(const void* ptr) const {
+        const uint8_t* addr = (const uint8_t*) ptr;
+        return addr >= (const uint8_t*) &_slots[0] &&
+               addr < (const uint8_t*) &_slots[MAX_TASKS];
+    }
+
+    /* get the count of slots in use. */
+    uint32_t getUsed() const { return _used; }
+
+    /* get the count of heap fallbacks due to exhaustion. */
+    uint32_t getFallbacks() const { return _fallbacks; }
+
+    /* count a heap fallback, called by `Task::create`. */
+    void markFallback();
+};
+
+#endif
@@ -1,14 +1,26 @@
 #include "taskqueue.h"
 #include "pico/multicore.h"
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include "taskstats.h"
 #include "../tft/tft.h"
 
-#define critical_section_yield() sleep_us(5)
+/* get the current milliseconds since boot. */
+static uint32_t taskGetMillis() {
+    return to_ms_since_boot(get_absolute_time());
+}
 
 TaskQueue::TaskQueue() {
-    _rpos = _wpos = 0;
-    _size = 0;
-
+    _timer.sync(taskGetMillis());
     critical_section_init(&_cs);
+
+    // --> dedicated locks: never shared with SDK critical sections.
+    for(uint32_t i = 0; i < MAX_LOCKS; ++i) {
+        _locks[i] = spin_lock_instance(spin_lock_claim_unused(true));
+    }
+
+    _stealLock = spin_lock_instance(spin_lock_claim_unused(true));
+    _sharing = 0;
 }
 
 TaskQueue* TaskQueue::get() {
@@ -23,6 +35,12 @@ void TaskQueue::prepare() {
     multicore_fifo_pop_blocking();
 }
 
+void TaskQueue::wakeup() {
+    // --> make prior writes visible before the event.
+    __dmb();
+    __sev();
+}
+
 void TaskQueue::enter_cs() {
     critical_section_enter_blocking(&_cs);
 }
@@ -31,61 +49,252 @@ void TaskQueue::leave_cs() {
     critical_section_exit(&_cs);
 }
 
+uint32_t TaskQueue::stripeOf(const Task* task) {
+    const uint32_t addr = uint32_t(uintptr_t(task));
+
+    // --> the low bits are alignment: pool slots are `TaskPool::ALIGN` apart or more.
+    //     a multiplicative hash spreads them, and multiplies are cheap on M0+.
+    return uint32_t((addr / uint32_t(sizeof(void*))) * 2654435761u) >> (32 - LOCK_BITS);
+}
+
+spin_lock_t* TaskQueue::lockOf(const Task* task) const {
+    return _locks[stripeOf(task)];
+}
+
 bool TaskQueue::enqueue(Task* task) {
-    bool result = false;
+    TaskRing* rings = task->_shared ? _shared : _pending[task->_priority];
+    TaskRing& ring = rings[get_core_num()];
 
+    // --> each core is the only producer of its own ring.
+    if (ring.push(task)) {
+        TaskStats::get()->onEnqueue(ring.size());
+        wakeup();
+        return true;
+    }
+
+    TaskStats::get()->onEnqueueFail();
+    return false;
+}
+
+bool TaskQueue::schedule(Task* task, uint32_t ms, uint32_t period) {
+    const uint32_t now = taskGetMillis();
     enter_cs();
-    if (_size < Task::MAX_QUEUED) {
-        _pending[_wpos++] = task;
-        _size++;
 
-        result = true;
+    if (task->_tslot) {
+        _timer.remove(task);
     }
 
+    else {
+        task->grab(); // --> the wheel holds a reference while armed.
+    }
+
+    task->_period = period;
+
+    _timer.sync(now);
+    _timer.insert(task, now + ms);
     leave_cs();
-    critical_section_yield();
 
-    return result;
+    // --> let core1 recalculate its sleep.
+    wakeup();
+    return true;
+}
+
+bool TaskQueue::cancel(Task* task) {
+    enter_cs();
+
+    const bool armed = task->_tslot != nullptr;
+    if (armed) {
+        _timer.remove(task);
+    }
+
+    leave_cs();
+
+    if (armed) {
+        task->drop();
+    }
+
+    return armed;
+}
+
+void TaskQueue::fireTimers() {
+    const uint32_t now = taskGetMillis();
+
+    while(true) {
+        enter_cs();
+
+        Task* task = _timer.expire(now);
+        if (task == nullptr) {
+            leave_cs();
+            break;
+        }
+
+        const uint32_t period = task->_period;
+        if (period) {
+            // --> re-arm from the deadline, not from now, to avoid drift.
+            uint32_t deadline = task->_deadline + period;
+
+            // --> fell behind by a whole period: skip instead of bursting.
+            if (int32_t(now - deadline) >= 0) {
+                deadline = now + period;
+            }
+
+            _timer.insert(task, deadline);
+            task->grab(); // --> hold while firing.
+        }
+
+        leave_cs();
+
+        if (task->reserve(true) == false && period == 0) {
+            enter_cs();
+
+            // --> queue full: retry on the next tick unless re-armed.
+            if (task->_tslot == nullptr) {
+                _timer.insert(task, now + 1);
+                task = nullptr;
+            }
+
+            leave_cs();
+        }
+
+        if (task) {
+            task->drop();
+        }
+    }
+}
+
+int32_t TaskQueue::nextTimeout() {
+    enter_cs();
+    const int32_t timeout = _timer.nextTimeout();
+    leave_cs();
+
+    return timeout;
 }
 
 void TaskQueue::taskRun() {
     TaskQueue* queue = get();
+    Tft* tft = Tft::get();
 
     multicore_fifo_push_blocking(0);
-    Task* taskPtr = nullptr;
 
     // --> run the loop.
     while(true) {
-        Tft::get()->redraw();
+        queue->fireTimers();
+
+        // --> realtime tasks never wait for more than a chunk of work.
+        while(queue->runOnce(ETASK_PRIO_REALTIME));
+
+        // --> interleave redraw chunks and normal tasks.
+        const uint32_t begin = time_us_32();
+        const bool drawn = tft->redraw();
+
+        if (drawn) {
+            TaskStats::get()->onRedraw(time_us_32() - begin);
+        }
+
+        const bool ran = queue->runOnce(ETASK_PRIO_NORMAL);
+
+        if (drawn || ran || queue->runOnce(ETASK_PRIO_BACKGROUND) || 
+            queue->runShared()) 
+        {
+            continue;
+        }
+
+        // --> sleep until the doorbell rings.
+        // a SEV between the test and WFE is latched, so it can't be lost.
+        if (queue->isEmpty() && !tft->isDirty()) {
+            const int32_t timeout = queue->nextTimeout();
 
-        while(queue->dequeue(&taskPtr)) {
-            if (taskPtr) {
-                taskPtr->onExecute();
+            if (timeout < 0) {
+                __wfe();
             }
+
+            else if (timeout > 0) {
+                best_effort_wfe_or_timeout(make_timeout_time_ms(timeout));
+            }
+        }
+    }
+}
+
+bool TaskQueue::dequeue(ETaskPriority priority, Task** outTask) {
+    TaskRing* rings = _pending[priority];
+
+    // --> core0 first: tasks spawned from key handlers.
+    for(uint32_t core = 0; core < MAX_CORES; ++core) {
+        if (rings[core].pop(outTask)) {
+            return true;
         }
+    }
+
+    return false;
+}
+
+bool TaskQueue::runOnce(ETaskPriority priority) {
+    Task* task = nullptr;
+
+    if (dequeue(priority, &task) == false) {
+        return false;
+    }
 
-        // --> sleep to yield priority to other core.
-        sleep_ms(1);
+    if (task) {
+        task->onExecute();
     }
+
+    return true;
 }
 
-bool TaskQueue::dequeue(Task** outTask) {
+bool TaskQueue::dequeueShared(Task** outTask) {
     bool result = false;
-    
-    enter_cs();
-    if (_size > 0) {
-        Task* task = _pending[_rpos++];
-        _size--;
 
-        if (outTask) {
-            *outTask = task;
+    // --> rings are single-consumer: serialize both cores.
+    const uint32_t irq = spin_lock_blocking(_stealLock);
+
+    for(uint32_t core = 0; core < MAX_CORES; ++core) {
+        if (_shared[core].pop(outTask)) {
+            result = true;
+            break;
         }
+    }
 
-        result = true;
+    spin_unlock(_stealLock, irq);
+    return result;
+}
+
+bool TaskQueue::runShared() {
+    Task* task = nullptr;
+
+    if (dequeueShared(&task) == false) {
+        return false;
     }
 
-    leave_cs();
-    critical_section_yield();
+    if (task) {
+        task->onExecute();
+    }
 
-    return result;
+    return true;
+}
+
+bool TaskQueue::stealOnce() {
+    if (_sharing == 0) {
+        return false;
+    }
+
+    return runShared();
+}
+
+bool TaskQueue::isEmpty() const {
+    for(uint32_t core = 0; core < MAX_CORES; ++core) {
+        if (!_shared[core].isEmpty()) {
+            return false;
+        }
+    }
+
+    for(uint32_t prio = 0; prio < ETASK_PRIO_MAX; ++prio) {
+        for(uint32_t core = 0; core < MAX_CORES; ++core) {
+            if (!_pending[prio][core].isEmpty()) {
+                return false;
+            }
+        }
+    }
+
+    return true;
 }
\ No newline at end of file
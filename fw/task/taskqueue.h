@@ -6,7 +6,10 @@ struct critical_section_t { };
 #endif
 
 #include "task.h"
+#include "taskring.h"
+#include "tasktimer.h"
 #include "pico/critical_section.h"
+#include "hardware/sync.h"
 
 class TaskGuard;
 
@@ -17,11 +20,25 @@ class TaskQueue {
     friend class Task;
     friend class TaskGuard;
 
+public:
+    static constexpr uint32_t MAX_CORES = 2;
+    static constexpr uint32_t LOCK_BITS = 2;
+    static constexpr uint32_t MAX_LOCKS = 1 << LOCK_BITS;
+
 private:
-    Task* _pending[Task::MAX_QUEUED];
-    uint16_t _rpos, _wpos, _size;
+    /* pending tasks, a ring per priority and producer core. */
+    TaskRing _pending[ETASK_PRIO_MAX][MAX_CORES];
+
+    /* core-agnostic tasks, consumers are serialized by `_stealLock`. */
+    TaskRing _shared[MAX_CORES];
+    spin_lock_t* _stealLock;
+    volatile uint8_t _sharing;
+    TaskTimer _timer;
     critical_section_t _cs;
 
+    /* striped spin locks for per-task state and refs. */
+    spin_lock_t* _locks[MAX_LOCKS];
+
 private:
     TaskQueue();
 
@@ -29,19 +46,68 @@ public:
     static TaskQueue* get();
     static void prepare();
 
+    /* ring the doorbell to wake core1 up. */
+    static void wakeup();
+
+public:
+    /* test whether core0 work-sharing is enabled or not. */
+    bool isSharing() const { return _sharing != 0; }
+
+    /* enable or disable core0 work-sharing. */
+    void setSharing(bool value) { _sharing = value ? 1 : 0; }
+
+    /**
+     * run a shared task on the calling core if work-sharing is enabled.
+     * called from core0's main loop when a scan cycle found no changes.
+     */
+    bool stealOnce();
+
+    /* get the lock stripe of the task. */
+    static uint32_t stripeOf(const Task* task);
+
+    /* reserve all expired tasks, called from core1's loop only. */
+    void fireTimers();
+
 protected:
     void enter_cs();
     void leave_cs();
 
+    /* get the striped lock for the task. */
+    spin_lock_t* lockOf(const Task* task) const;
+
 protected:
-    /* enqueue a task. */
+    /**
+     * enqueue a task.
+     * this pushes to the calling core's ring, so never call this from IRQ.
+     */
     bool enqueue(Task* task);
 
+    /* arm the task on the timer wheel, re-arm if already armed. */
+    bool schedule(Task* task, uint32_t ms, uint32_t period);
+
+    /* disarm the task from the timer wheel. */
+    bool cancel(Task* task);
+
 private:
     static void taskRun();
 
-    /* dequeue a task. */
-    bool dequeue(Task** outTask);
+    /* dequeue a task of the priority, called from core1 only. */
+    bool dequeue(ETaskPriority priority, Task** outTask);
+
+    /* run a task of the priority, returns false if nothing to run. */
+    bool runOnce(ETaskPriority priority);
+
+    /* dequeue a shared task, safe from any core. */
+    bool dequeueShared(Task** outTask);
+
+    /* run a shared task, returns false if nothing to run. */
+    bool runShared();
+
+    /* test whether no pending task exists or not. */
+    bool isEmpty() const;
+
+    /* get ms to sleep until the next timer, -1 if nothing armed. */
+    int32_t nextTimeout();
 
 };
 
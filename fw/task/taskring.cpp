@@ -0,0 +1,45 @@
+#include "taskring.h"
+
+TaskRing::TaskRing()
+    : _rpos(0), _wpos(0)
+{
+    for(uint32_t i = 0; i < MAX_SLOTS; ++i) {
+        _slots[i] = nullptr;
+    }
+}
+
+bool TaskRing::push(Task* task) {
+    const uint32_t wpos = _wpos.load(std::memory_order_relaxed);
+    const uint32_t rpos = _rpos.load(std::memory_order_acquire);
+
+    // --> full: unsigned subtraction handles the counter overflow.
+    if (wpos - rpos >= MAX_SLOTS) {
+        return false;
+    }
+
+    _slots[wpos & MASK] = task;
+
+    // --> publish the slot to the consumer.
+    _wpos.store(wpos + 1, std::memory_order_release);
+    return true;
+}
+
+bool TaskRing::pop(Task** outTask) {
+    const uint32_t rpos = _rpos.load(std::memory_order_relaxed);
+    const uint32_t wpos = _wpos.load(std::memory_order_acquire);
+
+    if (rpos == wpos) {
+        return false;
+    }
+
+    Task* task = _slots[rpos & MASK];
+
+    // --> release the slot to the producer.
+    _rpos.store(rpos + 1, std::memory_order_release);
+
+    if (outTask) {
+        *outTask = task;
+    }
+
+    return true;
+}
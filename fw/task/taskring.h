@@ -0,0 +1,46 @@
+#ifndef __TASK_TASKRING_H__
+#define __TASK_TASKRING_H__
+
+#include <stdint.h>
+#include <atomic>
+#include "task.h"
+
+/**
+ * lock-free single-producer, single-consumer task ring.
+ * only one core may push and only one core may pop at the same time.
+ */
+class TaskRing {
+public:
+    static constexpr uint32_t MAX_SLOTS = Task::MAX_QUEUED;
+    static constexpr uint32_t MASK = MAX_SLOTS - 1;
+
+    static_assert((MAX_SLOTS & MASK) == 0, "MAX_SLOTS must be power of two.");
+
+private:
+    Task* _slots[MAX_SLOTS];
+
+    /* free running positions, wrapped by `MASK` on access. */
+    std::atomic<uint32_t> _rpos;
+    std::atomic<uint32_t> _wpos;
+
+public:
+    TaskRing();
+
+public:
+    /* push a task, called from the producer only. */
+    bool push(Task* task);
+
+    /* pop a task, called from the consumer only. */
+    bool pop(Task** outTask);
+
+    /* get the count of pending tasks. */
+    uint32_t size() const {
+        const uint32_t wpos = _wpos.load(std::memory_order_acquire);
+        return wpos - _rpos.load(std::memory_order_acquire);
+    }
+
+    /* test whether the ring is empty or not. */
+    bool isEmpty() const { return size() == 0; }
+};
+
+#endif
@@ -0,0 +1,73 @@
+#include "taskstats.h"
+#include "pico/stdlib.h"
+#include <string.h>
+
+TaskStats::TaskStats() {
+    memset((void*) _cores, 0, sizeof(_cores));
+}
+
+TaskStats* TaskStats::get() {
+    static TaskStats _stats;
+    return &_stats;
+}
+
+void TaskStats::onEnqueue(uint32_t depth) {
+    SCore& core = _cores[get_core_num()];
+
+    core.enqueued = core.enqueued + 1;
+    if (depth > core.ringHwm) {
+        core.ringHwm = depth;
+    }
+}
+
+void TaskStats::onEnqueueFail() {
+    SCore& core = _cores[get_core_num()];
+    core.enqueueFails = core.enqueueFails + 1;
+}
+
+void TaskStats::onExecute(uint32_t us) {
+    SCore& core = _cores[get_core_num()];
+    const uint8_t bucket = bucketOf(us);
+
+    core.executed = core.executed + 1;
+    core.execHist[bucket] = core.execHist[bucket] + 1;
+}
+
+void TaskStats::onRedraw(uint32_t us) {
+    SCore& core = _cores[get_core_num()];
+    const uint8_t bucket = bucketOf(us);
+    const uint32_t lo = core.redrawUsLo + us;
+
+    core.redraws = core.redraws + 1;
+    core.redrawHist[bucket] = core.redrawHist[bucket] + 1;
+
+    // --> carry into the high word.
+    if (lo < core.redrawUsLo) {
+        core.redrawUsHi = core.redrawUsHi + 1;
+    }
+
+    core.redrawUsLo = lo;
+}
+
+void TaskStats::snapshot(STaskStats& out) const {
+    memset(&out, 0, sizeof(out));
+
+    for(uint32_t i = 0; i < MAX_CORES; ++i) {
+        const SCore& core = _cores[i];
+
+        out.enqueued += core.enqueued;
+        out.enqueueFails += core.enqueueFails;
+        out.executed += core.executed;
+        out.redraws += core.redraws;
+        out.redrawUs += (uint64_t(core.redrawUsHi) << 32) | core.redrawUsLo;
+
+        if (core.ringHwm > out.ringHwm) {
+            out.ringHwm = core.ringHwm;
+        }
+
+        for(uint32_t b = 0; b < MAX_BUCKETS; ++b) {
+            out.execHist[b] += core.execHist[b];
+            out.redrawHist[b] += core.redrawHist[b];
+        }
+    }
+}
@@ -0,0 +1,83 @@
+#ifndef __TASK_TASKSTATS_H__
+#define __TASK_TASKSTATS_H__
+
+#include <stdint.h>
+
+/**
+ * snapshot of task statistics.
+ */
+struct STaskStats {
+    static constexpr uint32_t MAX_BUCKETS = 16;
+
+    uint32_t enqueued;                  // --> successful enqueues.
+    uint32_t enqueueFails;              // --> enqueues failed due to full ring.
+    uint32_t ringHwm;                   // --> deepest single ring, not the total depth.
+    uint32_t executed;                  // --> executed callbacks.
+    uint32_t execHist[MAX_BUCKETS];     // --> callback time, log2 us buckets.
+    uint32_t redraws;                   // --> redraw chunks.
+    uint32_t redrawHist[MAX_BUCKETS];   // --> redraw chunk time, log2 us buckets.
+    uint64_t redrawUs;                  // --> total time spent on redraw.
+};
+
+/**
+ * task and queue statistics.
+ * each core writes its own counters only, so recording takes no lock.
+ */
+class TaskStats {
+public:
+    static constexpr uint32_t MAX_CORES = 2;
+    static constexpr uint32_t MAX_BUCKETS = STaskStats::MAX_BUCKETS;
+
+private:
+    /* per-core counters, single writer. */
+    struct SCore {
+        volatile uint32_t enqueued;
+        volatile uint32_t enqueueFails;
+        volatile uint32_t ringHwm;
+        volatile uint32_t executed;
+        volatile uint32_t execHist[MAX_BUCKETS];
+        volatile uint32_t redraws;
+        volatile uint32_t redrawHist[MAX_BUCKETS];
+        volatile uint32_t redrawUsLo;
+        volatile uint32_t redrawUsHi;
+    };
+
+private:
+    SCore _cores[MAX_CORES];
+
+private:
+    TaskStats();
+
+public:
+    /* get the singleton instance. */
+    static TaskStats* get();
+
+    /* get the log2 bucket for microseconds: 0 for 0 us, n for [2^(n-1), 2^n). */
+    static uint8_t bucketOf(uint32_t us) {
+        if (us == 0) {
+            return 0;
+        }
+
+        const uint32_t bucket = 32 - __builtin_clz(us);
+        return bucket < MAX_BUCKETS ? bucket : MAX_BUCKETS - 1;
+    }
+
+public:
+    /* record a successful enqueue with the depth of its ring after it. */
+    void onEnqueue(uint32_t depth);
+
+    /* record a failed enqueue. */
+    void onEnqueueFail();
+
+    /* record a callback execution time. */
+    void onExecute(uint32_t us);
+
+    /* record a redraw chunk time. */
+    void onRedraw(uint32_t us);
+
+public:
+    /* take the snapshot summed over all cores. */
+    void snapshot(STaskStats& out) const;
+};
+
+#endif
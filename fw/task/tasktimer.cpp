@@ -0,0 +1,146 @@
+#include "tasktimer.h"
+
+TaskTimer::TaskTimer() {
+    for(uint32_t level = 0; level < MAX_LEVELS; ++level) {
+        for(uint32_t i = 0; i < MAX_SLOTS; ++i) {
+            _slots[level][i] = nullptr;
+        }
+    }
+
+    _now = 0;
+    _count = 0;
+}
+
+void TaskTimer::sync(uint32_t now) {
+    // --> nothing to catch up, so jump directly.
+    if (_count == 0) {
+        _now = now;
+    }
+}
+
+void TaskTimer::link(Task** slot, Task* task) {
+    task->_tslot = slot;
+    task->_tprev = nullptr;
+    task->_tnext = *slot;
+
+    if (*slot) {
+        (*slot)->_tprev = task;
+    }
+
+    *slot = task;
+}
+
+void TaskTimer::insert(Task* task, uint32_t deadline) {
+    int32_t delta = int32_t(deadline - _now);
+    task->_deadline = deadline;
+
+    // --> already expired: fire on the current tick.
+    if (delta < 0) {
+        delta = 0;
+        deadline = _now;
+    }
+
+    // --> too far: park on the last level, re-inserted by cascading.
+    if (uint32_t(delta) > MAX_SPAN) {
+        delta = MAX_SPAN;
+        deadline = _now + MAX_SPAN;
+    }
+
+    uint32_t level = 0;
+    while (level < MAX_LEVELS - 1 && 
+           uint32_t(delta) >= (1u << (SLOT_BITS * (level + 1))))
+    {
+        level++;
+    }
+
+    const uint32_t index = (deadline >> (SLOT_BITS * level)) & SLOT_MASK;
+    link(&_slots[level][index], task);
+    _count++;
+}
+
+void TaskTimer::remove(Task* task) {
+    if (task->_tslot == nullptr) {
+        return;
+    }
+
+    if (task->_tprev) {
+        task->_tprev->_tnext = task->_tnext;
+    }
+
+    else {
+        *task->_tslot = task->_tnext;
+    }
+
+    if (task->_tnext) {
+        task->_tnext->_tprev = task->_tprev;
+    }
+
+    task->_tslot = nullptr;
+    task->_tprev = task->_tnext = nullptr;
+    _count--;
+}
+
+void TaskTimer::cascade(uint32_t level) {
+    const uint32_t index = (_now >> (SLOT_BITS * level)) & SLOT_MASK;
+    Task* task = _slots[level][index];
+
+    // --> detach the slot, then spread its tasks.
+    _slots[level][index] = nullptr;
+
+    while (task) {
+        Task* next = task->_tnext;
+
+        task->_tslot = nullptr;
+        _count--;
+
+        insert(task, task->_deadline);
+        task = next;
+    }
+}
+
+Task* TaskTimer::expire(uint32_t now) {
+    while (true) {
+        Task* task = _slots[0][_now & SLOT_MASK];
+        if (task) {
+            remove(task);
+            return task;
+        }
+
+        // --> caught up, `now` can be behind if synced by other core.
+        if (int32_t(now - _now) <= 0) {
+            return nullptr;
+        }
+
+        if (_count == 0) {
+            _now = now;
+            return nullptr;
+        }
+
+        _now++;
+
+        // --> lower level wrapped: pull down the next upper slot.
+        for(uint32_t level = 1; level < MAX_LEVELS; ++level) {
+            if (((_now >> (SLOT_BITS * (level - 1))) & SLOT_MASK) != 0) {
+                break;
+            }
+
+            cascade(level);
+        }
+    }
+}
+
+int32_t TaskTimer::nextTimeout() const {
+    if (_count == 0) {
+        return -1;
+    }
+
+    // --> level 0 covers until the next 64 ms boundary.
+    const uint32_t left = MAX_SLOTS - (_now & SLOT_MASK);
+    for(uint32_t i = 0; i < left; ++i) {
+        if (_slots[0][(_now + i) & SLOT_MASK]) {
+            return int32_t(i);
+        }
+    }
+
+    return int32_t(left);
+}
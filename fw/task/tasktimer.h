@@ -0,0 +1,60 @@
+#ifndef __TASK_TASKTIMER_H__
+#define __TASK_TASKTIMER_H__
+
+#include <stdint.h>
+#include "task.h"
+
+/**
+ * hierarchical timer wheel for delayed tasks.
+ * this does no locking, `TaskQueue` guards it by its critical section.
+ */
+class TaskTimer {
+public:
+    static constexpr uint32_t SLOT_BITS = 6;
+    static constexpr uint32_t MAX_SLOTS = 1 << SLOT_BITS;
+    static constexpr uint32_t SLOT_MASK = MAX_SLOTS - 1;
+    static constexpr uint32_t MAX_LEVELS = 3;
+
+    /* the farthest deadline that the wheel can hold, in ms. */
+    static constexpr uint32_t MAX_SPAN = (1 << (SLOT_BITS * MAX_LEVELS)) - 1;
+
+private:
+    /* level 0: 1 ms, level 1: 64 ms, level 2: 4096 ms per slot. */
+    Task* _slots[MAX_LEVELS][MAX_SLOTS];
+    uint32_t _now;
+    uint32_t _count;
+
+public:
+    TaskTimer();
+
+public:
+    /* move the wheel to `now` if no timer is armed. */
+    void sync(uint32_t now);
+
+    /* insert a task that is not armed yet. */
+    void insert(Task* task, uint32_t deadline);
+
+    /* remove an armed task. */
+    void remove(Task* task);
+
+    /**
+     * advance the wheel up to `now` and pop an expired task.
+     * returns nullptr if no more task expired until `now`.
+     */
+    Task* expire(uint32_t now);
+
+    /* get ms to sleep until the wheel must advance, -1 if nothing armed. */
+    int32_t nextTimeout() const;
+
+    /* get the count of armed tasks. */
+    uint32_t size() const { return _count; }
+
+private:
+    /* link the task to the slot. */
+    void link(Task** slot, Task* task);
+
+    /* re-insert all tasks of the slot to lower levels. */
+    void cascade(uint32_t level);
+};
+
+#endif
@@ -0,0 +1,77 @@
+#include "test.h"
+#include "session.h"
+#include "kbd/typematic.h"
+#include <new>
+#include <stdlib.h>
+
+// --> counts every allocation of this process.
+static uint32_t g_allocs = 0;
+
+void* operator new(size_t size) {
+    g_allocs++;
+
+    if (void* ptr = malloc(size ? size : 1)) {
+        return ptr;
+    }
+
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept { free(ptr); }
+void operator delete[](void* ptr) noexcept { free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { free(ptr); }
+
+/* press and release keys in rolls and chords. */
+static void type(KbdSession& session) {
+    static const EKey KEYS[] = {
+        EKEY_NUM_1, EKEY_NUM_2, EKEY_PLUS, EKEY_MINUS,
+        EKEY_ENTER, EKEY_NUMLOCK, EKEY_UFN_1, EKEY_NUM_5
+    };
+
+    for(const EKey key : KEYS) {
+        session.scanner.press(key);
+        session.run(3);
+    }
+
+    session.run(600);
+
+    for(const EKey key : KEYS) {
+        session.scanner.release(key);
+        session.run(7);
+    }
+
+    session.run(300);
+}
+
+TEST(alloc_none_while_dispatching) {
+    KbdSession session;
+    Kbd* kbd = Kbd::get();
+
+    kbd->getTypematic()->setActive(true);
+
+    // --> the first session brings up all singletons.
+    type(session);
+
+    const uint32_t allocs = g_allocs;
+    for(uint32_t i = 0; i < 10; ++i) {
+        type(session);
+    }
+
+    EXPECT_EQ(g_allocs - allocs, 0);
+    EXPECT(session.listener.getPosts() > 0);
+    kbd->getTypematic()->setActive(false);
+}
+
+TEST(alloc_counted) {
+    const uint32_t allocs = g_allocs;
+
+    // --> the counter itself works.
+    int* volatile probe = new int(0);
+    delete probe;
+    EXPECT_EQ(g_allocs - allocs, 1);
+}
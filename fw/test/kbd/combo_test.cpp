@@ -0,0 +1,194 @@
+#include "test.h"
+#include "session.h"
+#include "kbd/scancode.h"
+#include "kbd/handlers/combo.h"
+#include "kbd/handlers/macro.h"
+
+/* test whether the keys are all in a combo, bit N: EKey(N). */
+static bool isCombo(uint32_t keys) {
+    for(uint32_t i = 0; i < KbdComboHandler::size(); ++i) {
+        if (KbdComboHandler::getComboKeys(i) == keys) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+TEST(combo_index) {
+    const uint32_t count = KbdComboHandler::size();
+
+    EXPECT(count > 0 && count <= KbdComboHandler::MAX_COMBOS);
+    EXPECT(isCombo((1u << EKEY_NUM_0) | (1u << EKEY_DOT)));
+    EXPECT(isCombo((1u << EKEY_SLASH) | (1u << EKEY_ASTEROID)));
+
+    // --> chords of two or more, each with a reportable key code or a macro.
+    for(uint32_t i = 0; i < count; ++i) {
+        const EKeyComboAction action = KbdComboHandler::getComboAction(i);
+
+        EXPECT(__builtin_popcount(KbdComboHandler::getComboKeys(i)) >= 2);
+        EXPECT(action == EKCA_CHAR || action == EKCA_MACRO);
+        EXPECT(action != EKCA_CHAR || KbdComboHandler::getComboChar(i).kc != KC_NONE);
+    }
+
+    EXPECT_EQ(KbdComboHandler::getComboAction(count), EKCA_MAX_VALUE);
+    EXPECT_EQ(KbdComboHandler::getComboKeys(count), 0);
+    EXPECT_EQ(KbdComboHandler::getComboChar(count).kc, 0);
+}
+
+TEST(combo_kbd_chord) {
+    KbdSession session;
+    Kbd* kbd = Kbd::get();
+    KbdComboHandler* combo = KbdComboHandler::instance();
+
+    combo->setEnabled(true);
+
+    // --> held back within the window.
+    session.scanner.press(EKEY_NUM_0);
+    session.run(5);
+    EXPECT(kbd->isKeyHidden(EKEY_NUM_0));
+
+    // --> completed: the lowest key reports the combo, the other stays hidden.
+    session.scanner.press(EKEY_DOT);
+    session.run(5);
+    EXPECT(kbd->isKeyHidden(EKEY_NUM_0) == false);
+    EXPECT(kbd->isKeyHidden(EKEY_DOT));
+    EXPECT_EQ(kbd->getKeyChar(EKEY_NUM_0).kc, KC_KEYPAD_EQUAL);
+
+    // --> released one by one: the other can't type on its own.
+    session.scanner.release(EKEY_NUM_0);
+    session.run(5);
+    EXPECT_EQ(kbd->getKeyChar(EKEY_NUM_0).kc, KC_KEYPAD_0);
+    EXPECT(kbd->isKeyHidden(EKEY_DOT));
+
+    session.scanner.release(EKEY_DOT);
+    session.run(5);
+    EXPECT(kbd->isKeyHidden(EKEY_DOT) == false);
+
+    combo->setEnabled(false);
+}
+
+TEST(combo_kbd_window_ends) {
+    KbdSession session;
+    Kbd* kbd = Kbd::get();
+    KbdComboHandler* combo = KbdComboHandler::instance();
+
+    combo->setEnabled(true);
+    combo->setWindow(20000);
+
+    // --> a missed chord costs at most the window.
+    session.scanner.press(EKEY_NUM_0);
+    session.run(15);
+    EXPECT(kbd->isKeyHidden(EKEY_NUM_0));
+
+    session.run(10);
+    EXPECT(kbd->isKeyHidden(EKEY_NUM_0) == false);
+    EXPECT_EQ(kbd->getKeyChar(EKEY_NUM_0).kc, KC_KEYPAD_0);
+
+    // --> too late for the chord: a new one, typed as it is.
+    session.scanner.press(EKEY_DOT);
+    session.run(5);
+    EXPECT(kbd->isKeyHidden(EKEY_DOT));
+
+    session.run(20);
+    EXPECT(kbd->isKeyHidden(EKEY_DOT) == false);
+    EXPECT_EQ(kbd->getKeyChar(EKEY_NUM_0).kc, KC_KEYPAD_0);
+    EXPECT_EQ(kbd->getKeyChar(EKEY_DOT).kc, KC_KEYPAD_DECIMAL);
+
+    session.scanner.set(0);
+    session.run(5);
+
+    combo->setWindow(KbdComboHandler::DEFAULT_WINDOW_US);
+    combo->setEnabled(false);
+}
+
+TEST(combo_kbd_other_key_flushes) {
+    KbdSession session;
+    Kbd* kbd = Kbd::get();
+    KbdComboHandler* combo = KbdComboHandler::instance();
+
+    combo->setEnabled(true);
+
+    // --> a key in no chord with the pending ones releases them.
+    session.scanner.press(EKEY_NUM_0);
+    session.run(5);
+    session.scanner.press(EKEY_PLUS);
+    session.run(5);
+
+    EXPECT(kbd->isKeyHidden(EKEY_NUM_0) == false);
+    EXPECT(kbd->isKeyHidden(EKEY_PLUS) == false);
+
+    session.scanner.set(0);
+    session.run(5);
+
+    // --> released within the window: still typed.
+    session.listener.clear();
+    session.scanner.press(EKEY_SLASH);
+    session.run(5);
+    session.scanner.release(EKEY_SLASH);
+    session.run(5);
+
+    EXPECT(kbd->isKeyHidden(EKEY_SLASH) == false);
+    EXPECT(kbd->isKeyDown(EKEY_SLASH) == false);
+    EXPECT_EQ(session.listener.count(EKEY_SLASH, EKLS_RISE), 1);
+
+    combo->setEnabled(false);
+}
+
+TEST(combo_kbd_macro) {
+    KbdSession session;
+    Kbd* kbd = Kbd::get();
+    KbdComboHandler* combo = KbdComboHandler::instance();
+    KbdMacroHandler* macro = KbdMacroHandler::instance();
+
+    EXPECT_EQ(KbdComboHandler::getComboAction(0), EKCA_CHAR);
+    combo->setEnabled(true);
+
+    // --> record a single key.
+    EXPECT(macro->record());
+    session.scanner.press(EKEY_NUM_1);
+    session.run(10);
+    session.scanner.release(EKEY_NUM_1);
+    session.run(10);
+    macro->stop(kbd);
+
+    // --> the chord plays it: both keys stay hidden, nothing typed for them.
+    session.listener.clear();
+    session.scanner.press(EKEY_NUM_0);
+    session.run(5);
+    session.scanner.press(EKEY_SLASH);
+    session.run(2);
+
+    EXPECT_EQ(macro->getState(), EKMS_PLAYING);
+    EXPECT(kbd->isKeyHidden(EKEY_NUM_0));
+    EXPECT(kbd->isKeyHidden(EKEY_SLASH));
+
+    session.run(50);
+    EXPECT_EQ(session.listener.count(EKEY_NUM_1, EKLS_RISE), 1);
+    EXPECT_EQ(session.listener.count(EKEY_NUM_1, EKLS_FALL), 1);
+    EXPECT_EQ(macro->getState(), EKMS_IDLE);
+
+    session.scanner.set(0);
+    session.run(5);
+    EXPECT(kbd->isKeyHidden(EKEY_NUM_0) == false);
+    EXPECT(kbd->isKeyHidden(EKEY_SLASH) == false);
+
+    macro->stop(kbd);
+    combo->setEnabled(false);
+}
+
+TEST(combo_kbd_disabled) {
+    KbdSession session;
+    Kbd* kbd = Kbd::get();
+
+    KbdComboHandler::instance()->setEnabled(false);
+
+    // --> off: chord keys are never held back.
+    session.scanner.press(EKEY_NUM_0);
+    session.run(2);
+    EXPECT(kbd->isKeyHidden(EKEY_NUM_0) == false);
+
+    session.scanner.press(EKEY_DOT);
+    session.run(2);
+    EXPECT_EQ(kbd->getKeyChar(EKEY_NUM_0).kc, KC_KEYPAD_0);
+}
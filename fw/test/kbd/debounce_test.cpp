@@ -0,0 +1,130 @@
+#include "test.h"
+#include "kbd/debounce.h"
+
+static constexpr uint32_t WINDOW_US = 5000;
+
+/* feed a bounce train starting at `at`: level flips every `step` us. */
+static bool bounce(KbdDebouncer& db, EKey key, uint32_t at, uint32_t flips, uint32_t step) {
+    bool raw = true;
+    bool out = false;
+
+    for(uint32_t i = 0; i < flips; ++i, raw = !raw) {
+        out = db.filter(key, raw, at + i * step);
+    }
+
+    return out;
+}
+
+TEST(debounce_defaults) {
+    KbdDebouncer db;
+
+    EXPECT_EQ(db.getMode(EKEY_NUM_5), EKDB_EAGER);
+    EXPECT_EQ(db.getWindow(EKEY_NUM_5), KbdDebouncer::DEFAULT_US);
+    EXPECT(db.isSettled());
+
+    EXPECT(db.setMode(EKEY_MAX, EKDB_NONE, 0) == false);
+    EXPECT(db.setMode(EKEY_NUM_5, EKDB_MAX_VALUE, 0) == false);
+}
+
+TEST(debounce_none_follows_raw) {
+    KbdDebouncer db;
+    db.setModeAll(EKDB_NONE, WINDOW_US);
+
+    EXPECT(db.filter(EKEY_NUM_5, true, 10000));
+    EXPECT(db.filter(EKEY_NUM_5, false, 10001) == false);
+    EXPECT(db.isSettled());
+}
+
+TEST(debounce_eager) {
+    KbdDebouncer db;
+    db.setModeAll(EKDB_EAGER, WINDOW_US);
+
+    // --> the first edge passes at once, bounces are locked out.
+    EXPECT(db.filter(EKEY_NUM_5, true, 10000));
+    EXPECT(db.filter(EKEY_NUM_5, false, 10100));
+    EXPECT(db.filter(EKEY_NUM_5, true, 10200));
+    EXPECT(db.filter(EKEY_NUM_5, false, 14999));
+
+    // --> the release passes once the window is over.
+    EXPECT(db.filter(EKEY_NUM_5, false, 15000) == false);
+    EXPECT(db.isSettled());
+}
+
+TEST(debounce_deferred) {
+    KbdDebouncer db;
+    db.setModeAll(EKDB_DEFERRED, WINDOW_US);
+
+    // --> bounces restart the window, reported once stable.
+    EXPECT(bounce(db, EKEY_NUM_5, 10000, 5, 100) == false);
+    EXPECT(db.isSettled() == false);
+
+    EXPECT(db.filter(EKEY_NUM_5, true, 10400 + WINDOW_US - 1) == false);
+    EXPECT(db.filter(EKEY_NUM_5, true, 10400 + WINDOW_US));
+    EXPECT(db.isSettled());
+
+    // --> a glitch shorter than the window never shows.
+    EXPECT(db.filter(EKEY_NUM_5, false, 20000));
+    EXPECT(db.filter(EKEY_NUM_5, true, 21000));
+    EXPECT(db.filter(EKEY_NUM_5, true, 30000));
+}
+
+TEST(debounce_integrator) {
+    KbdDebouncer db;
+    db.setModeAll(EKDB_INTEGRATOR, WINDOW_US);
+
+    db.filter(EKEY_NUM_5, false, 0);
+
+    // --> rises after integrating a window of high time.
+    EXPECT(db.filter(EKEY_NUM_5, true, 1000) == false);
+    EXPECT(db.filter(EKEY_NUM_5, true, 3000) == false);
+    EXPECT(db.filter(EKEY_NUM_5, false, 4000) == false);
+    EXPECT(db.filter(EKEY_NUM_5, true, 5000) == false);
+    EXPECT(db.filter(EKEY_NUM_5, true, 8000));
+    EXPECT(db.isSettled());
+
+    // --> falls after integrating back down to zero.
+    EXPECT(db.filter(EKEY_NUM_5, false, 10000));
+    EXPECT(db.isSettled() == false);
+    EXPECT(db.filter(EKEY_NUM_5, false, 10000 + WINDOW_US) == false);
+    EXPECT(db.isSettled());
+}
+
+TEST(debounce_per_key) {
+    KbdDebouncer db;
+
+    db.setModeAll(EKDB_DEFERRED, WINDOW_US);
+    db.setMode(EKEY_ENTER, EKDB_NONE, 0);
+
+    EXPECT(db.filter(EKEY_ENTER, true, 100));
+    EXPECT(db.filter(EKEY_NUM_5, true, 100) == false);
+    EXPECT_EQ(db.getMode(EKEY_NUM_5), EKDB_DEFERRED);
+}
+
+TEST(debounce_filter_all) {
+    KbdDebouncer db;
+    db.setModeAll(EKDB_DEFERRED, WINDOW_US);
+
+    const uint32_t a = 1u << EKEY_NUM_1;
+    const uint32_t b = 1u << EKEY_NUM_2;
+
+    EXPECT_EQ(db.filterAll(a | b, a | b, 1000), 0);
+    EXPECT_EQ(db.filterAll(a | b, a | b, 1000 + WINDOW_US), a | b);
+
+    // --> keys outside `present` are left alone.
+    EXPECT_EQ(db.filterAll(0, a, 20000), a | b);
+    EXPECT_EQ(db.filterAll(0, a, 20000 + WINDOW_US), b);
+    EXPECT(db.isSettled());
+}
+
+TEST(debounce_filter_all_integrates_from_last_sample) {
+    KbdDebouncer db;
+    db.setModeAll(EKDB_INTEGRATOR, WINDOW_US);
+
+    const uint32_t a = 1u << EKEY_NUM_1;
+
+    // --> a long quiet stretch must not count as high time.
+    EXPECT_EQ(db.filterAll(0, a, 1000), 0);
+    EXPECT_EQ(db.filterAll(0, a, 100000), 0);
+    EXPECT_EQ(db.filterAll(a, a, 101000), 0);
+    EXPECT_EQ(db.filterAll(a, a, 101000 + WINDOW_US), a);
+}
@@ -0,0 +1,263 @@
+#include "test.h"
+#include "session.h"
+#include "kbd/event.h"
+#include "kbd/jitter.h"
+#include "pico/stdlib.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <stdio.h>
+
+/* make an event of the key. */
+static SKeyEvent eventOf(uint32_t us, EKey key, EKeyState state) {
+    SKeyEvent event;
+
+    event.us = us;
+    event.key = uint8_t(key);
+    event.state = uint8_t(state);
+    return event;
+}
+
+TEST(event_fifo_order) {
+    KbdEventRing ring;
+    SKeyEvent event;
+
+    EXPECT(ring.pop(&event) == false);
+
+    for(uint32_t i = 0; i < 5; ++i) {
+        EXPECT(ring.push(eventOf(100 + i, EKey(i), EKLS_RISE)));
+    }
+
+    EXPECT_EQ(ring.size(), 5);
+
+    for(uint32_t i = 0; i < 5; ++i) {
+        EXPECT(ring.pop(&event));
+        EXPECT_EQ(event.us, 100 + i);
+        EXPECT_EQ(event.key, i);
+    }
+
+    EXPECT(ring.isEmpty());
+    EXPECT_EQ(ring.getPushed(), 5);
+    EXPECT_EQ(ring.getPeak(), 5);
+}
+
+TEST(event_full_drops) {
+    KbdEventRing ring;
+
+    for(uint32_t i = 0; i < KbdEventRing::MAX_EVENTS; ++i) {
+        EXPECT(ring.push(eventOf(i, EKEY_NUM_1, EKLS_RISE)));
+    }
+
+    // --> refused and counted, never overwriting the oldest.
+    EXPECT(ring.push(eventOf(999, EKEY_NUM_1, EKLS_FALL)) == false);
+    EXPECT_EQ(ring.getDrops(), 1);
+    EXPECT_EQ(ring.getPeak(), KbdEventRing::MAX_EVENTS);
+
+    SKeyEvent event;
+    EXPECT(ring.pop(&event));
+    EXPECT_EQ(event.us, 0);
+}
+
+TEST(event_wraps) {
+    KbdEventRing ring;
+    SKeyEvent event;
+
+    for(uint32_t i = 0; i < KbdEventRing::MAX_EVENTS * 3 + 7; ++i) {
+        EXPECT(ring.push(eventOf(i, EKEY_NUM_1, EKLS_RISE)));
+        EXPECT(ring.pop(&event));
+        EXPECT_EQ(event.us, i);
+    }
+
+    EXPECT_EQ(ring.getPeak(), 1);
+}
+
+TEST(event_spsc_threads) {
+    static constexpr uint32_t COUNT = 200000;
+
+    KbdEventRing ring;
+    uint32_t errors = 0;
+
+    // --> the scan stage and the dispatch stage on two cores.
+    std::thread producer([&ring]() {
+        for(uint32_t i = 0; i < COUNT; ++i) {
+            while(ring.push(eventOf(i, EKey(i % EKEY_MAX), EKLS_RISE)) == false) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    for(uint32_t i = 0; i < COUNT; ++i) {
+        SKeyEvent event;
+
+        while(ring.pop(&event) == false) {
+            std::this_thread::yield();
+        }
+
+        if (event.us != i || event.key != i % EKEY_MAX) {
+            errors++;
+        }
+    }
+
+    producer.join();
+    EXPECT_EQ(errors, 0);
+}
+
+TEST(event_sample_time) {
+    KbdSession session;
+    Kbd* kbd = Kbd::get();
+
+    // --> stamped with the GPIO sample, not the dispatch.
+    session.scanner.press(EKEY_PLUS);
+    const uint32_t sampled = time_us_32();
+
+    stub_time_us += 300;
+    kbd->scanOnce();
+
+    stub_time_us += 700;
+    kbd->dispatchOnce();
+
+    EXPECT_EQ(kbd->getKeyTime(EKEY_PLUS), sampled);
+    EXPECT(kbd->isKeyDown(EKEY_PLUS));
+}
+
+TEST(event_one_edge_per_dispatch) {
+    KbdSession session;
+    Kbd* kbd = Kbd::get();
+
+    // --> a tap scanned twice before the dispatch stage runs.
+    session.scanner.press(EKEY_PLUS);
+    stub_time_us += 1000;
+    kbd->scanOnce();
+
+    stub_time_us += 10000;
+    session.scanner.release(EKEY_PLUS);
+    stub_time_us += 1000;
+    kbd->scanOnce();
+
+    EXPECT_EQ(kbd->getEvents()->size(), 2);
+
+    // --> handlers see the press, then the release on the next dispatch.
+    EXPECT(kbd->dispatchOnce());
+    EXPECT(kbd->checkKeyState(EKEY_PLUS, EKLS_RISE));
+    EXPECT_EQ(session.listener.count(EKEY_PLUS, EKLS_FALL), 0);
+
+    EXPECT(kbd->dispatchOnce());
+    EXPECT(kbd->checkKeyState(EKEY_PLUS, EKLS_FALL));
+    EXPECT_EQ(session.listener.count(EKEY_PLUS, EKLS_RISE), 1);
+    EXPECT_EQ(session.listener.count(EKEY_PLUS, EKLS_FALL), 1);
+}
+
+TEST(event_keeps_order_behind_held_edge) {
+    KbdSession session;
+    Kbd* kbd = Kbd::get();
+
+    // --> a tap of one key, then a press of another: the press
+    //     waits behind the release, so the order is kept.
+    session.scanner.press(EKEY_PLUS);
+    stub_time_us += 1000;
+    kbd->scanOnce();
+
+    stub_time_us += 10000;
+    session.scanner.release(EKEY_PLUS);
+    stub_time_us += 1000;
+    kbd->scanOnce();
+
+    stub_time_us += 1000;
+    session.scanner.press(EKEY_MINUS);
+    stub_time_us += 1000;
+    kbd->scanOnce();
+
+    kbd->dispatchOnce();
+    EXPECT(kbd->isKeyDown(EKEY_PLUS));
+    EXPECT(kbd->isKeyDown(EKEY_MINUS) == false);
+
+    kbd->dispatchOnce();
+    EXPECT(kbd->isKeyUp(EKEY_PLUS));
+    EXPECT(kbd->isKeyDown(EKEY_MINUS));
+}
+
+/**
+ * listener that blocks the dispatch stage, e.g. a synchronous TFT write.
+ */
+class SlowListener : public IKeyListener {
+public:
+    static constexpr uint32_t SLOW_US = 50000;
+
+public:
+    virtual void onKeyNotify(const Kbd* kbd, EKey key, EKeyState state) override {
+        std::this_thread::sleep_for(std::chrono::microseconds(SLOW_US));
+    }
+};
+
+/* scan at 1 kHz of the real clock with typing, dispatching inline or on core1. */
+static void benchScanJitter(bool decoupled, SKbdJitter& out) {
+    static constexpr uint32_t PERIOD_US = 1000;
+    static constexpr uint32_t TICKS = 400;
+
+    KbdSession session;
+    SlowListener slow;
+    KbdJitter jitter;
+    Kbd* kbd = Kbd::get();
+    std::atomic<bool> running(true);
+    std::atomic<bool> started(false);
+
+    kbd->listen(&slow);
+    jitter.restart(PERIOD_US);
+
+    std::thread core1([decoupled, &running, &started, kbd]() {
+        stub_core_num = 1;
+        started = true;
+
+        while(decoupled && running) {
+            if (kbd->dispatchOnce() == false) {
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+        }
+    });
+
+    // --> the schedule starts once core1 runs.
+    while(started == false) {
+        std::this_thread::yield();
+    }
+
+    const auto begin = std::chrono::steady_clock::now();
+    const uint64_t base = stub_time_us;
+
+    for(uint32_t i = 0; i <= TICKS; ++i) {
+        std::this_thread::sleep_until(begin + std::chrono::microseconds(i * PERIOD_US));
+
+        const uint64_t us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - begin).count();
+
+        jitter.onTick(uint32_t(us));
+        stub_time_us = base + us;
+
+        // --> a key pressed for 20 ms of every 40 ms.
+        session.scanner.set((i % 40) < 20 ? 1u << EKEY_NUM_1 : 0);
+        kbd->scanOnce();
+
+        if (decoupled == false) {
+            kbd->dispatchOnce();
+        }
+    }
+
+    running = false;
+    core1.join();
+
+    kbd->unlisten(&slow);
+    jitter.snapshot(out);
+}
+
+TEST(event_slow_listener_jitter) {
+    SKbdJitter coupled, decoupled;
+
+    benchScanJitter(false, coupled);
+    benchScanJitter(true, decoupled);
+
+    // --> a slow listener stalls only the dispatch stage.
+    EXPECT(coupled.maxLate >= SlowListener::SLOW_US / 2);
+    EXPECT(decoupled.maxLate < SlowListener::SLOW_US / 2);
+
+    printf("  coupled: max late %u us, %u overruns; decoupled: max late %u us, %u overruns\n",
+        coupled.maxLate, coupled.overruns, decoupled.maxLate, decoupled.overruns);
+}
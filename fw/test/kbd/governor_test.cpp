@@ -0,0 +1,104 @@
+#include "test.h"
+#include "kbd/governor.h"
+
+/* scan whenever due, 1 us steps, until `until` (us), returns the last scan time. */
+static uint32_t scanUntil(KbdScanGovernor& gov, uint32_t from, uint32_t until, bool active) {
+    uint32_t last = from;
+
+    for(uint32_t now = from; now < until; ++now) {
+        if (gov.isDue(now)) {
+            gov.onScan(now, active);
+            last = now;
+        }
+    }
+
+    return last;
+}
+
+TEST(governor_defaults) {
+    KbdScanGovernor gov;
+
+    EXPECT_EQ(gov.getPeriod(), KbdScanGovernor::DEFAULT_FAST_US);
+    EXPECT_EQ(gov.getRate(), 8000);
+    EXPECT_EQ(gov.getLevel(), 0);
+}
+
+TEST(governor_due_tolerates_early_ticks) {
+    KbdScanGovernor gov;
+    const uint32_t fast = KbdScanGovernor::DEFAULT_FAST_US;
+
+    gov.onScan(1000, true);
+
+    // --> up to half of the fast period early.
+    EXPECT(gov.isDue(1000 + fast - fast / 2 - 1) == false);
+    EXPECT(gov.isDue(1000 + fast - fast / 2));
+    EXPECT(gov.isDue(1000 + fast));
+}
+
+TEST(governor_holds_then_decays) {
+    KbdScanGovernor gov;
+    const SKbdGovernorConfig& cfg = gov.getConfig();
+
+    scanUntil(gov, 0, 10000, true);
+
+    // --> fast for the hold time after the last activity.
+    scanUntil(gov, 10000, 10000 + cfg.holdUs - cfg.fastUs, false);
+    EXPECT_EQ(gov.getLevel(), 0);
+
+    // --> then one doubling per decay interval, up to the slow rate.
+    uint32_t now = scanUntil(gov, 10000 + cfg.holdUs - cfg.fastUs, 10000 + cfg.holdUs + cfg.fastUs, false);
+    EXPECT_EQ(gov.getLevel(), 1);
+    EXPECT_EQ(gov.getPeriod(), cfg.fastUs * 2);
+
+    now = scanUntil(gov, now + 1, now + cfg.decayUs * 3, false);
+    EXPECT_EQ(gov.getPeriod(), cfg.slowUs);
+    EXPECT_EQ(gov.getLevel(), 3);
+
+    // --> never slower than the slow rate.
+    now = scanUntil(gov, now + 1, now + cfg.decayUs * 4, false);
+    EXPECT_EQ(gov.getPeriod(), cfg.slowUs);
+    EXPECT_EQ(gov.getRate(), 1000);
+
+    // --> activity restores the fast rate at once.
+    gov.onScan(now + cfg.slowUs, true);
+    EXPECT_EQ(gov.getPeriod(), cfg.fastUs);
+    EXPECT_EQ(gov.getLevel(), 0);
+}
+
+TEST(governor_clamps_config) {
+    KbdScanGovernor gov;
+    SKbdGovernorConfig cfg = { 0, 0, 1000, 1000 };
+
+    gov.setConfig(cfg);
+    EXPECT_EQ(gov.getConfig().fastUs, 1);
+    EXPECT_EQ(gov.getConfig().slowUs, 1);
+
+    // --> reachable by doubling from the fast period.
+    cfg = { 100, 1000000, 1000, 1000 };
+    gov.setConfig(cfg);
+    EXPECT_EQ(gov.getConfig().slowUs, 100u << (KbdScanGovernor::MAX_LEVELS - 1));
+    EXPECT_EQ(gov.getPeriod(), 100);
+}
+
+TEST(governor_time_in_levels) {
+    KbdScanGovernor gov;
+    const SKbdGovernorConfig& cfg = gov.getConfig();
+
+    gov.onScan(0, false);
+    const uint32_t last = scanUntil(gov, 1, cfg.holdUs + cfg.decayUs * 5, false);
+
+    // --> every microsecond between the first and last scan is accounted.
+    uint64_t total = 0;
+    for(uint32_t i = 0; i < KbdScanGovernor::MAX_LEVELS; ++i) {
+        total += gov.getTimeIn(i);
+    }
+
+    EXPECT_EQ(total, last);
+    EXPECT(gov.getTimeIn(0) >= cfg.holdUs);
+    EXPECT(gov.getTimeIn(3) > 0);
+    EXPECT_EQ(gov.getTimeIn(KbdScanGovernor::MAX_LEVELS), 0);
+
+    gov.resetStats();
+    EXPECT_EQ(gov.getScans(), 0);
+    EXPECT_EQ(gov.getTimeIn(0), 0);
+}
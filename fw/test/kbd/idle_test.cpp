@@ -0,0 +1,179 @@
+#include "test.h"
+#include "kbd/idle.h"
+#include "board/config.h"
+#include "pico/stdlib.h"
+#include "hardware/gpio.h"
+
+// --> column levels seen by `gpio_get_all()`, rows are held high while armed.
+static uint32_t g_columns = 0;
+
+static uint32_t readColumns(uint32_t) {
+    return g_columns;
+}
+
+/* reset the GPIO and event stubs, the clock keeps running. */
+static void reset() {
+    g_columns = 0;
+    stub_gpio_in = readColumns;
+    stub_gpio_edges = stub_gpio_irqs = 0;
+    stub_irq = nullptr;
+
+    stub_event_consume();
+}
+
+/* a key pressed on column 3: the level rises, and so does an edge. */
+static void pressCol3() {
+    g_columns |= 1u << GPIO_KBD_COL_3;
+    stub_gpio_rise(GPIO_KBD_COL_3);
+}
+
+static uint32_t nowMs() {
+    return to_ms_since_boot(get_absolute_time());
+}
+
+TEST(idle_update_arms_after_timeout) {
+    KbdIdle idle;
+    const uint32_t now = nowMs();
+
+    reset();
+    EXPECT(idle.update(true, now) == false);
+    EXPECT(idle.update(false, now + KbdIdle::DEFAULT_TIMEOUT_MS - 1) == false);
+    EXPECT(idle.update(false, now + KbdIdle::DEFAULT_TIMEOUT_MS));
+
+    // --> zero disables idle scanning.
+    idle.setTimeout(0);
+    EXPECT(idle.update(false, now + 10 * KbdIdle::DEFAULT_TIMEOUT_MS) == false);
+}
+
+TEST(idle_arm_column_already_high) {
+    KbdIdle idle;
+
+    reset();
+
+    // --> held since before the rows went high: no edge will ever come.
+    g_columns = 1u << GPIO_KBD_COL_1;
+    EXPECT(idle.arm() == false);
+
+    EXPECT_EQ(idle.getState(), EKIS_ACTIVE);
+    EXPECT_EQ(stub_gpio_irqs, 0);
+}
+
+TEST(idle_press_before_arm_is_dropped) {
+    KbdIdle idle;
+
+    reset();
+
+    // --> pressed and released while scanning: a stale edge is latched.
+    stub_gpio_rise(GPIO_KBD_COL_2);
+    EXPECT(idle.arm());
+    EXPECT_EQ(idle.getState(), EKIS_ARMED);
+
+    // --> acknowledged on arming, so the sleep takes the whole tick.
+    const uint64_t begin = stub_time_us;
+    idle.sleepOnce();
+
+    EXPECT_EQ(stub_time_us - begin, KbdIdle::DEFAULT_TICK_MS * 1000ull);
+    EXPECT(idle.poll(nowMs()) == false);
+    EXPECT_EQ(idle.getWakes(), 0);
+}
+
+TEST(idle_wake_latency) {
+    static constexpr uint64_t PRESS_US = 3250;
+    KbdIdle idle;
+
+    reset();
+    EXPECT(idle.arm());
+
+    // --> pressed in the middle of the tick: woken at the edge.
+    const uint64_t begin = stub_time_us;
+    stub_irq_schedule(begin + PRESS_US, pressCol3);
+    idle.sleepOnce();
+
+    EXPECT_EQ(stub_time_us - begin, PRESS_US);
+    EXPECT_EQ(idle.getState(), EKIS_WOKEN);
+    EXPECT_EQ(stub_gpio_irqs, 0);
+
+    EXPECT(idle.poll(nowMs()));
+    EXPECT_EQ(idle.getWakes(), 1);
+}
+
+TEST(idle_edge_before_sleep_is_not_missed) {
+    KbdIdle idle;
+
+    reset();
+    EXPECT(idle.arm());
+
+    // --> the edge between arming and sleeping latches the event.
+    pressCol3();
+
+    const uint64_t begin = stub_time_us;
+    idle.sleepOnce();
+
+    EXPECT_EQ(stub_time_us, begin);
+    EXPECT(idle.poll(nowMs()));
+}
+
+TEST(idle_poll_states) {
+    KbdIdle idle;
+    const uint32_t now = nowMs();
+
+    reset();
+
+    // --> active: keep scanning, and nothing counted.
+    EXPECT(idle.poll(now));
+    EXPECT_EQ(idle.getWakes(), 0);
+
+    idle.update(false, now);
+    EXPECT(idle.arm());
+    EXPECT(idle.poll(now) == false);
+
+    // --> woken: scan again, counted once, and the timeout restarts.
+    idle.wake();
+    EXPECT_EQ(idle.getState(), EKIS_WOKEN);
+
+    const uint32_t woken = now + KbdIdle::DEFAULT_TIMEOUT_MS;
+    EXPECT(idle.poll(woken));
+    EXPECT_EQ(idle.getState(), EKIS_ACTIVE);
+    EXPECT_EQ(idle.getWakes(), 1);
+
+    EXPECT(idle.update(false, woken + 1) == false);
+    EXPECT(idle.poll(woken + 1));
+    EXPECT_EQ(idle.getWakes(), 1);
+
+    // --> waking an active scheduler does nothing.
+    idle.wake();
+    EXPECT_EQ(idle.getState(), EKIS_ACTIVE);
+}
+
+TEST(idle_sleep_only_armed) {
+    KbdIdle idle;
+
+    reset();
+
+    const uint64_t begin = stub_time_us;
+    idle.sleepOnce();
+    EXPECT_EQ(stub_time_us, begin);
+
+    // --> the tick bounds the sleep, so other core0 work keeps stepping.
+    idle.setTick(4);
+    EXPECT(idle.arm());
+
+    idle.sleepOnce();
+    EXPECT_EQ(stub_time_us - begin, 4000);
+}
+
+TEST(idle_sleep_capped) {
+    KbdIdle idle;
+
+    reset();
+    EXPECT(idle.arm());
+
+    // --> a nearer deadline cuts the sleep, never past the tick.
+    uint64_t begin = stub_time_us;
+    idle.sleepOnce(2500);
+    EXPECT_EQ(stub_time_us - begin, 2500);
+
+    begin = stub_time_us;
+    idle.sleepOnce(100 * 1000);
+    EXPECT_EQ(stub_time_us - begin, KbdIdle::DEFAULT_TICK_MS * 1000ull);
+}
@@ -0,0 +1,130 @@
+#include "test.h"
+#include "kbd/jitter.h"
+
+static constexpr uint32_t PERIOD_US = 1000;
+
+TEST(jitter_bucket_of) {
+    EXPECT_EQ(KbdJitter::bucketOf(0), 0);
+    EXPECT_EQ(KbdJitter::bucketOf(1), 1);
+    EXPECT_EQ(KbdJitter::bucketOf(7), 3);
+    EXPECT_EQ(KbdJitter::bucketOf(8), 4);
+    EXPECT_EQ(KbdJitter::bucketOf(UINT32_MAX), KbdJitter::MAX_BUCKETS - 1);
+}
+
+TEST(jitter_perfect_schedule) {
+    KbdJitter jitter;
+    SKbdJitter snap;
+
+    jitter.restart(PERIOD_US);
+
+    // --> the first tick is the origin, not measured.
+    for(uint32_t i = 0; i <= 100; ++i) {
+        jitter.onTick(5000 + i * PERIOD_US);
+    }
+
+    jitter.snapshot(snap);
+    EXPECT_EQ(snap.ticks, 100);
+    EXPECT_EQ(snap.hist[0], 100);
+    EXPECT_EQ(snap.maxLate, 0);
+    EXPECT_EQ(snap.maxEarly, 0);
+    EXPECT_EQ(snap.overruns, 0);
+}
+
+TEST(jitter_late_and_early) {
+    KbdJitter jitter;
+    SKbdJitter snap;
+
+    jitter.restart(PERIOD_US);
+    jitter.onTick(0);
+
+    // --> deviations are from the ideal, not from the previous tick.
+    jitter.onTick(1 * PERIOD_US + 30);
+    jitter.onTick(2 * PERIOD_US - 12);
+    jitter.onTick(3 * PERIOD_US);
+
+    jitter.snapshot(snap);
+    EXPECT_EQ(snap.ticks, 3);
+    EXPECT_EQ(snap.maxLate, 30);
+    EXPECT_EQ(snap.maxEarly, 12);
+    EXPECT_EQ(snap.hist[KbdJitter::bucketOf(30)], 1);
+    EXPECT_EQ(snap.hist[KbdJitter::bucketOf(12)], 1);
+    EXPECT_EQ(snap.hist[0], 1);
+}
+
+TEST(jitter_drift_accumulates) {
+    KbdJitter jitter;
+    SKbdJitter snap;
+
+    jitter.restart(PERIOD_US);
+
+    // --> a slow clock: every tick 1 us later than the last one.
+    for(uint32_t i = 0; i <= 50; ++i) {
+        jitter.onTick(i * (PERIOD_US + 1));
+    }
+
+    jitter.snapshot(snap);
+    EXPECT_EQ(snap.maxLate, 50);
+}
+
+TEST(jitter_overrun_resyncs) {
+    KbdJitter jitter;
+    SKbdJitter snap;
+
+    jitter.restart(PERIOD_US);
+    jitter.onTick(0);
+    jitter.onTick(PERIOD_US);
+
+    // --> a whole period skipped: counted once, then measured from it.
+    jitter.onTick(3 * PERIOD_US + 100);
+    jitter.onTick(4 * PERIOD_US + 100);
+    jitter.onTick(5 * PERIOD_US + 100);
+
+    jitter.snapshot(snap);
+    EXPECT_EQ(snap.overruns, 1);
+    EXPECT_EQ(snap.maxLate, PERIOD_US + 100);
+    EXPECT_EQ(snap.hist[0], 3);
+}
+
+TEST(jitter_wraps) {
+    KbdJitter jitter;
+    SKbdJitter snap;
+
+    jitter.restart(PERIOD_US);
+
+    // --> across the 32 bit wrap of `time_us_32`.
+    const uint32_t origin = UINT32_MAX - 2500;
+    for(uint32_t i = 0; i <= 5; ++i) {
+        jitter.onTick(origin + i * PERIOD_US + (i == 4 ? 7 : 0));
+    }
+
+    jitter.snapshot(snap);
+    EXPECT_EQ(snap.ticks, 5);
+    EXPECT_EQ(snap.maxLate, 7);
+    EXPECT_EQ(snap.maxEarly, 0);
+}
+
+TEST(jitter_restart_and_reset) {
+    KbdJitter jitter;
+    SKbdJitter snap;
+
+    jitter.restart(PERIOD_US);
+    jitter.onTick(0);
+    jitter.onTick(PERIOD_US + 40);
+
+    // --> restarting: the next tick is a new origin.
+    jitter.restart(PERIOD_US * 2);
+    jitter.onTick(123456);
+    jitter.onTick(123456 + PERIOD_US * 2);
+
+    jitter.snapshot(snap);
+    EXPECT_EQ(snap.ticks, 2);
+    EXPECT_EQ(snap.maxLate, 40);
+
+    // --> resetting keeps the schedule.
+    jitter.reset();
+    jitter.onTick(123456 + PERIOD_US * 4 + 3);
+
+    jitter.snapshot(snap);
+    EXPECT_EQ(snap.ticks, 1);
+    EXPECT_EQ(snap.maxLate, 3);
+}
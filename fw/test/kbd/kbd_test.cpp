@@ -0,0 +1,325 @@
+#include "test.h"
+#include "session.h"
+#include "kbd/debounce.h"
+#include "pico/stdlib.h"
+#include <chrono>
+#include <stdio.h>
+
+TEST(kbd_press_release) {
+    KbdSession session;
+    Kbd* kbd = Kbd::get();
+
+    session.scanner.press(EKEY_PLUS);
+    EXPECT(session.step());
+
+    EXPECT(kbd->checkKeyState(EKEY_PLUS, EKLS_RISE));
+    EXPECT(kbd->isKeyDown(EKEY_PLUS));
+    EXPECT_EQ(session.listener.count(EKEY_PLUS, EKLS_RISE), 1);
+
+    // --> the edge settles on the next dispatch.
+    session.step();
+    EXPECT(kbd->checkKeyState(EKEY_PLUS, EKLS_HIGH));
+
+    session.run(10);
+    session.scanner.release(EKEY_PLUS);
+    session.step();
+
+    EXPECT(kbd->checkKeyState(EKEY_PLUS, EKLS_FALL));
+    EXPECT(kbd->isKeyUp(EKEY_PLUS));
+    EXPECT_EQ(session.listener.count(EKEY_PLUS, EKLS_FALL), 1);
+
+    session.step();
+    EXPECT(kbd->checkKeyState(EKEY_PLUS, EKLS_LOW));
+}
+
+TEST(kbd_quiet_dispatch) {
+    KbdSession session;
+
+    // --> nothing pressed: no handler runs, nobody is notified.
+    EXPECT(session.run(10) == false);
+    EXPECT_EQ(session.listener.size(), 0);
+    EXPECT_EQ(session.listener.getPosts(), 0);
+}
+
+TEST(kbd_pressing_order) {
+    KbdSession session;
+    Kbd* kbd = Kbd::get();
+    EKey keys[EKEY_MAX];
+
+    session.scanner.press(EKEY_MINUS);
+    session.run(2);
+    session.scanner.press(EKEY_PLUS);
+    session.run(2);
+    session.scanner.press(EKEY_ENTER);
+    session.run(2);
+
+    // --> the latest press comes first.
+    EXPECT_EQ(kbd->getPressingKeys(keys, EKEY_MAX), 3);
+    EXPECT_EQ(keys[0], EKEY_ENTER);
+    EXPECT_EQ(keys[1], EKEY_PLUS);
+    EXPECT_EQ(keys[2], EKEY_MINUS);
+
+    EXPECT_EQ(kbd->getRecentKey(EKLS_HIGH), EKEY_ENTER);
+    EXPECT_EQ(kbd->getPressingKeys(keys, 2), 2);
+    EXPECT_EQ(kbd->getPressingKeys(nullptr, EKEY_MAX), 3);
+}
+
+TEST(kbd_same_scan_presses) {
+    KbdSession session;
+    Kbd* kbd = Kbd::get();
+
+    // --> keys of a scan are dispatched together, once each.
+    session.scanner.set((1u << EKEY_MINUS) | (1u << EKEY_PLUS));
+    EXPECT(session.step());
+
+    EXPECT_EQ(kbd->getPressingKeys(nullptr, EKEY_MAX), 2);
+    EXPECT_EQ(session.listener.count(EKEY_MINUS, EKLS_RISE), 1);
+    EXPECT_EQ(session.listener.count(EKEY_PLUS, EKLS_RISE), 1);
+    EXPECT_EQ(session.listener.getPosts(), 1);
+}
+
+TEST(kbd_hidden_keys) {
+    KbdSession session;
+    Kbd* kbd = Kbd::get();
+    EKey keys[EKEY_MAX];
+
+    session.scanner.set((1u << EKEY_MINUS) | (1u << EKEY_PLUS));
+    session.run(2);
+
+    // --> held back keys stay down, but aren't reported.
+    EXPECT(kbd->hideKey(EKEY_MINUS, true));
+    EXPECT(kbd->isKeyHidden(EKEY_MINUS));
+    EXPECT(kbd->isKeyDown(EKEY_MINUS));
+
+    EXPECT_EQ(kbd->getPressingKeys(keys, EKEY_MAX), 1);
+    EXPECT_EQ(keys[0], EKEY_PLUS);
+
+    EXPECT(kbd->hideKey(EKEY_MINUS, false));
+    EXPECT_EQ(kbd->getPressingKeys(keys, EKEY_MAX), 2);
+}
+
+TEST(kbd_masked_scanner) {
+    KbdSession session(1u << EKEY_PLUS);
+    Kbd* kbd = Kbd::get();
+
+    // --> keys outside the mask are left to other scanners.
+    session.scanner.set((1u << EKEY_MINUS) | (1u << EKEY_PLUS));
+    session.run(2);
+
+    EXPECT(kbd->isKeyDown(EKEY_PLUS));
+    EXPECT(kbd->isKeyDown(EKEY_MINUS) == false);
+}
+
+TEST(kbd_force_key_state) {
+    KbdSession session;
+    Kbd* kbd = Kbd::get();
+    EKey keys[EKEY_MAX];
+
+    session.scanner.press(EKEY_MINUS);
+    session.run(2);
+
+    // --> forced keys are placed first.
+    EXPECT(kbd->forceKeyState(EKEY_PLUS, EKLS_HIGH));
+    EXPECT_EQ(kbd->getPressingKeys(keys, EKEY_MAX), 2);
+    EXPECT_EQ(keys[0], EKEY_PLUS);
+    EXPECT_EQ(keys[1], EKEY_MINUS);
+
+    EXPECT(kbd->forceKeyState(EKEY_PLUS, EKLS_FALL));
+    EXPECT(kbd->forceKeyState(EKEY_MAX, EKLS_FALL) == false);
+
+    session.step();
+    EXPECT(kbd->checkKeyState(EKEY_PLUS, EKLS_LOW));
+}
+
+/**
+ * the per-key update before scanners reported bitmaps, kept to compare:
+ * every key asks every scanner, and the order set is bubble sorted.
+ */
+class LegacyScanner {
+private:
+    uint32_t _keys;
+    uint32_t _mask;
+
+public:
+    LegacyScanner(uint32_t mask) : _keys(0), _mask(mask) { }
+
+public:
+    void set(uint32_t keys) { _keys = keys & _mask; }
+
+    /* take the latest scanned state and return true if key presents. */
+    virtual bool takeState(EKey key, bool& nextOut) const {
+        if ((_mask & (1u << key)) == 0) {
+            nextOut = false;
+            return false;
+        }
+
+        nextOut = (_keys >> key) & 1;
+        return true;
+    }
+};
+
+struct LegacyKbd {
+    SKey keys[EKEY_MAX];
+    EKey orderedKeys[EKEY_MAX];
+    KbdDebouncer debouncer;
+
+    LegacyKbd() {
+        for(uint8_t i = 0; i < EKEY_MAX; ++i) {
+            keys[i] = { };
+            keys[i].order = i;
+            orderedKeys[i] = EKey(i);
+        }
+    }
+
+    static bool getState(LegacyScanner* const* scanners, uint32_t count, EKey key, bool& nextOut) {
+        for(uint32_t i = 0; i < count; ++i) {
+            if (scanners[i]->takeState(key, nextOut)) {
+                return true;
+            }
+        }
+
+        nextOut = false;
+        return false;
+    }
+
+    void updateOnce(LegacyScanner* const* scanners, uint32_t count, uint64_t nowUs) {
+        uint8_t order = 0, repos = 0;
+        EKey reorder[EKEY_MAX];
+
+        const uint32_t now = uint32_t(nowUs);
+
+        for(uint8_t index = 0; index < EKEY_MAX; ++index) {
+            const EKey defKey = EKey(index);
+            bool next = false;
+
+            if (getState(scanners, count, defKey, next) == false) {
+                reorder[repos++] = defKey;
+                continue;
+            }
+
+            next = debouncer.filter(defKey, next, now);
+
+            SKey* key = &keys[index];
+            const bool prev = key->ls == EKLS_RISE || key->ls == EKLS_HIGH;
+
+            if (index == EKEY_HIDDEN) {
+                continue;
+            }
+
+            if (prev == next) {
+                if (key->ls == EKLS_RISE) {
+                    key->ls = EKLS_HIGH;
+                }
+
+                else if (key->ls == EKLS_FALL) {
+                    key->ls = EKLS_LOW;
+                }
+
+                else {
+                    key->ht = EKHT_TRIGGERED;
+                    reorder[repos++] = defKey;
+                    continue;
+                }
+
+                key->ht = EKHT_PENDING;
+                key->order = order++;
+                orderedKeys[key->order] = defKey;
+                continue;
+            }
+
+            key->ht = EKHT_PENDING;
+            key->order = order++;
+            key->ms = uint32_t(nowUs / 1000);
+            key->ls = next ? EKLS_RISE : EKLS_FALL;
+            orderedKeys[key->order] = defKey;
+        }
+
+        for(uint8_t i = 0; i < repos; ++i) {
+            for(uint8_t j = 0; j < repos; ++j) {
+                const uint8_t left = keys[reorder[i]].order;
+                const uint8_t right = keys[reorder[j]].order;
+
+                if (left > right) {
+                    const EKey temp = reorder[i];
+                    reorder[i] = reorder[j];
+                    reorder[j] = temp;
+                }
+            }
+        }
+
+        const uint8_t offset = order;
+        for(; order < EKEY_MAX; ++order) {
+            const EKey key = reorder[order - offset];
+
+            keys[key].order = order;
+            orderedKeys[order] = key;
+        }
+    }
+};
+
+/* the raw keys of scan `i`: quiet, or a key pressed for 20 of every 40 scans. */
+static uint32_t benchKeys(uint32_t i, bool typing) {
+    static const EKey KEYS[] = { EKEY_NUM_1, EKEY_NUM_5, EKEY_PLUS, EKEY_ENTER };
+
+    if (typing == false || (i % 40) >= 20) {
+        return 0;
+    }
+
+    return 1u << KEYS[(i / 40) % 4];
+}
+
+/* ns per scan of the bitmap update, dispatch included. */
+static double benchBitmap(uint32_t count, bool typing) {
+    KbdSession session;
+    Kbd* kbd = Kbd::get();
+
+    const auto begin = std::chrono::steady_clock::now();
+
+    for(uint32_t i = 0; i < count; ++i) {
+        session.scanner.set(benchKeys(i, typing));
+        stub_time_us += 1000;
+
+        kbd->scanOnce();
+        kbd->dispatchOnce();
+    }
+
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - begin).count() / count;
+}
+
+/* ns per scan of the legacy update, no handlers run. */
+static double benchLegacy(uint32_t count, bool typing) {
+    static LegacyKbd legacy;
+    LegacyScanner matrix(KbdMatrix::KEY_MASK);
+    LegacyScanner test(KbdMatrix::KEY_MASK);
+    LegacyScanner* const scanners[] = { &test, &matrix };
+
+    const auto begin = std::chrono::steady_clock::now();
+
+    for(uint32_t i = 0; i < count; ++i) {
+        test.set(benchKeys(i, typing));
+        stub_time_us += 1000;
+
+        legacy.updateOnce(scanners, 2, stub_time_us);
+    }
+
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - begin).count() / count;
+}
+
+TEST(kbd_update_bench) {
+    static constexpr uint32_t COUNT = 200000;
+
+    for(uint32_t typing = 0; typing < 2; ++typing) {
+        const double legacy = benchLegacy(COUNT, typing);
+        const double bitmap = benchBitmap(COUNT, typing);
+
+        // --> a quiet matrix must be cheaper than visiting every key.
+        if (typing == false) {
+            EXPECT(bitmap < legacy);
+        }
+
+        printf("  %s: takeState %.1f ns/scan, bitmap %.1f ns/scan (x%.2f)\n",
+            typing ? "typing" : "quiet", legacy, bitmap, bitmap > 0 ? legacy / bitmap : 0.0);
+    }
+}
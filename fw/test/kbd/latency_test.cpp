@@ -0,0 +1,135 @@
+#include "test.h"
+#include "session.h"
+#include "kbd/latency.h"
+#include "pico/stdlib.h"
+
+TEST(latency_buckets) {
+    uint32_t errors = 0;
+    uint32_t prev = 0;
+
+    // --> exact below `SUB`, then within a quarter of the value.
+    for(uint32_t us = 0; us < (1u << 20); ++us) {
+        const uint32_t bucket = KbdLatency::bucketOf(us);
+        const uint32_t upper = KbdLatency::upperOf(bucket);
+
+        if (bucket < prev || upper < us || upper - us > us / KbdLatency::SUB) {
+            errors++;
+        }
+
+        if (bucket > 0 && KbdLatency::upperOf(bucket - 1) >= us) {
+            errors++;
+        }
+
+        prev = bucket;
+    }
+
+    EXPECT_EQ(errors, 0);
+    EXPECT_EQ(KbdLatency::bucketOf(3), 3);
+    EXPECT_EQ(KbdLatency::upperOf(KbdLatency::bucketOf(1000)), 1023);
+}
+
+TEST(latency_clamps) {
+    const uint32_t last = KbdLatency::MAX_BUCKETS - 1;
+
+    EXPECT_EQ(KbdLatency::bucketOf(1u << KbdLatency::MAX_EXP), last);
+    EXPECT_EQ(KbdLatency::bucketOf(UINT32_MAX), last);
+    EXPECT_EQ(KbdLatency::bucketOf((1u << KbdLatency::MAX_EXP) - 1), last);
+}
+
+TEST(latency_percentiles) {
+    KbdLatency* latency = KbdLatency::get();
+    SKbdLatency summary;
+
+    latency->reset();
+    for(uint32_t us = 1; us <= 1000; ++us) {
+        latency->record(EKLT_HID, us);
+    }
+
+    EXPECT(latency->query(EKLT_HID, summary));
+    EXPECT_EQ(summary.count, 1000);
+    EXPECT_EQ(summary.min, 1);
+    EXPECT_EQ(summary.max, 1000);
+
+    // --> the upper edge of the bucket, never beyond the maximum.
+    EXPECT(summary.p50 >= 500 && summary.p50 <= 500 + 500 / KbdLatency::SUB);
+    EXPECT(summary.p90 >= 900 && summary.p90 <= 1000);
+    EXPECT_EQ(summary.p99, 1000);
+
+    EXPECT(latency->query(EKLT_MAX_VALUE, summary) == false);
+    EXPECT_EQ(latency->percentile(EKLT_CHANGE, 500), 0);
+}
+
+TEST(latency_origin) {
+    KbdLatency* latency = KbdLatency::get();
+    SKbdLatency summary;
+
+    latency->reset();
+
+    // --> nothing dispatching: nothing recorded.
+    latency->recordFromOrigin(EKLT_HID, 5000);
+    latency->query(EKLT_HID, summary);
+    EXPECT_EQ(summary.count, 0);
+
+    latency->setOrigin(UINT32_MAX - 99);
+    latency->recordFromOrigin(EKLT_HID, 100);
+    latency->clearOrigin();
+
+    // --> measured across the 32 bit wrap.
+    latency->query(EKLT_HID, summary);
+    EXPECT_EQ(summary.count, 1);
+    EXPECT_EQ(summary.max, 200);
+}
+
+TEST(latency_kbd_stages) {
+    KbdSession session;
+    KbdLatency* latency = KbdLatency::get();
+    Kbd* kbd = Kbd::get();
+    SKbdLatency summary;
+
+    latency->reset();
+
+    // --> scanned 300 us after the sample, plus the matrix scan itself.
+    session.scanner.press(EKEY_PLUS);
+    stub_time_us += 300;
+    kbd->scanOnce();
+
+    stub_time_us += 700;
+    kbd->dispatchOnce();
+
+    latency->query(EKLT_CHANGE, summary);
+    const uint32_t changed = summary.max;
+
+    EXPECT_EQ(summary.count, 1);
+    EXPECT(changed >= 300 && changed < 1000);
+
+    // --> dispatched 700 us after the change.
+    latency->query(EKLT_DISPATCH, summary);
+    EXPECT_EQ(summary.count, 1);
+    EXPECT_EQ(summary.max, changed + 700);
+}
+
+TEST(latency_dispatch_after_hold) {
+    KbdSession session;
+    KbdLatency* latency = KbdLatency::get();
+    Kbd* kbd = Kbd::get();
+    SKbdLatency summary;
+
+    kbd->getTapHold()->setHold(EKEY_UFN_1, 0x02, 200);
+    latency->reset();
+
+    // --> held back by the resolver: not dispatched yet.
+    session.scanner.press(EKEY_UFN_1);
+    session.run(50);
+
+    latency->query(EKLT_DISPATCH, summary);
+    EXPECT_EQ(summary.count, 0);
+
+    // --> dispatched once resolved as a hold, measured from its sample.
+    session.run(200);
+
+    latency->query(EKLT_DISPATCH, summary);
+    EXPECT_EQ(summary.count, 1);
+    EXPECT(summary.max >= 200000);
+
+    kbd->getTapHold()->setHold(EKEY_UFN_1, 0, 0);
+}
@@ -0,0 +1,212 @@
+#include "test.h"
+#include "session.h"
+#include "kbd/layers.h"
+#include "kbd/scancode.h"
+#include "kbd/handlers/layer.h"
+
+TEST(layers_tables) {
+    EXPECT(KbdLayers::getLayer(EKLY_MAX) == nullptr);
+    EXPECT_EQ(KbdLayers::getLayer(EKLY_NAV)->keys[EKEY_NUM_7].kc, KC_HOME);
+    EXPECT_EQ(KbdLayers::getDefaultKeyChar(EKEY_DOT).kc, KC_KEYPAD_DECIMAL);
+
+    // --> unbound: unmapped on the base layer, transparent above it.
+    EXPECT_EQ(KbdLayers::getDefaultKeyChar(EKEY_HIDDEN).kc, KC_NONE);
+    EXPECT_EQ(KbdLayers::getLayer(EKLY_NAV)->keys[EKEY_NUM_5].kc, KC_TRNS);
+    EXPECT_EQ(KbdLayers::getDefaultKeyChar(EKEY_MAX).kc, 0);
+}
+
+TEST(layers_activation) {
+    KbdLayers layers;
+
+    EXPECT_EQ(layers.getActive(), 1u << EKLY_BASE);
+    EXPECT(layers.isActive(EKLY_BASE));
+
+    EXPECT(layers.activate(EKLY_NAV));
+    EXPECT(layers.isActive(EKLY_NAV));
+    EXPECT(layers.toggle(EKLY_NAV));
+    EXPECT(layers.isActive(EKLY_NAV) == false);
+
+    // --> the base layer stays, whatever is asked.
+    EXPECT(layers.deactivate(EKLY_BASE) == false);
+    EXPECT(layers.toggle(EKLY_BASE) == false);
+    EXPECT(layers.isActive(EKLY_BASE));
+
+    EXPECT(layers.activate(EKLY_MAX) == false);
+    EXPECT(layers.deactivate(EKLY_INVALID) == false);
+    EXPECT(layers.isActive(EKLY_MAX) == false);
+}
+
+TEST(layers_resolve_order) {
+    KbdLayers layers;
+
+    EXPECT_EQ(layers.resolve(EKEY_NUM_7), EKLY_BASE);
+
+    // --> the highest active layer defining the key wins.
+    layers.activate(EKLY_NAV);
+    EXPECT_EQ(layers.resolve(EKEY_NUM_7), EKLY_NAV);
+    EXPECT_EQ(layers.resolve(EKEY_DOT), EKLY_NAV);
+
+    // --> transparent keys fall through to the base layer.
+    EXPECT_EQ(layers.resolve(EKEY_NUM_5), EKLY_BASE);
+    EXPECT_EQ(layers.resolve(EKEY_PLUS), EKLY_BASE);
+    EXPECT_EQ(layers.resolve(EKEY_HIDDEN), EKLY_BASE);
+    EXPECT_EQ(layers.resolve(EKEY_MAX), EKLY_BASE);
+
+    layers.deactivate(EKLY_NAV);
+    EXPECT_EQ(layers.resolve(EKEY_NUM_7), EKLY_BASE);
+}
+
+TEST(layers_kbd_key_char_order) {
+    KbdSession session;
+    Kbd* kbd = Kbd::get();
+    KbdLayers* layers = kbd->getLayers();
+    const SKeyChar edited = { 'x', 'x', KC_KEYPAD_9, 0 };
+    const SKeyChar over = { 'y', 'y', KC_KEYPAD_1, 0 };
+
+    // --> the base layer is the editable key configuration.
+    kbd->setKeyChar(EKEY_NUM_7, edited);
+    kbd->setKeyChar(EKEY_NUM_5, edited);
+    EXPECT_EQ(kbd->getKeyChar(EKEY_NUM_7).kc, KC_KEYPAD_9);
+
+    // --> higher layers win over it, transparent keys don't.
+    layers->activate(EKLY_NAV);
+    EXPECT_EQ(kbd->getKeyChar(EKEY_NUM_7).kc, KC_HOME);
+    EXPECT_EQ(kbd->getKeyChar(EKEY_NUM_5).kc, KC_KEYPAD_9);
+
+    // --> overrides of handlers win over keymaps.
+    kbd->overrideKeyChar(EKEY_NUM_7, &over);
+    EXPECT_EQ(kbd->getKeyChar(EKEY_NUM_7).kc, KC_KEYPAD_1);
+
+    kbd->overrideKeyChar(EKEY_NUM_7, nullptr);
+    EXPECT_EQ(kbd->getKeyChar(EKEY_NUM_7).kc, KC_HOME);
+
+    layers->deactivate(EKLY_NAV);
+    kbd->resetKeyChars();
+    EXPECT_EQ(kbd->getKeyChar(EKEY_NUM_7).kc, KC_KEYPAD_7);
+}
+
+TEST(layers_kbd_momentary) {
+    KbdSession session;
+    Kbd* kbd = Kbd::get();
+    KbdLayers* layers = kbd->getLayers();
+    KbdLayerHandler* handler = KbdLayerHandler::instance();
+
+    EXPECT(handler->setAction(EKEY_UFN_1, EKLA_MOMENTARY, EKLY_BASE) == false);
+    EXPECT(handler->setAction(EKEY_UFN_1, EKLA_MOMENTARY, EKLY_NAV));
+    EXPECT(handler->setAction(EKEY_UFN_2, EKLA_MOMENTARY, EKLY_NAV));
+    EXPECT_EQ(handler->getActionLayer(EKEY_UFN_1), EKLY_NAV);
+
+    session.scanner.press(EKEY_UFN_1);
+    session.run(10);
+    EXPECT(layers->isActive(EKLY_NAV));
+    EXPECT_EQ(kbd->getKeyChar(EKEY_NUM_8).kc, KC_ARROW_UP);
+
+    // --> held by another key: stays until the last one is released.
+    session.scanner.press(EKEY_UFN_2);
+    session.run(10);
+    session.scanner.release(EKEY_UFN_1);
+    session.run(10);
+    EXPECT(layers->isActive(EKLY_NAV));
+
+    session.scanner.release(EKEY_UFN_2);
+    session.run(10);
+    EXPECT(layers->isActive(EKLY_NAV) == false);
+    EXPECT_EQ(kbd->getKeyChar(EKEY_NUM_8).kc, KC_KEYPAD_8);
+
+    handler->setAction(EKEY_UFN_1, EKLA_NONE, EKLY_INVALID);
+    handler->setAction(EKEY_UFN_2, EKLA_NONE, EKLY_INVALID);
+}
+
+TEST(layers_kbd_toggle) {
+    KbdSession session;
+    KbdLayers* layers = Kbd::get()->getLayers();
+    KbdLayerHandler* handler = KbdLayerHandler::instance();
+
+    handler->setAction(EKEY_UFN_1, EKLA_TOGGLE, EKLY_NAV);
+
+    // --> toggled on every press, releases don't matter.
+    session.scanner.press(EKEY_UFN_1);
+    session.run(10);
+    session.scanner.release(EKEY_UFN_1);
+    session.run(10);
+    EXPECT(layers->isActive(EKLY_NAV));
+
+    session.scanner.press(EKEY_UFN_1);
+    session.run(10);
+    session.scanner.release(EKEY_UFN_1);
+    session.run(10);
+    EXPECT(layers->isActive(EKLY_NAV) == false);
+
+    handler->setAction(EKEY_UFN_1, EKLA_NONE, EKLY_INVALID);
+}
+
+TEST(layers_kbd_dual_key_taps_dont_switch) {
+    KbdSession session;
+    Kbd* kbd = Kbd::get();
+    KbdLayers* layers = kbd->getLayers();
+    KbdLayerHandler* handler = KbdLayerHandler::instance();
+
+    kbd->getTapHold()->setHold(EKEY_UFN_1, 0, 200);
+    handler->setAction(EKEY_UFN_1, EKLA_MOMENTARY, EKLY_NAV);
+
+    // --> tapped: its own key, no layer.
+    session.scanner.press(EKEY_UFN_1);
+    session.run(50);
+    session.scanner.release(EKEY_UFN_1);
+    session.run(20);
+    EXPECT(layers->isActive(EKLY_NAV) == false);
+    EXPECT_EQ(session.listener.count(EKEY_UFN_1, EKLS_RISE), 1);
+
+    // --> held: the layer, while held.
+    session.scanner.press(EKEY_UFN_1);
+    session.run(250);
+    EXPECT(layers->isActive(EKLY_NAV));
+
+    session.scanner.release(EKEY_UFN_1);
+    session.run(20);
+    EXPECT(layers->isActive(EKLY_NAV) == false);
+
+    handler->setAction(EKEY_UFN_1, EKLA_NONE, EKLY_INVALID);
+    kbd->getTapHold()->setHold(EKEY_UFN_1, 0, 0);
+}
+
+TEST(layers_kbd_key_char_latched) {
+    KbdSession session;
+    Kbd* kbd = Kbd::get();
+    KbdLayers* layers = kbd->getLayers();
+    KbdLayerHandler* handler = KbdLayerHandler::instance();
+
+    kbd->getTapHold()->setHold(EKEY_UFN_1, 0, 200);
+    handler->setAction(EKEY_UFN_1, EKLA_MOMENTARY, EKLY_NAV);
+
+    // --> pressed on the layer: stays there after the layer key is released.
+    session.scanner.press(EKEY_UFN_1);
+    session.run(250);
+    session.scanner.press(EKEY_NUM_7);
+    session.run(20);
+    EXPECT_EQ(kbd->getKeyChar(EKEY_NUM_7).kc, KC_HOME);
+
+    session.scanner.release(EKEY_UFN_1);
+    session.run(20);
+    EXPECT(layers->isActive(EKLY_NAV) == false);
+    EXPECT_EQ(kbd->getKeyChar(EKEY_NUM_7).kc, KC_HOME);
+
+    session.scanner.release(EKEY_NUM_7);
+    session.run(20);
+    EXPECT_EQ(kbd->getKeyChar(EKEY_NUM_7).kc, KbdLayers::getDefaultKeyChar(EKEY_NUM_7).kc);
+
+    // --> pressed on the base layer: stays there after the layer is activated.
+    session.scanner.press(EKEY_NUM_7);
+    session.run(20);
+    session.scanner.press(EKEY_UFN_1);
+    session.run(250);
+    EXPECT(layers->isActive(EKLY_NAV));
+    EXPECT_EQ(kbd->getKeyChar(EKEY_NUM_7).kc, KbdLayers::getDefaultKeyChar(EKEY_NUM_7).kc);
+
+    session.scanner.release(EKEY_NUM_7);
+    session.scanner.release(EKEY_UFN_1);
+    session.run(20);
+
+    handler->setAction(EKEY_UFN_1, EKLA_NONE, EKLY_INVALID);
+    kbd->getTapHold()->setHold(EKEY_UFN_1, 0, 0);
+}
@@ -0,0 +1,292 @@
+#include "test.h"
+#include "kbd/macro.h"
+
+/**
+ * macro clock set by tests.
+ */
+class TestMacroClock : public IKbdMacroClock {
+public:
+    uint32_t now;
+
+public:
+    TestMacroClock() : now(0) { }
+
+public:
+    virtual uint32_t getTime() const override { return now; }
+};
+
+/**
+ * macro sink that records edges, with a room limit.
+ */
+class TestMacroSink : public IKbdMacroSink {
+public:
+    static constexpr uint32_t MAX_EDGES = 64;
+
+    struct SEdge {
+        uint8_t key;
+        uint8_t state;
+        uint32_t us;
+    };
+
+public:
+    SEdge edges[MAX_EDGES];
+    uint32_t count;
+    uint32_t room;
+    uint32_t scheduled;
+
+public:
+    TestMacroSink() : count(0), room(MAX_EDGES), scheduled(0) { }
+
+public:
+    virtual bool inject(uint8_t key, uint8_t state, uint32_t now) override {
+        if (room == 0 || count >= MAX_EDGES) {
+            return false;
+        }
+
+        edges[count++] = { key, state, now };
+        room--;
+        return true;
+    }
+
+    virtual void schedule(uint32_t us) override { scheduled = us; }
+};
+
+/* append a step. */
+static bool append(KbdMacro& macro, uint32_t delay, EKey key, EKeyState state) {
+    const SMacroStep step = { delay, uint8_t(key), uint8_t(state) };
+    return macro.append(step);
+}
+
+/* tick the player whenever it asked, until `until` (us). */
+static void tickUntil(KbdMacroPlayer& player, TestMacroClock& clock, TestMacroSink& sink, uint32_t until) {
+    while(player.getState() != EKMS_IDLE && int32_t(until - sink.scheduled) >= 0) {
+        clock.now = sink.scheduled;
+        player.onTick(clock.now);
+    }
+
+    clock.now = until;
+}
+
+TEST(macro_codec_round_trip) {
+    static KbdMacro macro;
+    static const uint32_t DELAYS[] = { 0, 1, 2, 127, 255, 256, 1000, 0xfffe, 0xffff };
+    SMacroStep step;
+
+    for(const uint32_t delay : DELAYS) {
+        for(uint32_t key = 0; key < EKEY_MAX; ++key) {
+            EXPECT(append(macro, delay, EKey(key), (key & 1) ? EKLS_RISE : EKLS_FALL));
+        }
+    }
+
+    uint32_t offset = 0;
+    uint32_t errors = 0;
+
+    for(const uint32_t delay : DELAYS) {
+        for(uint32_t key = 0; key < EKEY_MAX; ++key) {
+            offset = macro.decode(offset, step);
+
+            if (offset == 0 || step.delay != delay || step.key != key ||
+                step.state != ((key & 1) ? EKLS_RISE : EKLS_FALL))
+            {
+                errors++;
+            }
+        }
+    }
+
+    EXPECT_EQ(errors, 0);
+    EXPECT_EQ(offset, macro.size());
+    EXPECT_EQ(macro.getSteps(), EKEY_MAX * (sizeof(DELAYS) / sizeof(DELAYS[0])));
+    EXPECT_EQ(macro.decode(offset, step), 0);
+}
+
+TEST(macro_codec_sizes) {
+    KbdMacro macro;
+
+    // --> within 2 ms: a byte, within a quarter second: two.
+    append(macro, 1, EKEY_HIDDEN, EKLS_RISE);
+    EXPECT_EQ(macro.size(), 1);
+
+    append(macro, 255, EKEY_HIDDEN, EKLS_RISE);
+    EXPECT_EQ(macro.size(), 3);
+
+    append(macro, 256, EKEY_NUM_0, EKLS_FALL);
+    EXPECT_EQ(macro.size(), 6);
+
+    macro.clear();
+    append(macro, KbdMacro::MAX_DELAY_MS, EKEY_HIDDEN, EKLS_RISE);
+    EXPECT_EQ(macro.size(), KbdMacro::MAX_STEP_BYTES);
+}
+
+TEST(macro_codec_clamps_delays) {
+    KbdMacro macro;
+    SMacroStep step;
+
+    // --> a longer pause plays as the longest one.
+    append(macro, 0xffffffffu, EKEY_MPLAY, EKLS_RISE);
+    append(macro, KbdMacro::MAX_DELAY_MS + 1, EKEY_NUM_1, EKLS_FALL);
+    EXPECT_EQ(macro.size(), 2 * KbdMacro::MAX_STEP_BYTES);
+
+    uint32_t offset = macro.decode(0, step);
+    EXPECT_EQ(step.delay, KbdMacro::MAX_DELAY_MS);
+    EXPECT_EQ(step.key, EKEY_MPLAY);
+
+    offset = macro.decode(offset, step);
+    EXPECT_EQ(step.delay, KbdMacro::MAX_DELAY_MS);
+    EXPECT_EQ(step.key, EKEY_NUM_1);
+    EXPECT_EQ(offset, macro.size());
+}
+
+TEST(macro_codec_limits) {
+    static KbdMacro macro;
+    SMacroStep step;
+
+    EXPECT(append(macro, 0, EKEY_MAX, EKLS_RISE) == false);
+    EXPECT(macro.isEmpty());
+    EXPECT_EQ(macro.decode(0, step), 0);
+
+    // --> full: nothing partial is written.
+    while(append(macro, 0, EKEY_NUM_1, EKLS_RISE));
+    EXPECT_EQ(macro.size(), KbdMacro::MAX_BYTES);
+
+    macro.clear();
+    for(uint32_t i = 0; i < KbdMacro::MAX_BYTES / 3; ++i) {
+        append(macro, 256, EKEY_NUM_1, EKLS_RISE);
+    }
+
+    const uint32_t size = macro.size();
+    EXPECT(append(macro, KbdMacro::MAX_DELAY_MS, EKEY_NUM_1, EKLS_RISE) == false);
+    EXPECT_EQ(macro.size(), size);
+    EXPECT_EQ(macro.getSteps(), KbdMacro::MAX_BYTES / 3);
+}
+
+TEST(macro_player_original_timing) {
+    KbdMacro macro;
+    TestMacroClock clock;
+    TestMacroSink sink;
+    KbdMacroPlayer player(&macro, &clock, &sink);
+
+    append(macro, 0, EKEY_NUM_1, EKLS_RISE);
+    append(macro, 100, EKEY_NUM_1, EKLS_FALL);
+    append(macro, 50, EKEY_NUM_2, EKLS_RISE);
+    append(macro, 50, EKEY_NUM_2, EKLS_FALL);
+
+    clock.now = 1000;
+    EXPECT(player.play(EKMM_ORIGINAL));
+    EXPECT(player.play(EKMM_ORIGINAL) == false);
+    EXPECT_EQ(sink.scheduled, 1000);
+
+    player.onTick(1000);
+    EXPECT_EQ(sink.count, 1);
+    EXPECT_EQ(sink.scheduled, 1000 + 100000);
+
+    // --> ticked late: later steps keep the recorded timing.
+    player.onTick(1000 + 100000 + 30000);
+    EXPECT_EQ(sink.count, 2);
+    EXPECT_EQ(sink.scheduled, 1000 + 150000);
+
+    tickUntil(player, clock, sink, 1000 + 200000);
+    EXPECT_EQ(sink.count, 4);
+    EXPECT_EQ(sink.edges[3].us, 1000 + 200000);
+    EXPECT_EQ(player.getState(), EKMS_IDLE);
+    EXPECT_EQ(player.getDownKeys(), 0);
+}
+
+TEST(macro_player_fast) {
+    KbdMacro macro;
+    TestMacroClock clock;
+    TestMacroSink sink;
+    KbdMacroPlayer player(&macro, &clock, &sink);
+
+    append(macro, 0, EKEY_NUM_1, EKLS_RISE);
+    append(macro, 10000, EKEY_NUM_1, EKLS_FALL);
+    append(macro, 10000, EKEY_NUM_2, EKLS_RISE);
+
+    // --> a step per HID polling interval, whatever was recorded.
+    EXPECT(player.play(EKMM_FAST));
+    EXPECT_EQ(player.getMode(), EKMM_FAST);
+    tickUntil(player, clock, sink, 1000000);
+
+    EXPECT_EQ(sink.count, 4);
+    EXPECT_EQ(sink.edges[1].us, KbdMacroPlayer::FAST_STEP_US);
+    EXPECT_EQ(sink.edges[2].us, 2 * KbdMacroPlayer::FAST_STEP_US);
+
+    // --> left pressed by the macro: released when it ends.
+    EXPECT(sink.edges[3].key == EKEY_NUM_2 && sink.edges[3].state == EKLS_FALL);
+    EXPECT_EQ(player.getState(), EKMS_IDLE);
+}
+
+TEST(macro_player_retries_without_room) {
+    KbdMacro macro;
+    TestMacroClock clock;
+    TestMacroSink sink;
+    KbdMacroPlayer player(&macro, &clock, &sink);
+
+    append(macro, 0, EKEY_NUM_1, EKLS_RISE);
+    append(macro, 0, EKEY_NUM_1, EKLS_FALL);
+
+    sink.room = 0;
+    player.play(EKMM_ORIGINAL);
+    player.onTick(0);
+
+    // --> no room: retried on the next HID polling interval.
+    EXPECT_EQ(sink.count, 0);
+    EXPECT_EQ(sink.scheduled, KbdMacroPlayer::FAST_STEP_US);
+
+    sink.room = TestMacroSink::MAX_EDGES;
+    player.onTick(KbdMacroPlayer::FAST_STEP_US);
+    EXPECT_EQ(sink.count, 2);
+    EXPECT_EQ(player.getState(), EKMS_IDLE);
+}
+
+TEST(macro_player_stop_releases) {
+    KbdMacro macro;
+    TestMacroClock clock;
+    TestMacroSink sink;
+    KbdMacroPlayer player(&macro, &clock, &sink);
+
+    append(macro, 0, EKEY_NUM_1, EKLS_RISE);
+    append(macro, 0, EKEY_NUM_2, EKLS_RISE);
+    append(macro, 1000, EKEY_NUM_1, EKLS_FALL);
+
+    player.play(EKMM_ORIGINAL);
+    player.onTick(0);
+    EXPECT_EQ(player.getDownKeys(), (1u << EKEY_NUM_1) | (1u << EKEY_NUM_2));
+
+    // --> no room for both releases: stopping, retried until taken.
+    sink.room = 1;
+    clock.now = 500;
+    player.stop();
+
+    EXPECT_EQ(player.getState(), EKMS_STOPPING);
+    EXPECT_EQ(sink.scheduled, 500 + KbdMacroPlayer::FAST_STEP_US);
+    EXPECT_EQ(player.getDownKeys(), 1u << EKEY_NUM_2);
+    EXPECT(player.play(EKMM_ORIGINAL) == false);
+
+    player.onTick(sink.scheduled);
+    EXPECT_EQ(player.getState(), EKMS_STOPPING);
+
+    sink.room = 1;
+    clock.now = sink.scheduled;
+    player.onTick(clock.now);
+
+    EXPECT_EQ(player.getState(), EKMS_IDLE);
+    EXPECT_EQ(player.getDownKeys(), 0);
+    EXPECT(sink.edges[sink.count - 1].key == EKEY_NUM_2 && sink.edges[sink.count - 1].state == EKLS_FALL);
+}
+
+TEST(macro_player_refuses) {
+    KbdMacro macro;
+    TestMacroClock clock;
+    TestMacroSink sink;
+    KbdMacroPlayer player(&macro, &clock, &sink);
+
+    EXPECT(player.play(EKMM_ORIGINAL) == false);
+
+    append(macro, 0, EKEY_NUM_1, EKLS_RISE);
+    EXPECT(player.play(EKMM_MAX_VALUE) == false);
+    EXPECT_EQ(player.getState(), EKMS_IDLE);
+
+    // --> stopping an idle player does nothing.
+    player.stop();
+    EXPECT_EQ(sink.count, 0);
+}
@@ -0,0 +1,79 @@
+#include "test.h"
+#include "kbd/scanners/matrix.h"
+
+/* build a PIO sample with only the key's switch closed. */
+static uint32_t sampleOf(EKey key) {
+    const uint32_t row = KbdMatrix::rowOf(key);
+    const uint32_t col = KbdMatrix::colOf(key);
+
+    // --> row 0 at the top, each row from `COL_5` (column 4) up to `COL_1`.
+    const uint32_t shift = (KbdMatrix::MAX_ROWS - 1 - row) * KbdMatrix::MAX_COLS;
+    return 1u << (shift + (KbdMatrix::MAX_COLS - 1 - col));
+}
+
+TEST(matrix_key_mask) {
+    EXPECT_EQ(KbdMatrix::KEY_MASK, 0x1ffffffu & ~(1u << EKEY_HIDDEN));
+
+    EXPECT(KbdMatrix::isWired(EKEY_UFN_1));
+    EXPECT(KbdMatrix::isWired(EKEY_HIDDEN) == false);
+    EXPECT(KbdMatrix::isWired(EKEY_MAX) == false);
+    EXPECT(KbdMatrix::isWired(EKEY_INV) == false);
+}
+
+TEST(matrix_row_col_round_trip) {
+    for(uint8_t i = 0; i < EKEY_MAX; ++i) {
+        const EKey key = EKey(i);
+        EXPECT_EQ(KbdMatrix::keyOf(KbdMatrix::rowOf(key), KbdMatrix::colOf(key)), key);
+    }
+
+    EXPECT_EQ(KbdMatrix::keyOf(0, 0), EKEY_UFN_1);
+    EXPECT_EQ(KbdMatrix::keyOf(1, 4), EKEY_PLUS);
+    EXPECT_EQ(KbdMatrix::keyOf(2, 2), EKEY_NUM_5);
+}
+
+TEST(matrix_pack) {
+    uint8_t rows[KbdMatrix::MAX_ROWS] = { 0, };
+
+    EXPECT_EQ(KbdMatrix::pack(rows), 0);
+
+    // --> bit N of a row is column N, upper bits are ignored.
+    rows[0] = 0x01;
+    rows[2] = 0x04 | 0xe0;
+    EXPECT_EQ(KbdMatrix::pack(rows), (1u << EKEY_UFN_1) | (1u << EKEY_NUM_5));
+
+    // --> the hidden position never shows.
+    for(uint32_t i = 0; i < KbdMatrix::MAX_ROWS; ++i) {
+        rows[i] = 0x1f;
+    }
+
+    EXPECT_EQ(KbdMatrix::pack(rows), KbdMatrix::KEY_MASK);
+}
+
+TEST(matrix_from_sample) {
+    for(uint8_t i = 0; i < EKEY_MAX; ++i) {
+        const EKey key = EKey(i);
+        const uint32_t expect = KbdMatrix::isWired(key) ? (1u << key) : 0;
+
+        EXPECT_EQ(KbdMatrix::fromSample(sampleOf(key)), expect);
+    }
+
+    // --> the corners, as the PIO program shifts them in.
+    EXPECT_EQ(KbdMatrix::fromSample(1u << 24), 1u << EKEY_UFN_1);
+    EXPECT_EQ(KbdMatrix::fromSample(1u << 20), 1u << EKEY_NUMLOCK);
+    EXPECT_EQ(KbdMatrix::fromSample(1u << 4), 1u << KbdMatrix::keyOf(4, 0));
+    EXPECT_EQ(KbdMatrix::fromSample(1u << 0), 1u << KbdMatrix::keyOf(4, 4));
+
+    EXPECT_EQ(KbdMatrix::fromSample(0x1ffffff), KbdMatrix::KEY_MASK);
+    EXPECT_EQ(KbdMatrix::fromSample(0), 0);
+}
+
+TEST(matrix_changes) {
+    const uint32_t prev = (1u << EKEY_NUM_1) | (1u << EKEY_NUM_2);
+    const uint32_t next = (1u << EKEY_NUM_2) | (1u << EKEY_NUM_3) | (1u << EKEY_HIDDEN);
+
+    EXPECT_EQ(KbdMatrix::changes(prev, next), (1u << EKEY_NUM_1) | (1u << EKEY_NUM_3));
+    EXPECT_EQ(KbdMatrix::changes(prev, prev), 0);
+
+    EXPECT(KbdMatrix::test(next, EKEY_NUM_3));
+    EXPECT(KbdMatrix::test(next, EKEY_NUM_1) == false);
+}
@@ -0,0 +1,170 @@
+#include "test.h"
+#include "kbd/kbd.h"
+#include "kbd/pacer.h"
+#include "kbd/scanners/basic.h"
+#include "board/config.h"
+#include "pico/stdlib.h"
+#include "hardware/gpio.h"
+
+// --> a key at row 1 and column 1 of the simulated matrix.
+static bool g_down = false;
+
+static uint32_t readMatrix(uint32_t out) {
+    return g_down && (out & (1u << GPIO_KBD_ROW_1)) ? 1u << GPIO_KBD_COL_1 : 0;
+}
+
+/* the keyboard scanned by the pacer alone, idle after `timeout` ms. */
+static Kbd* prepare(uint32_t timeout) {
+    Kbd* kbd = Kbd::get();
+
+    g_down = false;
+    stub_gpio_in = readMatrix;
+
+    // --> left armed by an earlier test: resumed on the first scan.
+    kbd->getIdle()->wake();
+    kbd->getIdle()->setTimeout(timeout);
+    kbd->enable();
+    return kbd;
+}
+
+/* run the alarm for `us`, stepping the main loop every millisecond. */
+static void run(uint64_t us) {
+    KbdScanPacer* pacer = KbdScanPacer::get();
+    const uint64_t until = stub_time_us + us;
+
+    while (stub_time_us < until) {
+        stub_alarm_advance(stub_time_us + 1000 < until ? stub_time_us + 1000 : until);
+
+        pacer->stepOnce();
+        Kbd::get()->dispatchOnce();
+    }
+}
+
+/* count the ticks of the pacer in `us`. */
+static uint32_t ticksIn(uint64_t us) {
+    KbdJitter* jitter = KbdScanPacer::get()->getJitter();
+    SKbdJitter before, after;
+
+    jitter->snapshot(before);
+    run(us);
+
+    jitter->snapshot(after);
+    return after.ticks - before.ticks;
+}
+
+TEST(pacer_fixed_period) {
+    KbdScanPacer* pacer = KbdScanPacer::get();
+    KbdScanGovernor* governor = pacer->getGovernor();
+    SKbdJitter snap;
+
+    prepare(0);
+    pacer->setGovernor(nullptr);
+    pacer->getJitter()->reset();
+
+    EXPECT(pacer->start(500));
+    EXPECT(pacer->start(500) == false);
+    EXPECT(pacer->isRunning());
+
+    // --> the first tick is the origin of the jitter schedule.
+    run(10000);
+    pacer->stop();
+
+    pacer->getJitter()->snapshot(snap);
+    EXPECT_EQ(snap.ticks, 19);
+    EXPECT_EQ(snap.overruns, 0);
+    EXPECT(snap.maxLate < 500);
+
+    EXPECT(stub_alarm == nullptr);
+    pacer->setGovernor(governor);
+}
+
+TEST(pacer_follows_governor) {
+    KbdScanPacer* pacer = KbdScanPacer::get();
+    KbdScanGovernor* governor = KbdBasicScanner::instance()->getGovernor();
+
+    prepare(0);
+    EXPECT(pacer->getGovernor() == governor);
+
+    EXPECT(pacer->start());
+    EXPECT_EQ(pacer->getPeriod(), governor->getPeriod());
+
+    // --> nothing held: decays to the slow rate, and the alarm with it.
+    run(200000);
+    EXPECT_EQ(governor->getPeriod(), KbdScanGovernor::DEFAULT_SLOW_US);
+    EXPECT_EQ(pacer->getPeriod(), KbdScanGovernor::DEFAULT_SLOW_US);
+    EXPECT_EQ(ticksIn(10000), 10);
+
+    // --> a held key: back to the fast rate from the next tick.
+    g_down = true;
+    run(2000);
+
+    EXPECT_EQ(pacer->getPeriod(), KbdScanGovernor::DEFAULT_FAST_US);
+    EXPECT_EQ(ticksIn(10000), 10000 / KbdScanGovernor::DEFAULT_FAST_US);
+
+    g_down = false;
+    run(200000);
+    EXPECT_EQ(pacer->getPeriod(), KbdScanGovernor::DEFAULT_SLOW_US);
+
+    pacer->stop();
+}
+
+TEST(pacer_parks_and_resumes) {
+    KbdScanPacer* pacer = KbdScanPacer::get();
+    Kbd* kbd = prepare(5);
+
+    EXPECT(pacer->start());
+
+    // --> idle after the timeout: the rows are held and the alarm parks.
+    run(20000);
+    EXPECT_EQ(kbd->getIdle()->getState(), EKIS_ARMED);
+    EXPECT(pacer->isRunning() == false);
+    EXPECT(stub_alarm == nullptr);
+    EXPECT_EQ(ticksIn(50000), 0);
+
+    // --> a press raises the column: the main loop resumes the alarm.
+    g_down = true;
+    stub_gpio_rise(GPIO_KBD_COL_1);
+    EXPECT_EQ(kbd->getIdle()->getState(), EKIS_WOKEN);
+
+    pacer->stepOnce();
+    EXPECT(pacer->isRunning());
+    EXPECT(ticksIn(10000) > 0);
+
+    EXPECT_EQ(kbd->getIdle()->getState(), EKIS_ACTIVE);
+    EXPECT(kbd->getIdle()->getWakes() >= 1);
+
+    // --> released: parks again after the timeout.
+    g_down = false;
+    run(100000);
+    EXPECT(pacer->isRunning() == false);
+
+    pacer->stop();
+}
+
+TEST(pacer_idle_waits_for_ticks) {
+    KbdScanPacer* pacer = KbdScanPacer::get();
+    Kbd* kbd = prepare(5);
+
+    EXPECT(pacer->start());
+
+    // --> a handler deadline keeps scanning, e.g. a macro step.
+    kbd->schedule(uint32_t(stub_time_us) + 30000);
+    run(20000);
+    EXPECT_EQ(kbd->getIdle()->getState(), EKIS_ACTIVE);
+    EXPECT(pacer->isRunning());
+
+    run(20000);
+    EXPECT_EQ(kbd->getIdle()->getState(), EKIS_ARMED);
+    EXPECT(pacer->isRunning() == false);
+
+    // --> armed after idling: the sleep ends at the deadline, not the tick.
+    stub_event_consume();
+
+    const uint64_t begin = stub_time_us;
+    kbd->schedule(uint32_t(begin) + 3000);
+    kbd->sleepOnce();
+    EXPECT_EQ(stub_time_us - begin, 3000);
+
+    kbd->dispatchOnce();
+    pacer->stop();
+}
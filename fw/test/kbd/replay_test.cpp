@@ -0,0 +1,326 @@
+#include "test.h"
+#include "session.h"
+#include "kbd/trace.h"
+#include "kbd/scanners/replay.h"
+#include "kbd/scanners/basic.h"
+#include "board/config.h"
+#include "hardware/gpio.h"
+#include "pico/stdlib.h"
+#include <string.h>
+#include <stdio.h>
+#include <chrono>
+
+/* keys closed on the simulated matrix, bit N: EKey(N). */
+static uint32_t g_matrix = 0;
+
+/* columns read high for the closed keys on the driven rows. */
+static uint32_t readMatrix(uint32_t out) {
+    uint32_t in = 0;
+
+    for(uint32_t bits = g_matrix; bits; bits &= bits - 1) {
+        const EKey key = EKey(__builtin_ctz(bits));
+        const uint32_t row = GPIO_KBD_ROW_1 + KbdMatrix::rowOf(key);
+        const uint32_t col = GPIO_KBD_COL_1 - KbdMatrix::colOf(key);
+
+        if (out & (1u << row)) {
+            in |= 1u << col;
+        }
+    }
+
+    return in;
+}
+
+/* play the loaded trace through `Kbd`, advancing `step` us per scan. */
+static void play(KbdSession& session, bool stepped, uint32_t step) {
+    KbdReplayScanner* replay = KbdReplayScanner::instance();
+    Kbd* kbd = Kbd::get();
+
+    session.listener.clear();
+    EXPECT(replay->play(stepped));
+
+    while(replay->isPlaying()) {
+        stub_time_us += step;
+        kbd->scanOnce();
+        kbd->dispatchOnce();
+    }
+
+    session.run(10);
+}
+
+/* test whether two recorded sessions are identical, times from their starts. */
+static bool isSame(const TestListener& a, uint32_t aStart, const TestListener& b, uint32_t bStart) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+
+    for(uint32_t i = 0; i < a.size(); ++i) {
+        if (a.at(i).key != b.at(i).key || a.at(i).state != b.at(i).state ||
+            a.at(i).us - aStart != b.at(i).us - bStart)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+TEST(replay_recorder) {
+    KbdTraceRecorder* recorder = KbdTraceRecorder::get();
+    STraceRecord rec;
+
+    recorder->start(1000);
+
+    // --> the initial state, then changes only.
+    recorder->record(1100, 0);
+    recorder->record(1200, 0);
+    recorder->record(1300, 1u << EKEY_PLUS);
+    recorder->record(1400, 1u << EKEY_PLUS);
+    recorder->record(1700, 0);
+    recorder->stop();
+
+    recorder->record(1800, 1u << EKEY_MINUS);
+
+    EXPECT_EQ(recorder->size(), 3);
+    EXPECT(recorder->getRecord(0, rec));
+    EXPECT_EQ(rec.dt, 100);
+    EXPECT_EQ(rec.keys, 0);
+
+    EXPECT(recorder->getRecord(1, rec));
+    EXPECT_EQ(rec.dt, 200);
+    EXPECT_EQ(rec.keys, 1u << EKEY_PLUS);
+
+    EXPECT(recorder->getRecord(2, rec));
+    EXPECT_EQ(rec.dt, 400);
+    EXPECT(recorder->getRecord(3, rec) == false);
+}
+
+TEST(replay_recorder_drops) {
+    KbdTraceRecorder* recorder = KbdTraceRecorder::get();
+
+    recorder->start(0);
+    for(uint32_t i = 0; i < KbdTraceRecorder::MAX_RECORDS + 5; ++i) {
+        recorder->record(i * 10, i);
+    }
+
+    recorder->stop();
+    EXPECT_EQ(recorder->size(), KbdTraceRecorder::MAX_RECORDS);
+    EXPECT_EQ(recorder->getDrops(), 5);
+}
+
+TEST(replay_file_format) {
+    static uint8_t buf[sizeof(STraceHeader) + 4 * sizeof(STraceRecord)];
+
+    KbdTraceRecorder* recorder = KbdTraceRecorder::get();
+    KbdReplayScanner* replay = KbdReplayScanner::instance();
+
+    recorder->start(0);
+    recorder->record(10, 0);
+    recorder->record(20, 1);
+    recorder->stop();
+
+    const uint32_t len = recorder->serialize(buf, sizeof(buf));
+    EXPECT_EQ(len, sizeof(STraceHeader) + 2 * sizeof(STraceRecord));
+    EXPECT_EQ(recorder->serialize(buf, len - 1), 0);
+
+    // --> unaligned, as it comes from the CDC buffer.
+    static uint8_t shifted[sizeof(buf) + 1];
+    memcpy(shifted + 1, buf, len);
+    EXPECT(replay->load(shifted + 1, len));
+
+    EXPECT(replay->load(buf, len - 1) == false);
+    EXPECT(replay->load(buf, sizeof(STraceHeader) - 1) == false);
+
+    buf[0] ^= 0xff;
+    EXPECT(replay->load(buf, len) == false);
+    buf[0] ^= 0xff;
+
+    buf[4] = STraceHeader::VERSION + 1;
+    EXPECT(replay->load(buf, len) == false);
+}
+
+TEST(replay_plays_trace) {
+    static const STraceRecord TRACE[] = {
+        { 10000, 1u << EKEY_PLUS },
+        { 30000, (1u << EKEY_PLUS) | (1u << EKEY_MINUS) },
+        { 30000, 1u << EKEY_MINUS },
+        { 30000, 0 },
+    };
+
+    KbdSession session(0);
+    KbdReplayScanner* replay = KbdReplayScanner::instance();
+
+    EXPECT(replay->load(TRACE, 4));
+    const uint32_t start = time_us_32();
+    play(session, false, 125);
+
+    const TestListener& lis = session.listener;
+    EXPECT_EQ(lis.count(EKEY_PLUS, EKLS_RISE), 1);
+    EXPECT_EQ(lis.count(EKEY_PLUS, EKLS_FALL), 1);
+    EXPECT_EQ(lis.count(EKEY_MINUS, EKLS_RISE), 1);
+    EXPECT_EQ(lis.count(EKEY_MINUS, EKLS_FALL), 1);
+
+    // --> stamped with trace times, within a scan of the record.
+    EXPECT(lis.at(0).key == EKEY_PLUS && lis.at(0).state == EKLS_RISE);
+    EXPECT(lis.at(0).us - start >= 10000 && lis.at(0).us - start < 10000 + 125);
+    EXPECT(replay->isPlaying() == false);
+}
+
+TEST(replay_stepped_is_deterministic) {
+    static STraceRecord trace[48];
+    const uint32_t count = makeTrace(trace, 48, 1234);
+
+    KbdSession session(0);
+    KbdReplayScanner* replay = KbdReplayScanner::instance();
+    TestListener first;
+
+    // --> however the scans are paced, the session is the same.
+    EXPECT(replay->load(trace, count));
+    const uint32_t firstStart = time_us_32();
+    play(session, true, 50);
+    first = session.listener;
+
+    const uint32_t secondStart = time_us_32();
+    play(session, true, 7000);
+
+    EXPECT(session.listener.size() > 0);
+    EXPECT(isSame(first, firstStart, session.listener, secondStart));
+
+    // --> exactly on trace times.
+    EXPECT_EQ(first.at(0).us - firstStart, trace[0].dt);
+}
+
+TEST(replay_stop) {
+    static const STraceRecord TRACE[] = {
+        { 1000, 1u << EKEY_PLUS },
+        { 1000000, 0 },
+    };
+
+    KbdSession session(0);
+    KbdReplayScanner* replay = KbdReplayScanner::instance();
+    Kbd* kbd = Kbd::get();
+
+    EXPECT(replay->load(TRACE, 2));
+    EXPECT(replay->play());
+    EXPECT(replay->load(TRACE, 1) == false);
+
+    session.run(10);
+    EXPECT(kbd->isKeyDown(EKEY_PLUS));
+
+    // --> keys are released, then the replay ends.
+    replay->stop();
+    session.run(10);
+
+    EXPECT(kbd->isKeyDown(EKEY_PLUS) == false);
+    EXPECT(replay->isPlaying() == false);
+}
+
+TEST(replay_records_basic_scanner) {
+    static uint8_t buf[sizeof(STraceHeader) + 16 * sizeof(STraceRecord)];
+
+    KbdBasicScanner* basic = KbdBasicScanner::instance();
+    KbdTraceRecorder* recorder = KbdTraceRecorder::get();
+
+    stub_gpio_in = readMatrix;
+    recorder->start(time_us_32());
+
+    // --> typed on the simulated matrix, scanned at the governed rate.
+    static const uint32_t TYPED[] = {
+        1u << EKEY_NUM_7, (1u << EKEY_NUM_7) | (1u << EKEY_ENTER), 1u << EKEY_ENTER, 0
+    };
+
+    for(const uint32_t keys : TYPED) {
+        g_matrix = keys;
+
+        for(uint32_t i = 0; i < 300; ++i) {
+            stub_time_us += 100;
+            basic->scanOnce();
+        }
+    }
+
+    recorder->stop();
+    stub_gpio_in = nullptr;
+
+    // --> the first scan is the initial state.
+    EXPECT_EQ(recorder->size(), 4);
+
+    // --> played back through the keyboard, it types the same.
+    KbdSession session(0);
+    const uint32_t len = recorder->serialize(buf, sizeof(buf));
+
+    EXPECT(KbdReplayScanner::instance()->load(buf, len));
+    play(session, true, 1000);
+
+    const TestListener& lis = session.listener;
+    EXPECT_EQ(lis.count(EKEY_NUM_7, EKLS_RISE), 1);
+    EXPECT_EQ(lis.count(EKEY_ENTER, EKLS_RISE), 1);
+    EXPECT_EQ(lis.count(EKEY_NUM_7, EKLS_FALL), 1);
+    EXPECT_EQ(lis.count(EKEY_ENTER, EKLS_FALL), 1);
+}
+
+/**
+ * keyboard sessions over recorded traces, scanned and dispatched at 1 kHz.
+ * replays are stepped, so every run of a trace must type the same.
+ */
+TEST(replay_bench) {
+    static constexpr uint32_t TRACES = 8;
+    static constexpr uint32_t ROUNDS = 25;
+    static constexpr uint32_t RECORDS = 48;
+
+    static STraceRecord traces[TRACES][RECORDS];
+    static uint32_t notifies[TRACES];
+
+    KbdSession session(0);
+    KbdReplayScanner* replay = KbdReplayScanner::instance();
+    Kbd* kbd = Kbd::get();
+
+    uint32_t counts[TRACES];
+    uint64_t scans = 0;
+    uint32_t mismatches = 0;
+
+    for(uint32_t i = 0; i < TRACES; ++i) {
+        counts[i] = makeTrace(traces[i], RECORDS, 0x9e3779b9u * (i + 1));
+        notifies[i] = 0;
+    }
+
+    const auto begin = std::chrono::steady_clock::now();
+
+    for(uint32_t round = 0; round < ROUNDS; ++round) {
+        for(uint32_t i = 0; i < TRACES; ++i) {
+            session.listener.clear();
+            replay->load(traces[i], counts[i]);
+            replay->play(true);
+
+            while(replay->isPlaying()) {
+                stub_time_us += 1000;
+                kbd->scanOnce();
+                kbd->dispatchOnce();
+                scans++;
+            }
+
+            session.run(10);
+            scans += 10;
+
+            // --> the first round sets the expectation.
+            if (round == 0) {
+                notifies[i] = session.listener.size();
+            }
+
+            else if (notifies[i] != session.listener.size()) {
+                mismatches++;
+            }
+        }
+    }
+
+    const auto end = std::chrono::steady_clock::now();
+    const uint64_t us = std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count();
+
+    EXPECT_EQ(mismatches, 0);
+    for(uint32_t i = 0; i < TRACES; ++i) {
+        EXPECT(notifies[i] > 0);
+    }
+
+    printf("  %u sessions, %llu scans: %llu us (%.1f sessions/s, %.3f us per scan)\n",
+        TRACES * ROUNDS, (unsigned long long) scans, (unsigned long long) us,
+        us ? double(TRACES * ROUNDS) * 1e6 / double(us) : 0.0,
+        scans ? double(us) / double(scans) : 0.0);
+}
@@ -0,0 +1,123 @@
+#include "session.h"
+#include "pico/stdlib.h"
+
+void TestScanner::set(uint32_t keys) {
+    _keys = keys & _mask;
+    _sampled = time_us_32();
+}
+
+void TestListener::onKeyNotify(const Kbd* kbd, EKey key, EKeyState state) {
+    if (_count < MAX_NOTIFIES) {
+        _notifies[_count++] = { key, state, kbd->getKeyTime(key) };
+    }
+}
+
+uint32_t TestListener::count(EKey key, EKeyState state) const {
+    uint32_t count = 0;
+
+    for(uint32_t i = 0; i < _count; ++i) {
+        if (_notifies[i].key == key && _notifies[i].state == state) {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+KbdSession::KbdSession(uint32_t mask)
+    : scanner(mask)
+{
+    Kbd* kbd = Kbd::get();
+
+    kbd->getIdle()->setTimeout(0);
+    kbd->push(&scanner);
+    kbd->listen(&listener);
+    kbd->enable();
+
+    // --> past the debounce lockout from boot.
+    run(10);
+    listener.clear();
+}
+
+KbdSession::~KbdSession() {
+    Kbd* kbd = Kbd::get();
+
+    // --> past debounce, tap-hold and repeat windows of any key.
+    scanner.set(0);
+    run(1000);
+
+    kbd->unlisten(&listener);
+    kbd->pop(&scanner);
+}
+
+bool KbdSession::step(uint32_t us) {
+    Kbd* kbd = Kbd::get();
+
+    stub_time_us += us;
+    kbd->scanOnce();
+
+    return kbd->dispatchOnce();
+}
+
+bool KbdSession::run(uint32_t count, uint32_t us) {
+    bool triggered = false;
+
+    for(uint32_t i = 0; i < count; ++i) {
+        triggered = step(us) || triggered;
+    }
+
+    return triggered;
+}
+
+uint32_t makeTrace(STraceRecord* records, uint32_t max, uint32_t seed) {
+    static const EKey KEYS[] = {
+        EKEY_NUM_0, EKEY_NUM_1, EKEY_NUM_2, EKEY_NUM_3, EKEY_NUM_4,
+        EKEY_NUM_5, EKEY_NUM_6, EKEY_NUM_7, EKEY_NUM_8, EKEY_NUM_9,
+        EKEY_PLUS, EKEY_MINUS, EKEY_ENTER, EKEY_DOT
+    };
+
+    static constexpr uint32_t COUNT = sizeof(KEYS) / sizeof(KEYS[0]);
+
+    uint32_t state = seed ? seed : 1;
+    uint32_t keys = 0;
+    uint32_t count = 0;
+
+    // --> xorshift: the same seed makes the same session everywhere.
+    auto next = [&state]() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    };
+
+    while(count < max) {
+        const uint32_t down = __builtin_popcount(keys);
+
+        // --> the last records release everything.
+        if (count + down >= max) {
+            keys &= keys - 1;
+        }
+
+        else if (down < 3 && (down == 0 || next() % 2)) {
+            keys |= 1u << KEYS[next() % COUNT];
+        }
+
+        else {
+            uint32_t bits = keys;
+            for(uint32_t skip = next() % down; skip; --skip) {
+                bits &= bits - 1;
+            }
+
+            keys &= ~(bits & -bits);
+        }
+
+        records[count].dt = 20000 + next() % 100000;
+        records[count++].keys = keys;
+
+        if (count >= max && keys) {
+            records[count - 1].keys = 0;
+        }
+    }
+
+    return count;
+}
@@ -0,0 +1,110 @@
+#ifndef __TEST_KBD_SESSION_H__
+#define __TEST_KBD_SESSION_H__
+
+#include "kbd/kbd.h"
+#include "kbd/trace.h"
+#include "kbd/scanners/matrix.h"
+
+/**
+ * key scanner driven by tests.
+ * pushed after the matrix scanners, so it wins the keys it presents.
+ */
+class TestScanner : public IKeyScanner {
+private:
+    uint32_t _keys;
+    uint32_t _mask;
+    uint32_t _sampled;
+
+public:
+    TestScanner(uint32_t mask = KbdMatrix::KEY_MASK)
+        : _keys(0), _mask(mask), _sampled(0) { }
+
+public:
+    /* set the key bitmap, sampled now. */
+    void set(uint32_t keys);
+
+    /* press the key, sampled now. */
+    void press(EKey key) { set(_keys | (1u << key)); }
+
+    /* release the key, sampled now. */
+    void release(EKey key) { set(_keys & ~(1u << key)); }
+
+public:
+    virtual bool scanOnce() override { return true; }
+    virtual bool isEmpty() const override { return false; }
+    virtual uint32_t getKeys() const override { return _keys; }
+    virtual uint32_t getMask() const override { return _mask; }
+    virtual uint32_t getSampleTime() const override { return _sampled; }
+};
+
+/**
+ * key listener that records notifications.
+ */
+class TestListener : public IKeyListener {
+public:
+    static constexpr uint32_t MAX_NOTIFIES = 64;
+
+    struct SNotify {
+        EKey key;
+        EKeyState state;
+        uint32_t us;        // --> the sample time of the key.
+    };
+
+private:
+    SNotify _notifies[MAX_NOTIFIES];
+    uint32_t _count;
+    uint32_t _posts;
+
+public:
+    TestListener() : _count(0), _posts(0) { }
+
+public:
+    virtual void onKeyNotify(const Kbd* kbd, EKey key, EKeyState state) override;
+    virtual void onPostKeyNotify(const Kbd* kbd) override { _posts++; }
+
+public:
+    /* forget recorded notifications. */
+    void clear() { _count = _posts = 0; }
+
+    /* get the count of notifications. */
+    uint32_t size() const { return _count; }
+
+    /* get the count of post notifications. */
+    uint32_t getPosts() const { return _posts; }
+
+    /* get the notification at the index. */
+    const SNotify& at(uint32_t index) const { return _notifies[index]; }
+
+    /* count notifications of the key in the state. */
+    uint32_t count(EKey key, EKeyState state) const;
+};
+
+/**
+ * a keyboard session: the test scanner and listener on the `Kbd` instance.
+ * idle scanning is off, and keys are released and settled on leaving.
+ */
+class KbdSession {
+public:
+    TestScanner scanner;
+    TestListener listener;
+
+public:
+    KbdSession(uint32_t mask = KbdMatrix::KEY_MASK);
+    ~KbdSession();
+
+public:
+    /* advance the clock by `us`, then scan and dispatch once. */
+    bool step(uint32_t us = 1000);
+
+    /* step `count` times, returns true if any dispatch triggered. */
+    bool run(uint32_t count, uint32_t us = 1000);
+};
+
+/**
+ * make a typing session trace from the seed: rolls of up to three keys,
+ * 20 to 120 ms apart, ending with all keys released.
+ * returns the count of records.
+ */
+uint32_t makeTrace(STraceRecord* records, uint32_t max, uint32_t seed);
+
+#endif
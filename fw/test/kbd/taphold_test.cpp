@@ -0,0 +1,187 @@
+#include "test.h"
+#include "session.h"
+#include "kbd/taphold.h"
+
+static SKeyEvent makeEvent(uint32_t us, EKey key, EKeyState state) {
+    SKeyEvent event;
+
+    event.us = us;
+    event.key = key;
+    event.state = state;
+    return event;
+}
+
+TEST(taphold_config) {
+    KbdTapHold th;
+
+    EXPECT_EQ(th.getRule(), EKHR_ON_PRESS);
+    EXPECT(th.setHold(EKEY_HIDDEN, 0x02) == false);
+    EXPECT(th.setHold(EKEY_MAX, 0x02) == false);
+    EXPECT(th.setRule(EKHR_MAX_VALUE) == false);
+
+    EXPECT(th.setHold(EKEY_UFN_1, 0x02, 150));
+    EXPECT(th.isDual(EKEY_UFN_1));
+    EXPECT_EQ(th.getHoldMod(EKEY_UFN_1), 0x02);
+    EXPECT_EQ(th.getTerm(EKEY_UFN_1), 150);
+
+    // --> a zero term clears the dual role.
+    th.setHold(EKEY_UFN_1, 0x02, 0);
+    EXPECT(th.isDual(EKEY_UFN_1) == false);
+}
+
+TEST(taphold_passing) {
+    KbdTapHold th;
+    th.setHold(EKEY_UFN_1, 0x02);
+
+    // --> only dual presses, or anything behind them, are held back.
+    EXPECT(th.isPassing(makeEvent(0, EKEY_NUM_1, EKLS_RISE)));
+    EXPECT(th.isPassing(makeEvent(0, EKEY_UFN_1, EKLS_FALL)));
+    EXPECT(th.isPassing(makeEvent(0, EKEY_UFN_1, EKLS_RISE)) == false);
+
+    th.push(makeEvent(0, EKEY_UFN_1, EKLS_RISE));
+    EXPECT(th.isPassing(makeEvent(0, EKEY_NUM_1, EKLS_RISE)) == false);
+}
+
+TEST(taphold_tap) {
+    KbdTapHold th;
+    SKeyEvent event;
+
+    th.setHold(EKEY_UFN_1, 0x02, 200);
+    th.push(makeEvent(0, EKEY_UFN_1, EKLS_RISE));
+    EXPECT(th.pop(&event, 0) == false);
+
+    // --> released within the term: its own key, as two edges.
+    th.push(makeEvent(50000, EKEY_UFN_1, EKLS_FALL));
+    EXPECT(th.pop(&event, 0));
+    EXPECT(event.key == EKEY_UFN_1 && event.state == EKLS_RISE);
+    EXPECT(th.isHeld(EKEY_UFN_1) == false);
+
+    EXPECT(th.pop(&event, 1u << EKEY_UFN_1) == false);
+    EXPECT(th.pop(&event, 0));
+    EXPECT(event.state == EKLS_FALL);
+    EXPECT(th.isPending() == false);
+}
+
+TEST(taphold_on_press) {
+    KbdTapHold th;
+    SKeyEvent event;
+
+    th.setHold(EKEY_UFN_1, 0x02, 200);
+    th.push(makeEvent(0, EKEY_UFN_1, EKLS_RISE));
+    th.push(makeEvent(10000, EKEY_NUM_1, EKLS_RISE));
+
+    // --> resolved as hold, then both pass in order.
+    EXPECT(th.isHeld(EKEY_UFN_1));
+    EXPECT(th.pop(&event, 0) && event.key == EKEY_UFN_1);
+    EXPECT(th.pop(&event, 0) && event.key == EKEY_NUM_1);
+
+    th.release(EKEY_UFN_1);
+    EXPECT(th.isHeld(EKEY_UFN_1) == false);
+}
+
+TEST(taphold_timeout) {
+    KbdTapHold th;
+    SKeyEvent event;
+
+    th.setHold(EKEY_UFN_1, 0x02, 200);
+    th.setRule(EKHR_TIMEOUT);
+
+    th.push(makeEvent(1000, EKEY_UFN_1, EKLS_RISE));
+    th.push(makeEvent(2000, EKEY_NUM_1, EKLS_RISE));
+    EXPECT(th.isHeld(EKEY_UFN_1) == false);
+
+    th.poll(1000 + 199999);
+    EXPECT(th.isHeld(EKEY_UFN_1) == false);
+    EXPECT(th.pop(&event, 0) == false);
+
+    th.poll(1000 + 200000);
+    EXPECT(th.isHeld(EKEY_UFN_1));
+    EXPECT(th.pop(&event, 0) && event.key == EKEY_UFN_1);
+    EXPECT(th.pop(&event, 0) && event.key == EKEY_NUM_1);
+}
+
+TEST(taphold_term_from_event_times) {
+    KbdTapHold th;
+
+    th.setHold(EKEY_UFN_1, 0x02, 200);
+    th.setRule(EKHR_TIMEOUT);
+
+    // --> a later event past the term resolves it without polling.
+    th.push(makeEvent(0, EKEY_UFN_1, EKLS_RISE));
+    th.push(makeEvent(250000, EKEY_UFN_1, EKLS_FALL));
+    EXPECT(th.isHeld(EKEY_UFN_1));
+}
+
+TEST(taphold_permissive) {
+    KbdTapHold th;
+
+    th.setHold(EKEY_UFN_1, 0x02, 200);
+    th.setRule(EKHR_PERMISSIVE);
+
+    // --> a key pressed before the dual key doesn't count.
+    th.push(makeEvent(0, EKEY_UFN_1, EKLS_RISE));
+    th.push(makeEvent(10, EKEY_NUM_2, EKLS_FALL));
+    EXPECT(th.isHeld(EKEY_UFN_1) == false);
+
+    // --> pressed and released while held: a hold.
+    th.push(makeEvent(20, EKEY_NUM_1, EKLS_RISE));
+    EXPECT(th.isHeld(EKEY_UFN_1) == false);
+
+    th.push(makeEvent(30, EKEY_NUM_1, EKLS_FALL));
+    EXPECT(th.isHeld(EKEY_UFN_1));
+}
+
+TEST(taphold_full_queue_holds) {
+    KbdTapHold th;
+
+    th.setHold(EKEY_UFN_1, 0x02, 200);
+    th.setRule(EKHR_TIMEOUT);
+    th.push(makeEvent(0, EKEY_UFN_1, EKLS_RISE));
+
+    for(uint32_t i = 1; i < KbdTapHold::MAX_QUEUED; ++i) {
+        EXPECT(th.isHeld(EKEY_UFN_1) == false);
+        th.push(makeEvent(i, EKEY_NUM_1, (i & 1) ? EKLS_RISE : EKLS_FALL));
+    }
+
+    // --> bounded: a full queue can't wait any longer.
+    EXPECT(th.isFull());
+    EXPECT(th.isHeld(EKEY_UFN_1));
+    EXPECT(th.push(makeEvent(100, EKEY_NUM_2, EKLS_RISE)) == false);
+}
+
+TEST(taphold_kbd_tap_and_hold) {
+    KbdSession session;
+    Kbd* kbd = Kbd::get();
+    KbdTapHold* th = kbd->getTapHold();
+
+    th->setHold(EKEY_UFN_1, 0x02, 200);
+
+    // --> tapped: nothing until released, then rise and fall.
+    session.scanner.press(EKEY_UFN_1);
+    session.run(50);
+    EXPECT_EQ(session.listener.size(), 0);
+
+    session.scanner.release(EKEY_UFN_1);
+    session.run(20);
+
+    EXPECT_EQ(session.listener.count(EKEY_UFN_1, EKLS_RISE), 1);
+    EXPECT_EQ(session.listener.count(EKEY_UFN_1, EKLS_FALL), 1);
+    EXPECT(session.listener.at(0).state == EKLS_RISE);
+    EXPECT(session.listener.at(1).state == EKLS_FALL);
+    EXPECT(th->isHeld(EKEY_UFN_1) == false);
+
+    // --> held past the term.
+    session.listener.clear();
+    session.scanner.press(EKEY_UFN_1);
+    session.run(250);
+
+    EXPECT(th->isHeld(EKEY_UFN_1));
+    EXPECT(kbd->isKeyDown(EKEY_UFN_1));
+    EXPECT_EQ(session.listener.count(EKEY_UFN_1, EKLS_RISE), 1);
+
+    session.scanner.release(EKEY_UFN_1);
+    session.run(20);
+
+    EXPECT(th->isHeld(EKEY_UFN_1) == false);
+    th->setHold(EKEY_UFN_1, 0, 0);
+}
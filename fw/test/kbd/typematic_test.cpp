@@ -0,0 +1,134 @@
+#include "test.h"
+#include "session.h"
+#include "kbd/typematic.h"
+#include "pico/stdlib.h"
+
+TEST(typematic_defaults) {
+    KbdTypematic tm;
+
+    EXPECT(tm.isActive() == false);
+    EXPECT_EQ(tm.getKeys(), KbdTypematic::DEFAULT_KEYS);
+    EXPECT_EQ(tm.getDelay(EKEY_PLUS), KbdTypematic::DEFAULT_DELAY_MS);
+    EXPECT_EQ(tm.getPeriod(EKEY_PLUS), KbdTypematic::DEFAULT_PERIOD_MS);
+
+    // --> inactive: nothing armed.
+    tm.arm(EKEY_PLUS, 0);
+    EXPECT(tm.isArmed() == false);
+
+    EXPECT(tm.setTiming(EKEY_PLUS, 100, 0) == false);
+    EXPECT(tm.setTiming(EKEY_MAX, 100, 10) == false);
+    EXPECT_EQ(tm.getDelay(EKEY_MAX), 0);
+}
+
+TEST(typematic_delay_then_period) {
+    KbdTypematic tm;
+
+    tm.setActive(true);
+    tm.setTiming(EKEY_PLUS, 100, 10);
+    tm.arm(EKEY_PLUS, 5000);
+
+    EXPECT_EQ(tm.poll(5000 + 99999), 0);
+    EXPECT_EQ(tm.poll(5000 + 100000), 1u << EKEY_PLUS);
+    EXPECT_EQ(tm.poll(5000 + 100001), 0);
+
+    // --> deadlines advance from the deadline, not from the poll.
+    EXPECT_EQ(tm.poll(5000 + 110900), 1u << EKEY_PLUS);
+    EXPECT_EQ(tm.poll(5000 + 119999), 0);
+    EXPECT_EQ(tm.poll(5000 + 120000), 1u << EKEY_PLUS);
+}
+
+TEST(typematic_skips_instead_of_bursting) {
+    KbdTypematic tm;
+
+    tm.setActive(true);
+    tm.setTiming(EKEY_PLUS, 100, 10);
+    tm.arm(EKEY_PLUS, 0);
+
+    // --> polled far too late: fired once, then a period from now.
+    EXPECT_EQ(tm.poll(500000), 1u << EKEY_PLUS);
+    EXPECT_EQ(tm.poll(500001), 0);
+    EXPECT_EQ(tm.poll(509999), 0);
+    EXPECT_EQ(tm.poll(510000), 1u << EKEY_PLUS);
+}
+
+TEST(typematic_keys_and_disarm) {
+    KbdTypematic tm;
+
+    tm.setActive(true);
+    tm.setTimingAll(10, 10);
+
+    // --> not allowed to repeat: never armed.
+    tm.arm(EKEY_NUMLOCK, 0);
+    EXPECT(tm.isArmed() == false);
+
+    tm.arm(EKEY_PLUS, 0);
+    tm.arm(EKEY_MINUS, 0);
+    EXPECT_EQ(tm.poll(10000), (1u << EKEY_PLUS) | (1u << EKEY_MINUS));
+
+    tm.disarm(EKEY_PLUS);
+    EXPECT_EQ(tm.poll(20000), 1u << EKEY_MINUS);
+
+    // --> disallowing a key disarms it.
+    tm.setKeys(tm.getKeys() & ~(1u << EKEY_MINUS));
+    EXPECT(tm.isArmed() == false);
+
+    // --> turning off disarms everything.
+    tm.arm(EKEY_ENTER, 0);
+    tm.setActive(false);
+    EXPECT(tm.isArmed() == false);
+}
+
+TEST(typematic_wraps) {
+    KbdTypematic tm;
+
+    tm.setActive(true);
+    tm.setTiming(EKEY_PLUS, 1, 1);
+
+    // --> across the 32 bit wrap of `time_us_32`.
+    tm.arm(EKEY_PLUS, UINT32_MAX - 499);
+    EXPECT_EQ(tm.poll(UINT32_MAX), 0);
+    EXPECT_EQ(tm.poll(499), 0);
+    EXPECT_EQ(tm.poll(500), 1u << EKEY_PLUS);
+    EXPECT_EQ(tm.poll(1499), 0);
+    EXPECT_EQ(tm.poll(1500), 1u << EKEY_PLUS);
+}
+
+TEST(typematic_kbd_repeats) {
+    KbdSession session;
+    Kbd* kbd = Kbd::get();
+    KbdTypematic* tm = kbd->getTypematic();
+
+    tm->setActive(true);
+    tm->setTiming(EKEY_PLUS, 100, 10);
+
+    // --> a press, then a repeat every period after the delay.
+    session.scanner.press(EKEY_PLUS);
+    const uint32_t pressed = time_us_32();
+
+    session.run(200);
+
+    // --> scans take time too: counted from the clock, within a scan.
+    const uint32_t held = time_us_32() - pressed;
+    const uint32_t rises = session.listener.count(EKEY_PLUS, EKLS_RISE);
+    const uint32_t expected = 2 + (held - 100000) / 10000;
+
+    EXPECT(rises + 1 >= expected && rises <= expected);
+
+    // --> released: no more repeats.
+    session.scanner.release(EKEY_PLUS);
+    session.run(100);
+
+    EXPECT_EQ(session.listener.count(EKEY_PLUS, EKLS_RISE), rises);
+    EXPECT_EQ(session.listener.count(EKEY_PLUS, EKLS_FALL), 1);
+
+    // --> keys not allowed to repeat rise once.
+    session.scanner.press(EKEY_NUMLOCK);
+    session.run(200);
+    EXPECT_EQ(session.listener.count(EKEY_NUMLOCK, EKLS_RISE), 1);
+
+    session.scanner.release(EKEY_NUMLOCK);
+    session.run(10);
+
+    tm->setTimingAll(KbdTypematic::DEFAULT_DELAY_MS, KbdTypematic::DEFAULT_PERIOD_MS);
+    tm->setActive(false);
+}
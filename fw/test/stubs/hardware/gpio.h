@@ -0,0 +1,92 @@
+#ifndef __STUBS_HARDWARE_GPIO_H__
+#define __STUBS_HARDWARE_GPIO_H__
+
+#include "../pico.h"
+
+enum {
+    GPIO_IN = 0,
+    GPIO_OUT = 1,
+};
+
+enum {
+    GPIO_IRQ_LEVEL_LOW = 0x1,
+    GPIO_IRQ_LEVEL_HIGH = 0x2,
+    GPIO_IRQ_EDGE_FALL = 0x4,
+    GPIO_IRQ_EDGE_RISE = 0x8,
+};
+
+typedef void (*irq_handler_t)();
+
+// --> driven output levels, bit N: GPIO N.
+inline uint32_t stub_gpio_out = 0;
+
+// --> input levels from the driven outputs, e.g. a simulated key matrix.
+inline uint32_t (*stub_gpio_in)(uint32_t out) = nullptr;
+
+static inline uint32_t gpio_get_all() {
+    return stub_gpio_in ? stub_gpio_in(stub_gpio_out) : 0;
+}
+
+static inline bool gpio_get(uint32_t pin) { return (gpio_get_all() >> pin) & 1; }
+
+static inline void gpio_put(uint32_t pin, bool value) {
+    stub_gpio_out = value ? (stub_gpio_out | (1u << pin)) : (stub_gpio_out & ~(1u << pin));
+}
+
+static inline void gpio_put_masked(uint32_t mask, uint32_t value) {
+    stub_gpio_out = (stub_gpio_out & ~mask) | (value & mask);
+}
+
+static inline void gpio_init(uint32_t) { }
+static inline void gpio_set_dir(uint32_t, bool) { }
+static inline void gpio_pull_up(uint32_t) { }
+static inline void gpio_pull_down(uint32_t) { }
+
+// --> rising edges latched, pins with the rise interrupt enabled, and the raw handler.
+inline uint32_t stub_gpio_edges = 0;
+inline uint32_t stub_gpio_irqs = 0;
+inline irq_handler_t stub_gpio_handler = nullptr;
+inline bool stub_gpio_handling = false;
+
+/* run the handler while a latched edge is enabled, the exception return sets the event. */
+static inline void stub_gpio_fire() {
+    // --> never nested: pending again after the handler, it runs again.
+    if (stub_gpio_handling || stub_gpio_handler == nullptr) {
+        return;
+    }
+
+    while (stub_gpio_edges & stub_gpio_irqs) {
+        stub_gpio_handling = true;
+        stub_gpio_handler();
+
+        stub_gpio_handling = false;
+        __sev();
+    }
+}
+
+/* latch a rising edge on the pin, e.g. a key pressed on a held row. */
+static inline void stub_gpio_rise(uint32_t pin) {
+    stub_gpio_edges |= 1u << pin;
+    stub_gpio_fire();
+}
+
+static inline void gpio_acknowledge_irq(uint32_t pin, uint32_t events) {
+    if (events & GPIO_IRQ_EDGE_RISE) {
+        stub_gpio_edges &= ~(1u << pin);
+    }
+}
+
+static inline void gpio_set_irq_enabled(uint32_t pin, uint32_t events, bool enabled) {
+    if ((events & GPIO_IRQ_EDGE_RISE) == 0) {
+        return;
+    }
+
+    stub_gpio_irqs = enabled ? (stub_gpio_irqs | (1u << pin)) : (stub_gpio_irqs & ~(1u << pin));
+    stub_gpio_fire();
+}
+
+static inline void gpio_add_raw_irq_handler_masked(uint32_t, irq_handler_t handler) {
+    stub_gpio_handler = handler;
+}
+
+#endif
@@ -0,0 +1,12 @@
+#ifndef __STUBS_HARDWARE_IRQ_H__
+#define __STUBS_HARDWARE_IRQ_H__
+
+#include "../pico.h"
+
+enum {
+    IO_IRQ_BANK0 = 13,
+};
+
+static inline void irq_set_enabled(uint32_t, bool) { }
+
+#endif
@@ -0,0 +1,8 @@
+#ifndef __STUBS_HARDWARE_SPI_H__
+#define __STUBS_HARDWARE_SPI_H__
+
+#include "../pico.h"
+
+typedef struct spi_inst spi_inst_t;
+
+#endif
@@ -0,0 +1,4 @@
+#ifndef __STUBS_HARDWARE_STRUCTS_TIMER_H__
+#define __STUBS_HARDWARE_STRUCTS_TIMER_H__
+
+#endif
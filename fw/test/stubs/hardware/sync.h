@@ -0,0 +1,34 @@
+#ifndef __STUBS_HARDWARE_SYNC_H__
+#define __STUBS_HARDWARE_SYNC_H__
+
+#include "../pico.h"
+#include <atomic>
+
+// --> host threads stand in for the cores: locks really spin.
+typedef std::atomic<uint32_t> spin_lock_t;
+
+static constexpr uint32_t STUB_SPIN_LOCKS = 32;
+inline spin_lock_t stub_spin_locks[STUB_SPIN_LOCKS];
+inline std::atomic<uint32_t> stub_spin_claimed = 0;
+
+static inline uint32_t save_and_disable_interrupts() { return 0; }
+static inline void restore_interrupts(uint32_t) { }
+
+static inline int spin_lock_claim_unused(bool) {
+    return int(stub_spin_claimed.fetch_add(1) % STUB_SPIN_LOCKS);
+}
+
+static inline spin_lock_t* spin_lock_instance(uint32_t num) {
+    return &stub_spin_locks[num % STUB_SPIN_LOCKS];
+}
+
+static inline uint32_t spin_lock_blocking(spin_lock_t* lock) {
+    while(lock->exchange(1, std::memory_order_acquire) != 0);
+    return 0;
+}
+
+static inline void spin_unlock(spin_lock_t* lock, uint32_t) {
+    lock->store(0, std::memory_order_release);
+}
+
+#endif
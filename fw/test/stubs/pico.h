@@ -0,0 +1,71 @@
+#ifndef __STUBS_PICO_H__
+#define __STUBS_PICO_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <condition_variable>
+#include <mutex>
+
+// --> the core each host thread pretends to run on.
+inline thread_local uint32_t stub_core_num = 0;
+
+static inline uint32_t get_core_num() { return stub_core_num; }
+static inline void tight_loop_contents() { }
+
+/**
+ * SEV/WFE stand-in: an event latch per core, waited on a condition variable.
+ * leaked, so a core1 thread may still wait on it while the process exits.
+ */
+struct SStubEvent {
+    static constexpr uint32_t MAX_CORES = 2;
+
+    std::mutex lock;
+    std::condition_variable cond;
+    bool latched[MAX_CORES];
+    uint32_t waits;     // --> WFEs that really waited.
+    uint32_t sleepers;  // --> cores waiting now.
+};
+
+inline SStubEvent* stub_event = new SStubEvent();
+
+/* latch the event on all cores and wake them up. */
+static inline void __sev() {
+    std::lock_guard<std::mutex> guard(stub_event->lock);
+
+    for(uint32_t i = 0; i < SStubEvent::MAX_CORES; ++i) {
+        stub_event->latched[i] = true;
+    }
+
+    stub_event->cond.notify_all();
+}
+
+/* consume the latched event, or wait for one. */
+static inline void __wfe() {
+    std::unique_lock<std::mutex> guard(stub_event->lock);
+    bool& latched = stub_event->latched[stub_core_num];
+
+    if (!latched) {
+        stub_event->waits++;
+        stub_event->sleepers++;
+
+        stub_event->cond.wait(guard, [&latched]() { return latched; });
+        stub_event->sleepers--;
+    }
+
+    latched = false;
+}
+
+/* consume the latched event without waiting, returns true if it was. */
+static inline bool stub_event_consume() {
+    std::lock_guard<std::mutex> guard(stub_event->lock);
+    bool& latched = stub_event->latched[stub_core_num];
+    const bool result = latched;
+
+    latched = false;
+    return result;
+}
+
+static inline void __wfi() { }
+static inline void __dmb() { }
+
+#endif
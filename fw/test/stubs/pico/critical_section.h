@@ -0,0 +1,22 @@
+#ifndef __STUBS_PICO_CRITICAL_SECTION_H__
+#define __STUBS_PICO_CRITICAL_SECTION_H__
+
+#include "../hardware/sync.h"
+
+struct critical_section_t {
+    spin_lock_t* lock;
+};
+
+static inline void critical_section_init(critical_section_t* cs) {
+    cs->lock = spin_lock_instance(spin_lock_claim_unused(true));
+}
+
+static inline void critical_section_enter_blocking(critical_section_t* cs) {
+    spin_lock_blocking(cs->lock);
+}
+
+static inline void critical_section_exit(critical_section_t* cs) {
+    spin_unlock(cs->lock, 0);
+}
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef __STUBS_PICO_MULTICORE_H__
+#define __STUBS_PICO_MULTICORE_H__
+
+#include "../pico.h"
+#include <deque>
+#include <thread>
+
+/**
+ * inter-core FIFOs: one per direction, indexed by the receiving core.
+ * leaked, like the event latch.
+ */
+struct SStubFifo {
+    std::mutex lock;
+    std::condition_variable cond;
+    std::deque<uint32_t> queues[SStubEvent::MAX_CORES];
+};
+
+inline SStubFifo* stub_fifo = new SStubFifo();
+
+// --> core1 is a detached thread: it runs until the process exits.
+static inline void multicore_launch_core1(void (*entry)()) {
+    std::thread([entry]() {
+        stub_core_num = 1;
+        entry();
+    }).detach();
+}
+
+static inline void multicore_fifo_push_blocking(uint32_t value) {
+    std::lock_guard<std::mutex> guard(stub_fifo->lock);
+
+    stub_fifo->queues[stub_core_num ^ 1].push_back(value);
+    stub_fifo->cond.notify_all();
+}
+
+static inline uint32_t multicore_fifo_pop_blocking() {
+    std::unique_lock<std::mutex> guard(stub_fifo->lock);
+    std::deque<uint32_t>& queue = stub_fifo->queues[stub_core_num];
+
+    stub_fifo->cond.wait(guard, [&queue]() { return !queue.empty(); });
+
+    const uint32_t value = queue.front();
+    queue.pop_front();
+    return value;
+}
+
+#endif
@@ -0,0 +1,6 @@
+#ifndef __STUBS_PICO_STDIO_H__
+#define __STUBS_PICO_STDIO_H__
+
+#include <stdio.h>
+
+#endif
@@ -0,0 +1,10 @@
+#ifndef __STUBS_PICO_STDLIB_H__
+#define __STUBS_PICO_STDLIB_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "../pico.h"
+#include "time.h"
+
+#endif
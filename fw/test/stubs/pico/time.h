@@ -0,0 +1,131 @@
+#ifndef __STUBS_PICO_TIME_H__
+#define __STUBS_PICO_TIME_H__
+
+#include "../pico.h"
+
+typedef uint64_t absolute_time_t;
+
+// --> the host clock: tests move it, sleeping and busy-waits move it too.
+inline uint64_t stub_time_us = 0;
+
+static inline uint64_t time_us_64() { return stub_time_us; }
+static inline uint32_t time_us_32() { return uint32_t(stub_time_us); }
+static inline absolute_time_t get_absolute_time() { return stub_time_us; }
+
+static inline uint32_t to_ms_since_boot(absolute_time_t t) { return uint32_t(t / 1000); }
+static inline uint64_t to_us_since_boot(absolute_time_t t) { return t; }
+
+static inline absolute_time_t make_timeout_time_us(uint64_t us) { return stub_time_us + us; }
+static inline absolute_time_t make_timeout_time_ms(uint32_t ms) { return stub_time_us + ms * 1000ull; }
+static inline absolute_time_t delayed_by_us(absolute_time_t t, uint64_t us) { return t + us; }
+
+static inline bool time_reached(absolute_time_t t) { return stub_time_us >= t; }
+static inline int64_t absolute_time_diff_us(absolute_time_t from, absolute_time_t to) { return int64_t(to - from); }
+
+static inline void sleep_us(uint64_t us) { stub_time_us += us; }
+static inline void sleep_ms(uint32_t ms) { stub_time_us += ms * 1000ull; }
+static inline void busy_wait_us_32(uint32_t us) { stub_time_us += us; }
+
+// --> a simulated interrupt, fired once when a wait reaches its time.
+inline uint64_t stub_irq_at = 0;
+inline void (*stub_irq)() = nullptr;
+
+/* schedule the simulated interrupt at `t`. */
+static inline void stub_irq_schedule(uint64_t t, void (*irq)()) {
+    stub_irq_at = t;
+    stub_irq = irq;
+}
+
+// --> a latched event returns at once, else nothing moves the clock but us.
+static inline bool best_effort_wfe_or_timeout(absolute_time_t t) {
+    if (stub_event_consume()) {
+        return false;
+    }
+
+    // --> the interrupt comes first: wake at its time if it sets the event.
+    if (stub_irq && stub_irq_at <= t) {
+        void (*irq)() = stub_irq;
+
+        stub_irq = nullptr;
+        if (stub_time_us < stub_irq_at) {
+            stub_time_us = stub_irq_at;
+        }
+
+        irq();
+        if (stub_event_consume()) {
+            return false;
+        }
+    }
+
+    if (stub_time_us < t) {
+        stub_time_us = t;
+    }
+
+    return true;
+}
+
+/**
+ * repeating alarm stand-in: a single alarm, fired by `stub_alarm_advance()`.
+ * negative delays re-arm from the previous target, as the SDK does.
+ */
+typedef struct repeating_timer repeating_timer_t;
+typedef bool (*repeating_timer_callback_t)(repeating_timer_t* rt);
+
+struct repeating_timer {
+    int64_t delay_us;
+    void* user_data;
+    repeating_timer_callback_t callback;
+    uint64_t target;
+};
+
+inline repeating_timer_t* stub_alarm = nullptr;
+
+static inline bool add_repeating_timer_us(int64_t delay_us, 
+    repeating_timer_callback_t callback, void* user_data, repeating_timer_t* out)
+{
+    out->delay_us = delay_us;
+    out->user_data = user_data;
+    out->callback = callback;
+    out->target = stub_time_us + uint64_t(delay_us < 0 ? -delay_us : delay_us);
+
+    stub_alarm = out;
+    return true;
+}
+
+static inline bool cancel_repeating_timer(repeating_timer_t* timer) {
+    if (stub_alarm != timer) {
+        return false;
+    }
+
+    stub_alarm = nullptr;
+    return true;
+}
+
+/* move the clock to `t`, running the alarm at each of its targets on the way. */
+static inline void stub_alarm_advance(uint64_t t) {
+    while (stub_alarm && stub_alarm->target <= t) {
+        repeating_timer_t* timer = stub_alarm;
+
+        if (stub_time_us < timer->target) {
+            stub_time_us = timer->target;
+        }
+
+        if (timer->callback(timer) == false) {
+            if (stub_alarm == timer) {
+                stub_alarm = nullptr;
+            }
+
+            continue;
+        }
+
+        timer->target = timer->delay_us < 0 
+            ? timer->target + uint64_t(-timer->delay_us) 
+            : stub_time_us + uint64_t(timer->delay_us);
+    }
+
+    if (stub_time_us < t) {
+        stub_time_us = t;
+    }
+}
+
+#endif
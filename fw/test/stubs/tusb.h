@@ -0,0 +1,23 @@
+#ifndef __STUBS_TUSB_H__
+#define __STUBS_TUSB_H__
+
+#include "pico.h"
+
+#ifndef CFG_TUD_EXTERN
+#define CFG_TUD_EXTERN extern "C"
+#endif
+
+typedef enum {
+    HID_REPORT_TYPE_INVALID = 0,
+    HID_REPORT_TYPE_INPUT,
+    HID_REPORT_TYPE_OUTPUT,
+    HID_REPORT_TYPE_FEATURE
+} hid_report_type_t;
+
+enum {
+    KEYBOARD_LED_NUMLOCK = 1 << 0,
+    KEYBOARD_LED_CAPSLOCK = 1 << 1,
+    KEYBOARD_LED_SCROLLLOCK = 1 << 2,
+};
+
+#endif
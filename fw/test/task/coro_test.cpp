@@ -0,0 +1,219 @@
+#include "test.h"
+#include "task/coro.h"
+#include "task/taskqueue.h"
+#include "pico/stdlib.h"
+
+/* what a test coroutine saw, in order. */
+struct SCoroLog {
+    static constexpr uint32_t MAX_STEPS = 16;
+
+    uint32_t steps[MAX_STEPS];
+    uint32_t count;
+    bool done;
+
+    void push(uint32_t value) {
+        if (count < MAX_STEPS) {
+            steps[count++] = value;
+        }
+    }
+};
+
+/* run what is queued as core1 does, without moving the clock. */
+static void drain() {
+    TaskQueue* queue = TaskQueue::get();
+
+    queue->fireTimers();
+    queue->setSharing(true);
+    while(queue->stealOnce());
+    queue->setSharing(false);
+}
+
+/* move the simulated clock by `ms`, a millisecond at a time. */
+static void advance(uint32_t ms) {
+    while (ms--) {
+        stub_time_us += 1000;
+        drain();
+    }
+}
+
+/* spawn the coroutine so steals can run it. */
+static bool start(Coro coro) {
+    coro.setShared(true);
+    return coro.spawn();
+}
+
+static uint32_t nowMs() {
+    return to_ms_since_boot(get_absolute_time());
+}
+
+static Coro sleeper(SCoroLog* log) {
+    log->push(nowMs());
+    co_await Coro::sleepFor(5);
+
+    log->push(nowMs());
+    co_await Coro::sleepFor(10);
+
+    log->push(nowMs());
+    log->done = true;
+}
+
+TEST(coro_sleep_resumes_on_time) {
+    SCoroLog log = { };
+    const uint32_t begin = nowMs();
+
+    EXPECT(start(sleeper(&log)));
+    drain();
+
+    advance(30);
+    EXPECT(log.done);
+    EXPECT_EQ(log.count, 3);
+
+    // --> on the exact millisecond of the simulated clock.
+    EXPECT_EQ(log.steps[0], begin);
+    EXPECT_EQ(log.steps[1], begin + 5);
+    EXPECT_EQ(log.steps[2], begin + 15);
+}
+
+static Coro keyReader(SCoroLog* log) {
+    const SCoroKey first = co_await Coro::nextKey();
+    log->push((uint32_t(first.key) << 8) | first.state);
+
+    const SCoroKey second = co_await Coro::nextKey();
+    log->push((uint32_t(second.key) << 8) | second.state);
+
+    log->done = true;
+}
+
+TEST(coro_next_key_resumes_per_event) {
+    SCoroLog log = { };
+
+    EXPECT(start(keyReader(&log)));
+    drain();
+    EXPECT_EQ(log.count, 0);
+
+    Coro::notifyKey(EKEY_NUM_7, EKLS_RISE);
+    drain();
+    EXPECT_EQ(log.count, 1);
+    EXPECT_EQ(log.steps[0], (uint32_t(EKEY_NUM_7) << 8) | EKLS_RISE);
+
+    Coro::notifyKey(EKEY_NUM_7, EKLS_FALL);
+    drain();
+    EXPECT(log.done);
+    EXPECT_EQ(log.steps[1], (uint32_t(EKEY_NUM_7) << 8) | EKLS_FALL);
+}
+
+static Coro mountWaiter(SCoroLog* log, bool value) {
+    log->push(co_await Coro::mounted(value));
+    log->done = true;
+}
+
+TEST(coro_mounted_ignores_other_state) {
+    SCoroLog log = { };
+
+    Coro::notifyMounted(false);
+    EXPECT(start(mountWaiter(&log, true)));
+    drain();
+
+    Coro::notifyMounted(false);
+    drain();
+    EXPECT(log.done == false);
+
+    Coro::notifyMounted(true);
+    drain();
+    EXPECT(log.done);
+    EXPECT_EQ(log.steps[0], 1);
+}
+
+TEST(coro_mounted_already_in_state) {
+    SCoroLog log = { };
+
+    Coro::notifyMounted(true);
+    EXPECT(start(mountWaiter(&log, true)));
+
+    // --> never suspends, no signal needed.
+    drain();
+    EXPECT(log.done);
+    EXPECT_EQ(log.steps[0], 1);
+}
+
+static Coro mountRacer(SCoroLog* log) {
+    Coro::SEventAwaiter awaiter = Coro::mounted(true);
+
+    // --> mounted between taking the awaiter and suspending on it.
+    Coro::notifyMounted(true);
+
+    log->push(co_await awaiter);
+    log->done = true;
+}
+
+TEST(coro_mounted_signal_before_suspend) {
+    SCoroLog log = { };
+
+    Coro::notifyMounted(false);
+    EXPECT(start(mountRacer(&log)));
+
+    drain();
+    EXPECT(log.done);
+    EXPECT_EQ(log.steps[0], 1);
+}
+
+static Coro eventWaiter(SCoroLog* log, CoroEvent* event) {
+    Coro::SEventAwaiter awaiter = { event, CoroEvent::NONE, false, CoroEvent::NONE };
+
+    log->push(co_await awaiter);
+    log->done = true;
+}
+
+TEST(coro_event_full_resumes_none) {
+    static constexpr uint32_t COUNT = CoroEvent::MAX_WAITERS + 1;
+    SCoroLog logs[COUNT] = { };
+    CoroEvent event;
+
+    for(uint32_t i = 0; i < COUNT; ++i) {
+        EXPECT(start(eventWaiter(&logs[i], &event)));
+    }
+
+    drain();
+
+    // --> the one that found no slot is resumed at once with `NONE`.
+    uint32_t early = 0;
+    for(uint32_t i = 0; i < COUNT; ++i) {
+        if (logs[i].done) {
+            EXPECT_EQ(logs[i].steps[0], CoroEvent::NONE);
+            early++;
+        }
+    }
+
+    EXPECT_EQ(early, 1);
+
+    event.signal(42);
+    drain();
+
+    for(uint32_t i = 0; i < COUNT; ++i) {
+        EXPECT(logs[i].done);
+    }
+}
+
+TEST(coro_arena_exhausts) {
+    SCoroLog log = { };
+    Coro* coros[CoroArena::MAX_FRAMES];
+
+    for(uint32_t i = 0; i < CoroArena::MAX_FRAMES; ++i) {
+        coros[i] = new Coro(sleeper(&log));
+        EXPECT(coros[i]->isValid());
+    }
+
+    // --> no heap fallback: the frame is refused.
+    Coro extra = sleeper(&log);
+    EXPECT(extra.isValid() == false);
+    EXPECT(extra.spawn() == false);
+
+    // --> never spawned: destroying releases the frames.
+    for(uint32_t i = 0; i < CoroArena::MAX_FRAMES; ++i) {
+        delete coros[i];
+    }
+
+    Coro again = sleeper(&log);
+    EXPECT(again.isValid());
+    EXPECT_EQ(log.count, 0);
+}
@@ -0,0 +1,263 @@
+#include "test.h"
+#include "task/task.h"
+#include "task/taskqueue.h"
+#include "task/taskpool.h"
+#include <atomic>
+#include <thread>
+
+/* run all shared tasks on this thread, returns how many ran. */
+static uint32_t drain() {
+    TaskQueue* queue = TaskQueue::get();
+    uint32_t count = 0;
+
+    queue->setSharing(true);
+    while(queue->stealOnce()) {
+        count++;
+    }
+
+    queue->setSharing(false);
+    return count;
+}
+
+/* count runs, and requeue once from the callback if asked. */
+struct SCounter {
+    uint32_t runs;
+    uint32_t requeues;
+    ETaskState seen;
+};
+
+static void onCount(const Task* task) {
+    SCounter* counter = (SCounter*) task->getUser();
+
+    counter->runs++;
+    counter->seen = task->getState();
+
+    if (counter->requeues) {
+        counter->requeues--;
+        const_cast<Task*>(task)->reserve(true);
+    }
+}
+
+/* create a task that steals can run. */
+static Task* createShared(SCounter* counter) {
+    Task* task = Task::create(onCount, counter);
+
+    task->setShared(true);
+    return task;
+}
+
+TEST(task_reserve_queues_once) {
+    SCounter counter = { };
+    Task* task = createShared(&counter);
+
+    EXPECT_EQ(task->getState(), ETASK_NONE);
+    EXPECT(task->reserve());
+    EXPECT_EQ(task->getState(), ETASK_QUEUED);
+
+    // --> already queued: accepted, but never queued twice.
+    EXPECT(task->reserve());
+    EXPECT_EQ(drain(), 1);
+    EXPECT_EQ(counter.runs, 1);
+
+    task->drop();
+}
+
+TEST(task_runs_to_done) {
+    SCounter counter = { };
+    Task* task = createShared(&counter);
+
+    EXPECT(task->reserve());
+    EXPECT_EQ(drain(), 1);
+
+    EXPECT_EQ(counter.seen, ETASK_EXECUTE);
+    EXPECT_EQ(task->getState(), ETASK_DONE);
+
+    task->drop();
+}
+
+TEST(task_reserve_after_done) {
+    SCounter counter = { };
+    Task* task = createShared(&counter);
+
+    EXPECT(task->reserve());
+    EXPECT_EQ(drain(), 1);
+
+    // --> done rewinds to none, then queues again.
+    EXPECT(task->reserve());
+    EXPECT_EQ(task->getState(), ETASK_QUEUED);
+    EXPECT_EQ(drain(), 1);
+
+    EXPECT_EQ(counter.runs, 2);
+    EXPECT_EQ(task->getState(), ETASK_DONE);
+
+    task->drop();
+}
+
+TEST(task_requeue_while_executing) {
+    SCounter counter = { };
+    Task* task = createShared(&counter);
+
+    // --> reserved from its own callback: runs again in the same steal.
+    counter.requeues = 2;
+
+    EXPECT(task->reserve());
+    EXPECT_EQ(drain(), 1);
+
+    EXPECT_EQ(counter.runs, 3);
+    EXPECT_EQ(task->getState(), ETASK_DONE);
+
+    task->drop();
+}
+
+TEST(task_reserve_without_requeue_while_executing) {
+    struct SLocal {
+        static void onRun(const Task* task) {
+            bool* result = (bool*) task->getUser();
+            *result = const_cast<Task*>(task)->reserve();
+        }
+    };
+
+    bool result = true;
+    Task* task = Task::create(SLocal::onRun, &result);
+
+    task->setShared(true);
+
+    // --> executing and no requeue: refused, so it runs once.
+    EXPECT(task->reserve());
+    EXPECT_EQ(drain(), 1);
+
+    EXPECT(result == false);
+    EXPECT_EQ(task->getState(), ETASK_DONE);
+
+    task->drop();
+}
+
+TEST(task_refs_outlive_queue) {
+    SCounter counter = { };
+    Task* task = createShared(&counter);
+
+    // --> the queue holds its own reference until the task ran.
+    EXPECT(task->reserve());
+    EXPECT(task->drop() == false);
+
+    EXPECT_EQ(drain(), 1);
+    EXPECT_EQ(counter.runs, 1);
+}
+
+TEST(task_pooled_stripes_spread) {
+    TaskPool* pool = TaskPool::get();
+    Task* tasks[TaskPool::MAX_TASKS];
+    uint32_t stripes[TaskQueue::MAX_LOCKS] = { 0, };
+
+    for(uint32_t i = 0; i < TaskPool::MAX_TASKS; ++i) {
+        tasks[i] = Task::create(nullptr, nullptr);
+        EXPECT(pool->owns(tasks[i]));
+
+        stripes[TaskQueue::stripeOf(tasks[i])]++;
+    }
+
+    // --> every stripe takes a fair share of the pool.
+    for(uint32_t i = 0; i < TaskQueue::MAX_LOCKS; ++i) {
+        EXPECT(stripes[i] >= TaskPool::MAX_TASKS / TaskQueue::MAX_LOCKS / 2);
+    }
+
+    for(uint32_t i = 0; i < TaskPool::MAX_TASKS; ++i) {
+        tasks[i]->drop();
+    }
+}
+
+/**
+ * contention stress: two cores grab, drop, reserve and steal the same tasks.
+ */
+struct SStress {
+    static constexpr uint32_t TASKS = 16;
+    static constexpr uint32_t ROUNDS = 200000;
+
+    Task* tasks[TASKS];
+    std::atomic<uint32_t> inside[TASKS];
+    std::atomic<uint32_t> runs;
+    std::atomic<uint32_t> overlaps;
+
+    static void onRun(const Task* task) {
+        SStress* stress = g_stress;
+        const uint32_t n = uint32_t(uintptr_t(task->getUser()));
+
+        // --> a task never runs on both cores at once.
+        if (stress->inside[n].exchange(1)) {
+            stress->overlaps++;
+        }
+
+        stress->runs++;
+        stress->inside[n] = 0;
+    }
+
+    /* the loop of a core. */
+    void run(uint32_t core, uint32_t seed) {
+        TaskQueue* queue = TaskQueue::get();
+        uint32_t state = seed;
+
+        stub_core_num = core;
+
+        for(uint32_t i = 0; i < ROUNDS; ++i) {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+
+            Task* task = tasks[state % TASKS];
+
+            task->grab();
+            if (state & 0x100) {
+                task->reserve(true);
+            }
+
+            task->drop();
+
+            if ((state & 0x7) == 0) {
+                queue->stealOnce();
+            }
+        }
+    }
+
+    static SStress* g_stress;
+};
+
+SStress* SStress::g_stress = nullptr;
+
+TEST(task_stress_two_cores) {
+    static SStress stress;
+    TaskPool* pool = TaskPool::get();
+    TaskQueue* queue = TaskQueue::get();
+    const uint32_t used = pool->getUsed();
+
+    SStress::g_stress = &stress;
+    stress.runs = stress.overlaps = 0;
+
+    for(uint32_t i = 0; i < SStress::TASKS; ++i) {
+        stress.tasks[i] = Task::create(SStress::onRun, (void*) uintptr_t(i));
+        stress.tasks[i]->setShared(true);
+        stress.inside[i] = 0;
+    }
+
+    queue->setSharing(true);
+
+    std::thread core1([]() { stress.run(1, 0x9e3779b9u); });
+    stress.run(0, 0x12345678u);
+    core1.join();
+
+    stub_core_num = 0;
+    while(queue->stealOnce());
+    queue->setSharing(false);
+
+    EXPECT_EQ(stress.overlaps, 0);
+    EXPECT(stress.runs > 0);
+
+    // --> no reference lost or leaked: the last drops free every slot.
+    for(uint32_t i = 0; i < SStress::TASKS; ++i) {
+        const ETaskState state = stress.tasks[i]->getState();
+
+        EXPECT(state == ETASK_NONE || state == ETASK_DONE);
+        EXPECT(stress.tasks[i]->drop());
+    }
+
+    EXPECT_EQ(pool->getUsed(), used);
+}
@@ -0,0 +1,188 @@
+#include "test.h"
+#include "task/task.h"
+#include "task/taskqueue.h"
+#include "task/tasklink.h"
+
+/* run a shared task on this thread, returns false if nothing to run. */
+static bool stealOnce() {
+    TaskQueue* queue = TaskQueue::get();
+
+    queue->setSharing(true);
+    const bool ran = queue->stealOnce();
+
+    queue->setSharing(false);
+    return ran;
+}
+
+/* run all shared tasks on this thread, returns how many ran. */
+static uint32_t drain() {
+    uint32_t count = 0;
+
+    while(stealOnce()) {
+        count++;
+    }
+
+    return count;
+}
+
+/* record the initial result and the run count of the task. */
+struct SProbe {
+    uint32_t runs;
+    void* seen;
+    void* result;
+};
+
+static void onProbe(const Task* task) {
+    SProbe* probe = (SProbe*) task->getUser();
+    Task* self = const_cast<Task*>(task);
+
+    probe->runs++;
+    probe->seen = self->getResult();
+
+    if (probe->result) {
+        self->setResult(probe->result);
+    }
+}
+
+/* create a task that steals can run. */
+static Task* createShared(SProbe* probe) {
+    Task* task = Task::create(onProbe, probe);
+
+    task->setShared(true);
+    return task;
+}
+
+TEST(tasklink_then_propagates_result) {
+    static int value = 42;
+
+    SProbe first = { 0, nullptr, &value };
+    SProbe second = { };
+
+    Task* task = createShared(&first);
+    Task* next = task->then(onProbe, &second);
+
+    EXPECT(next != nullptr);
+    next->setShared(true);
+
+    // --> not reserved until the antecedent is done.
+    EXPECT_EQ(next->getState(), ETASK_NONE);
+    EXPECT(task->reserve());
+
+    EXPECT_EQ(drain(), 2);
+    EXPECT_EQ(second.runs, 1);
+    EXPECT(second.seen == &value);
+    EXPECT_EQ(next->getState(), ETASK_DONE);
+
+    next->drop();
+    task->drop();
+}
+
+TEST(tasklink_then_after_done) {
+    SProbe first = { };
+    SProbe second = { };
+
+    Task* task = createShared(&first);
+    EXPECT(task->reserve());
+    EXPECT_EQ(drain(), 1);
+
+    // --> already done: reserved immediately, as a non-shared task.
+    Task* next = task->then(onProbe, &second);
+
+    EXPECT(next != nullptr);
+    EXPECT_EQ(next->getState(), ETASK_QUEUED);
+
+    next->drop();
+    task->drop();
+}
+
+TEST(tasklink_when_all_joins) {
+    static constexpr uint32_t COUNT = 3;
+
+    SProbe probes[COUNT] = { };
+    SProbe joined = { };
+    Task* tasks[COUNT];
+
+    for(uint32_t i = 0; i < COUNT; ++i) {
+        tasks[i] = createShared(&probes[i]);
+    }
+
+    Task* join = Task::whenAll(tasks, COUNT, onProbe, &joined);
+    EXPECT(join != nullptr);
+    join->setShared(true);
+
+    // --> antecedents finish one by one, the join waits for the last.
+    for(uint32_t i = 0; i < COUNT; ++i) {
+        EXPECT_EQ(join->getState(), ETASK_NONE);
+        EXPECT(tasks[i]->reserve());
+        EXPECT(stealOnce());
+    }
+
+    EXPECT_EQ(join->getState(), ETASK_QUEUED);
+    EXPECT_EQ(drain(), 1);
+
+    EXPECT_EQ(joined.runs, 1);
+    EXPECT_EQ(join->getState(), ETASK_DONE);
+
+    join->drop();
+    for(uint32_t i = 0; i < COUNT; ++i) {
+        tasks[i]->drop();
+    }
+}
+
+TEST(tasklink_when_all_too_many) {
+    Task* task = Task::create(nullptr, nullptr);
+    Task* tasks[TaskLinkPool::MAX_LINKS + 1];
+
+    for(uint32_t i = 0; i <= TaskLinkPool::MAX_LINKS; ++i) {
+        tasks[i] = task;
+    }
+
+    // --> never a partial chain.
+    EXPECT(Task::whenAll(tasks, TaskLinkPool::MAX_LINKS + 1, nullptr, nullptr) == nullptr);
+
+    task->drop();
+}
+
+TEST(tasklink_links_released_on_drop) {
+    TaskLinkPool* links = TaskLinkPool::get();
+    STaskLink* all[TaskLinkPool::MAX_LINKS];
+
+    // --> never done: dropping the antecedent frees its links.
+    for(uint32_t round = 0; round < 2; ++round) {
+        Task* task = Task::create(nullptr, nullptr);
+
+        for(uint32_t i = 0; i < TaskLinkPool::MAX_LINKS; ++i) {
+            Task* next = task->then(nullptr, nullptr);
+
+            EXPECT(next != nullptr);
+            next->drop();
+        }
+
+        EXPECT(task->then(nullptr, nullptr) == nullptr);
+        task->drop();
+    }
+
+    uint32_t count = 0;
+    while(count < TaskLinkPool::MAX_LINKS && (all[count] = links->alloc(nullptr))) {
+        count++;
+    }
+
+    EXPECT_EQ(count, TaskLinkPool::MAX_LINKS);
+    while(count > 0) {
+        links->free(all[--count]);
+    }
+}
+
+TEST(tasklink_wait) {
+    SProbe probe = { };
+    Task* task = createShared(&probe);
+
+    // --> nobody runs it: times out.
+    EXPECT(task->reserve());
+    EXPECT(task->wait(5) == false);
+
+    EXPECT_EQ(drain(), 1);
+    EXPECT(task->wait(5));
+
+    task->drop();
+}
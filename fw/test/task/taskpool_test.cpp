@@ -0,0 +1,141 @@
+#include "test.h"
+#include "task/task.h"
+#include "task/taskpool.h"
+#include <chrono>
+#include <stdio.h>
+
+TEST(taskpool_alloc_free) {
+    TaskPool* pool = TaskPool::get();
+    const uint32_t used = pool->getUsed();
+
+    void* a = pool->alloc();
+    void* b = pool->alloc();
+
+    EXPECT(a != nullptr && b != nullptr && a != b);
+    EXPECT(pool->owns(a) && pool->owns(b));
+    EXPECT_EQ(pool->getUsed(), used + 2);
+
+    // --> slots are aligned for the task and never overlap.
+    EXPECT_EQ(uintptr_t(a) % TaskPool::ALIGN, 0);
+    const intptr_t gap = (uint8_t*) b - (uint8_t*) a;
+    EXPECT(gap >= intptr_t(sizeof(Task)) || -gap >= intptr_t(sizeof(Task)));
+
+    pool->free(a);
+    pool->free(b);
+    EXPECT_EQ(pool->getUsed(), used);
+}
+
+TEST(taskpool_reuses_freed_slot) {
+    TaskPool* pool = TaskPool::get();
+
+    void* a = pool->alloc();
+    pool->free(a);
+
+    // --> LIFO free list: the hot slot comes back first.
+    void* b = pool->alloc();
+    EXPECT(a == b);
+
+    pool->free(b);
+}
+
+TEST(taskpool_exhaustion) {
+    TaskPool* pool = TaskPool::get();
+    void* slots[TaskPool::MAX_TASKS];
+
+    uint32_t count = 0;
+    while(count < TaskPool::MAX_TASKS && (slots[count] = pool->alloc())) {
+        count++;
+    }
+
+    EXPECT_EQ(pool->getUsed(), TaskPool::MAX_TASKS);
+    EXPECT(pool->alloc() == nullptr);
+
+    int local = 0;
+    EXPECT(pool->owns(&local) == false);
+
+    while(count) {
+        pool->free(slots[--count]);
+    }
+
+    EXPECT_EQ(pool->getUsed(), 0);
+}
+
+TEST(taskpool_task_create_drop) {
+    TaskPool* pool = TaskPool::get();
+    const uint32_t used = pool->getUsed();
+
+    Task* task = Task::create(nullptr, nullptr);
+
+    EXPECT(pool->owns(task));
+    EXPECT_EQ(pool->getUsed(), used + 1);
+    EXPECT(task->getState() == ETASK_NONE);
+
+    // --> the last reference returns the slot.
+    task->grab();
+    EXPECT(task->drop() == false);
+    EXPECT(task->drop());
+    EXPECT_EQ(pool->getUsed(), used);
+}
+
+TEST(taskpool_task_heap_fallback) {
+    TaskPool* pool = TaskPool::get();
+    Task* tasks[TaskPool::MAX_TASKS];
+
+    for(uint32_t i = 0; i < TaskPool::MAX_TASKS; ++i) {
+        tasks[i] = Task::create(nullptr, nullptr);
+    }
+
+    const uint32_t fallbacks = pool->getFallbacks();
+    Task* extra = Task::create(nullptr, nullptr);
+
+    EXPECT(pool->owns(extra) == false);
+    EXPECT_EQ(pool->getFallbacks(), fallbacks + 1);
+
+    extra->drop();
+
+    for(uint32_t i = 0; i < TaskPool::MAX_TASKS; ++i) {
+        tasks[i]->drop();
+    }
+
+    EXPECT_EQ(pool->getUsed(), 0);
+}
+
+/* create and drop `count` tasks, returns nanoseconds per pair. */
+static double benchCreateDrop(uint32_t count) {
+    const auto begin = std::chrono::steady_clock::now();
+
+    for(uint32_t i = 0; i < count; ++i) {
+        Task* task = Task::create(nullptr, nullptr);
+        task->drop();
+    }
+
+    const auto end = std::chrono::steady_clock::now();
+    return double(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count()) / count;
+}
+
+TEST(taskpool_bench) {
+    static constexpr uint32_t COUNT = 200000;
+
+    TaskPool* pool = TaskPool::get();
+    Task* tasks[TaskPool::MAX_TASKS];
+
+    const double pooled = benchCreateDrop(COUNT);
+
+    // --> exhausted: every create falls back to the heap.
+    for(uint32_t i = 0; i < TaskPool::MAX_TASKS; ++i) {
+        tasks[i] = Task::create(nullptr, nullptr);
+    }
+
+    const uint32_t fallbacks = pool->getFallbacks();
+    const double heap = benchCreateDrop(COUNT);
+
+    EXPECT_EQ(pool->getFallbacks(), fallbacks + COUNT);
+
+    for(uint32_t i = 0; i < TaskPool::MAX_TASKS; ++i) {
+        tasks[i]->drop();
+    }
+
+    EXPECT_EQ(pool->getUsed(), 0);
+    printf("  create/drop: pool %.1f ns, heap %.1f ns (x%.2f)\n",
+        pooled, heap, pooled > 0 ? heap / pooled : 0.0);
+}
@@ -0,0 +1,86 @@
+#include "test.h"
+#include "task/task.h"
+#include "task/taskqueue.h"
+#include "tft/tft.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <stdio.h>
+
+typedef std::chrono::steady_clock clock_type;
+
+/* chunks of the fake TTY repaint, 2 ms each. */
+static constexpr uint32_t REPAINT_US = 4 * 2000;
+
+/* spawned from core0 while core1 repaints. */
+struct SProbe {
+    std::atomic<uint32_t> runs;
+    clock_type::time_point ran;
+};
+
+static void onProbe(const Task* task) {
+    SProbe* probe = (SProbe*) task->getUser();
+
+    probe->ran = clock_type::now();
+    probe->runs++;
+}
+
+/**
+ * spawn probes of the priority while the display keeps repainting,
+ * returns the worst spawn-to-execute latency in microseconds.
+ */
+static uint32_t measure(ETaskPriority priority, uint32_t count, uint32_t& timeouts) {
+    static SProbe probe;
+    uint32_t worst = 0;
+
+    probe.runs = 0;
+    for(uint32_t i = 1; i <= count; ++i) {
+        // --> spread over the chunks of a repaint.
+        Tft::get()->clear();
+        std::this_thread::sleep_for(std::chrono::microseconds(300 * (i % 7)));
+
+        Task* task = Task::create(onProbe, &probe, priority);
+        const auto spawned = clock_type::now();
+
+        while(task->reserve() == false);
+        task->drop();
+
+        const auto until = spawned + std::chrono::seconds(1);
+        while(probe.runs < i && clock_type::now() < until) {
+            std::this_thread::yield();
+        }
+
+        if (probe.runs < i) {
+            timeouts++;
+            break;
+        }
+
+        const uint32_t us = uint32_t(std::chrono::duration_cast<std::chrono::microseconds>(probe.ran - spawned).count());
+        if (us > worst) {
+            worst = us;
+        }
+    }
+
+    return worst;
+}
+
+TEST(taskprio_core1_starts) {
+    TaskQueue::prepare();
+}
+
+TEST(taskprio_realtime_during_redraw) {
+    static constexpr uint32_t COUNT = 200;
+    uint32_t timeouts = 0;
+
+    const uint32_t normal = measure(ETASK_PRIO_NORMAL, COUNT, timeouts);
+    const uint32_t realtime = measure(ETASK_PRIO_REALTIME, COUNT, timeouts);
+    const uint32_t background = measure(ETASK_PRIO_BACKGROUND, COUNT / 4, timeouts);
+
+    EXPECT_EQ(timeouts, 0);
+
+    // --> realtime tasks wait for a chunk at most, never the whole repaint.
+    EXPECT(realtime < REPAINT_US);
+
+    printf("  worst spawn to execute while repainting (%u us a repaint):\n", REPAINT_US);
+    printf("    realtime %u us, normal %u us, background %u us\n", realtime, normal, background);
+}
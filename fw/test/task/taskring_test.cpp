@@ -0,0 +1,207 @@
+#include "test.h"
+#include "task/taskring.h"
+#include "pico/critical_section.h"
+#include <chrono>
+#include <thread>
+#include <stdio.h>
+
+/* make a fake task pointer, never dereferenced by the ring. */
+static Task* fakeTask(uint32_t n) {
+    return reinterpret_cast<Task*>(uintptr_t(n + 1) * 8);
+}
+
+TEST(taskring_pop_empty) {
+    TaskRing ring;
+    Task* task = nullptr;
+
+    EXPECT(ring.isEmpty());
+    EXPECT(ring.pop(&task) == false);
+    EXPECT(task == nullptr);
+}
+
+TEST(taskring_fifo_order) {
+    TaskRing ring;
+
+    for(uint32_t i = 0; i < 5; ++i) {
+        EXPECT(ring.push(fakeTask(i)));
+    }
+
+    EXPECT_EQ(ring.size(), 5);
+
+    for(uint32_t i = 0; i < 5; ++i) {
+        Task* task = nullptr;
+
+        EXPECT(ring.pop(&task));
+        EXPECT(task == fakeTask(i));
+    }
+
+    EXPECT(ring.isEmpty());
+}
+
+TEST(taskring_full) {
+    TaskRing ring;
+    Task* task = nullptr;
+
+    for(uint32_t i = 0; i < TaskRing::MAX_SLOTS; ++i) {
+        EXPECT(ring.push(fakeTask(i)));
+    }
+
+    // --> no slot is sacrificed to tell full from empty.
+    EXPECT_EQ(ring.size(), TaskRing::MAX_SLOTS);
+    EXPECT(ring.push(fakeTask(99)) == false);
+
+    EXPECT(ring.pop(&task));
+    EXPECT(task == fakeTask(0));
+    EXPECT(ring.push(fakeTask(99)));
+    EXPECT_EQ(ring.size(), TaskRing::MAX_SLOTS);
+}
+
+TEST(taskring_wraps_slots) {
+    TaskRing ring;
+    uint32_t next = 0, expect = 0;
+
+    // --> keep it half full while positions run over the slots many times.
+    for(uint32_t i = 0; i < TaskRing::MAX_SLOTS / 2; ++i) {
+        EXPECT(ring.push(fakeTask(next++)));
+    }
+
+    for(uint32_t i = 0; i < TaskRing::MAX_SLOTS * 10 + 3; ++i) {
+        Task* task = nullptr;
+
+        EXPECT(ring.push(fakeTask(next++)));
+        EXPECT(ring.pop(&task));
+        EXPECT(task == fakeTask(expect++));
+    }
+
+    EXPECT_EQ(ring.size(), TaskRing::MAX_SLOTS / 2);
+}
+
+TEST(taskring_pop_null_out) {
+    TaskRing ring;
+
+    EXPECT(ring.push(fakeTask(0)));
+    EXPECT(ring.pop(nullptr));
+    EXPECT(ring.isEmpty());
+}
+
+TEST(taskring_spsc_threads) {
+    static constexpr uint32_t COUNT = 200000;
+
+    TaskRing ring;
+    uint32_t errors = 0;
+
+    // --> one producer and one consumer, as core0 and core1 do.
+    std::thread producer([&ring]() {
+        for(uint32_t i = 0; i < COUNT; ++i) {
+            while(ring.push(fakeTask(i)) == false) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    for(uint32_t i = 0; i < COUNT; ++i) {
+        Task* task = nullptr;
+
+        while(ring.pop(&task) == false) {
+            std::this_thread::yield();
+        }
+
+        if (task != fakeTask(i)) {
+            errors++;
+        }
+    }
+
+    producer.join();
+
+    EXPECT_EQ(errors, 0);
+    EXPECT(ring.isEmpty());
+}
+
+/**
+ * the locked queue `TaskRing` replaced: one critical section for both cores.
+ * the old one also slept 5 us after every call, left out here.
+ */
+class LockedQueue {
+private:
+    Task* _slots[TaskRing::MAX_SLOTS];
+    uint32_t _rpos, _wpos, _size;
+    critical_section_t _cs;
+
+public:
+    LockedQueue() : _rpos(0), _wpos(0), _size(0) { critical_section_init(&_cs); }
+
+public:
+    bool push(Task* task) {
+        bool result = false;
+
+        critical_section_enter_blocking(&_cs);
+        if (_size < TaskRing::MAX_SLOTS) {
+            _slots[_wpos++ & TaskRing::MASK] = task;
+            _size++;
+            result = true;
+        }
+
+        critical_section_exit(&_cs);
+        return result;
+    }
+
+    bool pop(Task** outTask) {
+        bool result = false;
+
+        critical_section_enter_blocking(&_cs);
+        if (_size > 0) {
+            *outTask = _slots[_rpos++ & TaskRing::MASK];
+            _size--;
+            result = true;
+        }
+
+        critical_section_exit(&_cs);
+        return result;
+    }
+};
+
+/* pass `count` tasks from a producer thread, returns push+pop ops per second. */
+template<typename TQueue>
+static double benchQueue(TQueue& queue, uint32_t count, uint32_t& errors) {
+    const auto begin = std::chrono::steady_clock::now();
+
+    std::thread producer([&queue, count]() {
+        for(uint32_t i = 0; i < count; ++i) {
+            while(queue.push(fakeTask(i)) == false) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    for(uint32_t i = 0; i < count; ++i) {
+        Task* task = nullptr;
+
+        while(queue.pop(&task) == false) {
+            std::this_thread::yield();
+        }
+
+        if (task != fakeTask(i)) {
+            errors++;
+        }
+    }
+
+    producer.join();
+
+    const auto end = std::chrono::steady_clock::now();
+    const uint64_t us = std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count();
+    return us ? double(count) * 2 * 1e6 / double(us) : 0.0;
+}
+
+TEST(taskring_bench) {
+    static constexpr uint32_t COUNT = 500000;
+    static LockedQueue locked;
+    static TaskRing ring;
+    uint32_t errors = 0;
+
+    const double lockedOps = benchQueue(locked, COUNT, errors);
+    const double ringOps = benchQueue(ring, COUNT, errors);
+
+    EXPECT_EQ(errors, 0);
+    printf("  %u tasks: locked %.2f Mops/s, ring %.2f Mops/s (x%.2f)\n",
+        COUNT, lockedOps / 1e6, ringOps / 1e6, lockedOps > 0 ? ringOps / lockedOps : 0.0);
+}
@@ -0,0 +1,185 @@
+#include "test.h"
+#include "task/task.h"
+#include "task/taskqueue.h"
+#include "pico.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <stdio.h>
+
+static void onRun(const Task* task) {
+    uint32_t* runs = (uint32_t*) task->getUser();
+    (*runs)++;
+}
+
+/* create a shared task that counts its runs. */
+static Task* createShared(uint32_t* runs) {
+    Task* task = Task::create(onRun, runs);
+
+    task->setShared(true);
+    return task;
+}
+
+TEST(taskshare_disabled) {
+    TaskQueue* queue = TaskQueue::get();
+    uint32_t runs = 0;
+
+    Task* task = createShared(&runs);
+    EXPECT(task->reserve());
+
+    // --> opt-in: nothing is stolen until enabled.
+    EXPECT(queue->isSharing() == false);
+    EXPECT(queue->stealOnce() == false);
+    EXPECT_EQ(task->getState(), ETASK_QUEUED);
+
+    queue->setSharing(true);
+    EXPECT(queue->stealOnce());
+    EXPECT(queue->stealOnce() == false);
+    queue->setSharing(false);
+
+    EXPECT_EQ(runs, 1);
+    task->drop();
+}
+
+TEST(taskshare_only_shared) {
+    TaskQueue* queue = TaskQueue::get();
+    uint32_t runs = 0;
+
+    // --> core1-only tasks are never stolen.
+    Task* task = Task::create(onRun, &runs);
+    EXPECT(task->reserve());
+
+    queue->setSharing(true);
+    EXPECT(queue->stealOnce() == false);
+    queue->setSharing(false);
+
+    EXPECT_EQ(runs, 0);
+    EXPECT_EQ(task->getState(), ETASK_QUEUED);
+
+    task->drop();
+}
+
+TEST(taskshare_both_producers) {
+    TaskQueue* queue = TaskQueue::get();
+    uint32_t runs = 0;
+
+    Task* first = createShared(&runs);
+    Task* second = createShared(&runs);
+
+    // --> each core pushes its own ring, stealing drains both.
+    EXPECT(first->reserve());
+    std::thread([&]() {
+        stub_core_num = 1;
+        EXPECT(second->reserve());
+    }).join();
+
+    queue->setSharing(true);
+    EXPECT(queue->stealOnce());
+    EXPECT(queue->stealOnce());
+    EXPECT(queue->stealOnce() == false);
+    queue->setSharing(false);
+
+    EXPECT_EQ(runs, 2);
+    first->drop();
+    second->drop();
+}
+
+/**
+ * throughput of shared jobs, with core0 alone or with core1 helping.
+ * core0 produces and steals when the ring is full, like the main loop.
+ */
+struct SBench {
+    static constexpr uint32_t JOBS = 20000;
+    static constexpr uint32_t WORK_US = 5;
+
+    std::atomic<uint32_t> done;
+    std::atomic<uint32_t> twice;
+    std::atomic<uint8_t> marks[JOBS];
+
+    static void onJob(const Task* task) {
+        SBench* bench = (SBench*) task->getUser();
+        const uint32_t job = uint32_t(uintptr_t(task->getResult()));
+
+        // --> burn the time a job would take on the core.
+        const auto until = std::chrono::steady_clock::now() + std::chrono::microseconds(WORK_US);
+        while(std::chrono::steady_clock::now() < until);
+
+        if (bench->marks[job].exchange(1)) {
+            bench->twice++;
+        }
+
+        bench->done++;
+    }
+
+    /* run all jobs, returns the elapsed time in microseconds. */
+    uint64_t run(bool helper) {
+        TaskQueue* queue = TaskQueue::get();
+        std::atomic<bool> stop = false;
+        std::thread core1;
+
+        done = 0;
+        twice = 0;
+        for(uint32_t i = 0; i < JOBS; ++i) {
+            marks[i] = 0;
+        }
+
+        queue->setSharing(true);
+        const auto begin = std::chrono::steady_clock::now();
+
+        if (helper) {
+            core1 = std::thread([&]() {
+                stub_core_num = 1;
+
+                while(stop == false) {
+                    if (queue->stealOnce() == false) {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+
+        for(uint32_t i = 0; i < JOBS; ++i) {
+            Task* task = Task::create(onJob, this);
+
+            task->setShared(true);
+            task->setResult((void*) uintptr_t(i));
+
+            while(task->reserve() == false) {
+                queue->stealOnce();
+            }
+
+            task->drop();
+        }
+
+        while(done < JOBS) {
+            queue->stealOnce();
+        }
+
+        const auto end = std::chrono::steady_clock::now();
+        stop = true;
+
+        if (helper) {
+            core1.join();
+        }
+
+        queue->setSharing(false);
+        return std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count();
+    }
+};
+
+TEST(taskshare_bench) {
+    static SBench bench;
+
+    const uint64_t alone = bench.run(false);
+    EXPECT_EQ(bench.done, SBench::JOBS);
+    EXPECT_EQ(bench.twice, 0);
+
+    // --> two consumers: every job still runs exactly once.
+    const uint64_t shared = bench.run(true);
+    EXPECT_EQ(bench.done, SBench::JOBS);
+    EXPECT_EQ(bench.twice, 0);
+
+    printf("  %u jobs: 1 consumer %llu us, 2 consumers %llu us (x%.2f)\n",
+        SBench::JOBS, (unsigned long long) alone, (unsigned long long) shared,
+        shared ? double(alone) / double(shared) : 0.0);
+}
@@ -0,0 +1,103 @@
+#include "test.h"
+#include "task/task.h"
+#include "task/taskqueue.h"
+#include "task/taskstats.h"
+#include "pico.h"
+
+TEST(taskstats_bucket_of) {
+    EXPECT_EQ(TaskStats::bucketOf(0), 0);
+    EXPECT_EQ(TaskStats::bucketOf(1), 1);
+
+    // --> n for [2^(n-1), 2^n).
+    for(uint32_t n = 2; n < TaskStats::MAX_BUCKETS; ++n) {
+        EXPECT_EQ(TaskStats::bucketOf(1u << (n - 1)), n);
+        EXPECT_EQ(TaskStats::bucketOf((1u << n) - 1), n);
+    }
+
+    // --> everything longer goes to the last bucket.
+    EXPECT_EQ(TaskStats::bucketOf(1u << 15), TaskStats::MAX_BUCKETS - 1);
+    EXPECT_EQ(TaskStats::bucketOf(UINT32_MAX), TaskStats::MAX_BUCKETS - 1);
+}
+
+TEST(taskstats_execute_histogram) {
+    TaskStats* stats = TaskStats::get();
+    STaskStats before, after;
+
+    stats->snapshot(before);
+    stats->onExecute(0);
+    stats->onExecute(3);
+    stats->onExecute(3);
+    stats->onExecute(1000);
+
+    stats->snapshot(after);
+    EXPECT_EQ(after.executed - before.executed, 4);
+    EXPECT_EQ(after.execHist[0] - before.execHist[0], 1);
+    EXPECT_EQ(after.execHist[2] - before.execHist[2], 2);
+    EXPECT_EQ(after.execHist[10] - before.execHist[10], 1);
+}
+
+TEST(taskstats_redraw_carry) {
+    TaskStats* stats = TaskStats::get();
+    STaskStats before, after;
+
+    stats->snapshot(before);
+
+    // --> wraps the low word more than once.
+    for(uint32_t i = 0; i < 5; ++i) {
+        stats->onRedraw(0x80000000u);
+    }
+
+    stats->onRedraw(7);
+    stats->snapshot(after);
+
+    EXPECT_EQ(after.redraws - before.redraws, 6);
+    EXPECT_EQ(after.redrawUs - before.redrawUs, 5 * 0x80000000ull + 7);
+    EXPECT_EQ(after.redrawHist[TaskStats::MAX_BUCKETS - 1] - before.redrawHist[TaskStats::MAX_BUCKETS - 1], 5);
+    EXPECT_EQ(after.redrawHist[3] - before.redrawHist[3], 1);
+}
+
+TEST(taskstats_sums_cores) {
+    TaskStats* stats = TaskStats::get();
+    STaskStats before, after;
+
+    stats->snapshot(before);
+
+    stub_core_num = 0;
+    stats->onEnqueue(before.ringHwm + 3);
+    stats->onEnqueueFail();
+
+    stub_core_num = 1;
+    stats->onEnqueue(before.ringHwm + 5);
+    stats->onEnqueue(1);
+    stats->onEnqueueFail();
+
+    stub_core_num = 0;
+    stats->snapshot(after);
+
+    // --> counters are summed, the ring high-water mark is the max of cores.
+    EXPECT_EQ(after.enqueued - before.enqueued, 3);
+    EXPECT_EQ(after.enqueueFails - before.enqueueFails, 2);
+    EXPECT_EQ(after.ringHwm, before.ringHwm + 5);
+}
+
+TEST(taskstats_records_queue) {
+    TaskStats* stats = TaskStats::get();
+    TaskQueue* queue = TaskQueue::get();
+    STaskStats before, after;
+
+    Task* task = Task::create([](const Task*) { }, nullptr);
+    task->setShared(true);
+
+    stats->snapshot(before);
+    EXPECT(task->reserve());
+
+    queue->setSharing(true);
+    EXPECT(queue->stealOnce());
+    queue->setSharing(false);
+
+    stats->snapshot(after);
+    EXPECT_EQ(after.enqueued - before.enqueued, 1);
+    EXPECT_EQ(after.executed - before.executed, 1);
+
+    task->drop();
+}
@@ -0,0 +1,267 @@
+#include "test.h"
+#include "task/task.h"
+#include "task/tasktimer.h"
+#include "task/taskqueue.h"
+#include "pico/stdlib.h"
+
+/* step the wheel a millisecond at a time, returns when the task fired or `UINT32_MAX`. */
+static uint32_t stepUntil(TaskTimer& timer, const Task* task, uint32_t from, uint32_t to) {
+    for(uint32_t now = from; now != to + 1; ++now) {
+        while(Task* fired = timer.expire(now)) {
+            if (fired == task) {
+                return now;
+            }
+        }
+    }
+
+    return UINT32_MAX;
+}
+
+TEST(tasktimer_fires_at_deadline) {
+    TaskTimer timer;
+    Task* task = Task::create(nullptr, nullptr);
+
+    timer.insert(task, 10);
+    EXPECT_EQ(timer.size(), 1);
+
+    EXPECT(timer.expire(9) == nullptr);
+    EXPECT(timer.expire(10) == task);
+    EXPECT_EQ(timer.size(), 0);
+
+    task->drop();
+}
+
+TEST(tasktimer_cascades_exactly) {
+    static constexpr uint32_t DEADLINES[] = { 3, 63, 64, 70, 4095, 4096, 5000, 100000 };
+    static constexpr uint32_t COUNT = sizeof(DEADLINES) / sizeof(DEADLINES[0]);
+
+    TaskTimer timer;
+    Task* tasks[COUNT];
+
+    // --> every level, and both sides of the level boundaries.
+    for(uint32_t i = 0; i < COUNT; ++i) {
+        tasks[i] = Task::create(nullptr, nullptr);
+        timer.insert(tasks[i], DEADLINES[i]);
+    }
+
+    uint32_t fired = 0;
+    for(uint32_t now = 0; now <= DEADLINES[COUNT - 1]; ++now) {
+        while(Task* task = timer.expire(now)) {
+            for(uint32_t i = 0; i < COUNT; ++i) {
+                if (tasks[i] == task) {
+                    EXPECT_EQ(now, DEADLINES[i]);
+                    fired++;
+                }
+            }
+        }
+    }
+
+    EXPECT_EQ(fired, COUNT);
+    EXPECT_EQ(timer.size(), 0);
+
+    for(uint32_t i = 0; i < COUNT; ++i) {
+        tasks[i]->drop();
+    }
+}
+
+TEST(tasktimer_beyond_span) {
+    TaskTimer timer;
+    Task* task = Task::create(nullptr, nullptr);
+
+    // --> parked on the last level, then re-inserted on the way.
+    const uint32_t deadline = TaskTimer::MAX_SPAN + 1000;
+    timer.insert(task, deadline);
+
+    EXPECT_EQ(stepUntil(timer, task, 0, deadline), deadline);
+    task->drop();
+}
+
+TEST(tasktimer_past_deadline) {
+    TaskTimer timer;
+    Task* task = Task::create(nullptr, nullptr);
+
+    timer.sync(500);
+    timer.insert(task, 100);
+
+    EXPECT(timer.expire(500) == task);
+    task->drop();
+}
+
+TEST(tasktimer_remove) {
+    TaskTimer timer;
+    Task* a = Task::create(nullptr, nullptr);
+    Task* b = Task::create(nullptr, nullptr);
+
+    // --> same slot: unlinking must keep the other one.
+    timer.insert(a, 20);
+    timer.insert(b, 20);
+    timer.remove(a);
+    timer.remove(a);
+
+    EXPECT_EQ(timer.size(), 1);
+    EXPECT(timer.expire(20) == b);
+    EXPECT(timer.expire(20) == nullptr);
+
+    a->drop();
+    b->drop();
+}
+
+TEST(tasktimer_next_timeout) {
+    TaskTimer timer;
+    Task* task = Task::create(nullptr, nullptr);
+
+    EXPECT_EQ(timer.nextTimeout(), -1);
+
+    timer.insert(task, 7);
+    EXPECT_EQ(timer.nextTimeout(), 7);
+    timer.remove(task);
+
+    // --> upper levels: sleep until the level 0 wraps at most.
+    timer.insert(task, 1000);
+    EXPECT_EQ(timer.nextTimeout(), int32_t(TaskTimer::MAX_SLOTS));
+    timer.remove(task);
+
+    task->drop();
+}
+
+TEST(tasktimer_sync_and_wrap) {
+    TaskTimer timer;
+    Task* task = Task::create(nullptr, nullptr);
+
+    // --> idle wheels jump, and deadlines wrap with the millisecond counter.
+    const uint32_t start = 0xfffffff0u;
+    timer.sync(start);
+    timer.insert(task, start + 100);
+
+    EXPECT_EQ(stepUntil(timer, task, start, start + 200), start + 100);
+    task->drop();
+}
+
+/* fired tasks, in the order their callbacks ran. */
+struct SFired {
+    static constexpr uint32_t MAX_FIRES = 256;
+
+    uint32_t ids[MAX_FIRES];
+    uint32_t ms[MAX_FIRES];
+    uint32_t count;
+};
+
+static SFired g_fired;
+
+static void onFired(const Task* task) {
+    if (g_fired.count < SFired::MAX_FIRES) {
+        g_fired.ids[g_fired.count] = uint32_t(uintptr_t(task->getUser()));
+        g_fired.ms[g_fired.count++] = to_ms_since_boot(get_absolute_time());
+    }
+}
+
+/* create a task that reports its id when fired, run by steals. */
+static Task* createTimed(uint32_t id) {
+    Task* task = Task::create(onFired, (void*) uintptr_t(id));
+
+    task->setShared(true);
+    return task;
+}
+
+/* move the clock by `ms`, fire timers as core1 does, and run what fired. */
+static void advance(uint32_t ms) {
+    TaskQueue* queue = TaskQueue::get();
+
+    stub_time_us += ms * 1000ull;
+    queue->fireTimers();
+
+    queue->setSharing(true);
+    while(queue->stealOnce());
+    queue->setSharing(false);
+}
+
+TEST(tasktimer_queue_fires_in_order) {
+    static const uint32_t DELAYS[] = { 5, 1, 70, 3, 4, 300 };
+    static constexpr uint32_t COUNT = sizeof(DELAYS) / sizeof(DELAYS[0]);
+
+    Task* tasks[COUNT];
+    const uint32_t start = to_ms_since_boot(get_absolute_time());
+
+    g_fired.count = 0;
+    for(uint32_t i = 0; i < COUNT; ++i) {
+        tasks[i] = createTimed(i);
+        EXPECT(tasks[i]->scheduleAfter(DELAYS[i]));
+    }
+
+    for(uint32_t i = 0; i < 400; ++i) {
+        advance(1);
+    }
+
+    // --> by deadline, on the exact millisecond, across wheel levels.
+    static const uint32_t ORDER[] = { 1, 3, 4, 0, 2, 5 };
+    EXPECT_EQ(g_fired.count, COUNT);
+
+    for(uint32_t i = 0; i < COUNT; ++i) {
+        EXPECT_EQ(g_fired.ids[i], ORDER[i]);
+        EXPECT_EQ(g_fired.ms[i] - start, DELAYS[ORDER[i]]);
+    }
+
+    for(uint32_t i = 0; i < COUNT; ++i) {
+        EXPECT(tasks[i]->isScheduled() == false);
+        tasks[i]->drop();
+    }
+}
+
+TEST(tasktimer_every_never_drifts) {
+    Task* task = createTimed(0);
+    const uint32_t start = to_ms_since_boot(get_absolute_time());
+
+    g_fired.count = 0;
+    EXPECT(task->scheduleEvery(0) == false);
+    EXPECT(task->scheduleEvery(10));
+
+    // --> polled every 3 ms: each fire within a poll of its deadline.
+    for(uint32_t i = 0; i < 333; ++i) {
+        advance(3);
+    }
+
+    EXPECT_EQ(g_fired.count, 99);
+
+    uint32_t drifts = 0;
+    for(uint32_t i = 0; i < g_fired.count; ++i) {
+        const uint32_t late = g_fired.ms[i] - start - (i + 1) * 10;
+
+        if (late >= 3) {
+            drifts++;
+        }
+    }
+
+    EXPECT_EQ(drifts, 0);
+    EXPECT(task->cancel());
+    task->drop();
+}
+
+TEST(tasktimer_every_skips_after_stall) {
+    Task* task = createTimed(0);
+    const uint32_t start = to_ms_since_boot(get_absolute_time());
+
+    g_fired.count = 0;
+    task->scheduleEvery(10);
+
+    advance(10);
+    EXPECT_EQ(g_fired.count, 1);
+
+    // --> five periods late: fired once, not five times in a burst.
+    advance(55);
+    EXPECT_EQ(g_fired.count, 2);
+
+    // --> then a period from the late fire.
+    advance(9);
+    EXPECT_EQ(g_fired.count, 2);
+
+    advance(1);
+    EXPECT_EQ(g_fired.count, 3);
+    EXPECT_EQ(g_fired.ms[2] - start, 75);
+
+    EXPECT(task->cancel());
+    EXPECT(task->isScheduled() == false);
+
+    advance(100);
+    EXPECT_EQ(g_fired.count, 3);
+    task->drop();
+}
@@ -0,0 +1,133 @@
+#include "test.h"
+#include "task/task.h"
+#include "task/taskqueue.h"
+#include "task/taskstats.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <stdio.h>
+
+typedef std::chrono::steady_clock clock_type;
+
+/* spawned from core0, run by core1. */
+struct SWake {
+    std::atomic<uint32_t> runs;
+    std::atomic<uint32_t> core;
+    clock_type::time_point ran;
+};
+
+static void onWake(const Task* task) {
+    SWake* wake = (SWake*) task->getUser();
+
+    wake->ran = clock_type::now();
+    wake->core = get_core_num();
+    wake->runs++;
+}
+
+/* wait for `runs` runs, returns false after a second. */
+static bool waitRuns(const SWake& wake, uint32_t runs) {
+    const auto until = clock_type::now() + std::chrono::seconds(1);
+
+    while(wake.runs < runs) {
+        if (clock_type::now() > until) {
+            return false;
+        }
+
+        std::this_thread::yield();
+    }
+
+    return true;
+}
+
+/* get the count of WFEs that really waited. */
+static uint32_t getWaits() {
+    std::lock_guard<std::mutex> guard(stub_event->lock);
+    return stub_event->waits;
+}
+
+/* test whether core1 waits in WFE now. */
+static bool isAsleep() {
+    std::lock_guard<std::mutex> guard(stub_event->lock);
+    return stub_event->sleepers != 0;
+}
+
+TEST(taskwake_core1_starts) {
+    // --> returns once core1 runs its loop.
+    TaskQueue::prepare();
+}
+
+TEST(taskwake_spawn_runs_on_core1) {
+    static SWake wake;
+
+    Task::instant(onWake, &wake);
+
+    EXPECT(waitRuns(wake, 1));
+    EXPECT_EQ(wake.core, 1);
+}
+
+TEST(taskwake_idle_core1_sleeps) {
+    // --> nothing to do: core1 waits in WFE instead of polling.
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    const uint32_t waits = getWaits();
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT(getWaits() - waits <= 1);
+}
+
+TEST(taskwake_no_lost_wakeups) {
+    static constexpr uint32_t COUNT = 20000;
+    static SWake wake;
+
+    // --> one at a time: every spawn must wake a sleeping core1.
+    uint32_t lost = 0;
+    for(uint32_t i = 1; i <= COUNT; ++i) {
+        Task::instant(onWake, &wake);
+
+        if (waitRuns(wake, i) == false) {
+            lost++;
+            break;
+        }
+    }
+
+    EXPECT_EQ(lost, 0);
+}
+
+TEST(taskwake_latency) {
+    static constexpr uint32_t COUNT = 5000;
+    static SWake wake;
+
+    uint32_t hist[TaskStats::MAX_BUCKETS] = { 0, };
+    uint32_t maxUs = 0, timeouts = 0;
+
+    for(uint32_t i = 1; i <= COUNT; ++i) {
+        // --> measured from sleep: let core1 go back to WFE first.
+        while(isAsleep() == false) {
+            std::this_thread::yield();
+        }
+
+        const auto spawned = clock_type::now();
+        Task::instant(onWake, &wake);
+
+        if (waitRuns(wake, i) == false) {
+            timeouts++;
+            break;
+        }
+
+        const uint32_t us = uint32_t(std::chrono::duration_cast<std::chrono::microseconds>(wake.ran - spawned).count());
+
+        hist[TaskStats::bucketOf(us)]++;
+        if (us > maxUs) {
+            maxUs = us;
+        }
+    }
+
+    EXPECT_EQ(timeouts, 0);
+
+    // --> spawn-to-execute, log2 us buckets: [2^(n-1), 2^n).
+    printf("  spawn to execute, %u spawns, max %u us:\n", COUNT, maxUs);
+    for(uint32_t b = 0; b < TaskStats::MAX_BUCKETS; ++b) {
+        if (hist[b]) {
+            printf("    < %6u us: %u\n", 1u << b, hist[b]);
+        }
+    }
+}
@@ -0,0 +1,70 @@
+#include "test.h"
+#include <stdio.h>
+
+TestRunner::TestRunner() {
+    _head = _tail = nullptr;
+    _current = nullptr;
+    _failures = 0;
+}
+
+TestRunner* TestRunner::get() {
+    static TestRunner _runner;
+    return &_runner;
+}
+
+bool TestRunner::add(STestCase* test) {
+    test->next = nullptr;
+
+    // --> keep the declaration order of each file.
+    if (_tail) {
+        _tail->next = test;
+    }
+
+    else {
+        _head = test;
+    }
+
+    _tail = test;
+    return true;
+}
+
+void TestRunner::fail(const char* file, int line, const char* expr, uint64_t a, uint64_t b) {
+    printf("  FAIL %s:%d: %s", file, line, expr);
+
+    if (a != b) {
+        printf(" (%llu != %llu)", (unsigned long long) a, (unsigned long long) b);
+    }
+
+    printf("\n");
+    _failures++;
+}
+
+int TestRunner::runAll() {
+    uint32_t count = 0, failed = 0;
+
+    for(const STestCase* test = _head; test; test = test->next) {
+        const uint32_t failures = _failures;
+
+        _current = test;
+        test->run();
+
+        if (_failures != failures) {
+            printf("[FAIL] %s\n", test->name);
+            failed++;
+        }
+
+        else {
+            printf("[ OK ] %s\n", test->name);
+        }
+
+        count++;
+    }
+
+    _current = nullptr;
+    printf("%u tests, %u failed.\n", count, failed);
+    return failed ? 1 : 0;
+}
+
+int main() {
+    return TestRunner::get()->runAll();
+}
@@ -0,0 +1,66 @@
+#ifndef __TEST_TEST_H__
+#define __TEST_TEST_H__
+
+#include <stdint.h>
+
+/**
+ * host test case, registered by `TEST()` before `main` runs.
+ */
+struct STestCase {
+    const char* name;
+    void (*run)();
+    STestCase* next;
+};
+
+/**
+ * host test runner.
+ * runs every registered case in order, and fails the process if any
+ * expectation failed, so `ctest` reports it.
+ */
+class TestRunner {
+private:
+    STestCase* _head;
+    STestCase* _tail;
+    const STestCase* _current;
+    uint32_t _failures;
+
+private:
+    TestRunner();
+
+public:
+    /* get the singleton instance. */
+    static TestRunner* get();
+
+public:
+    /* register a test case. */
+    bool add(STestCase* test);
+
+    /* report a failed expectation of the running case. */
+    void fail(const char* file, int line, const char* expr, uint64_t a = 0, uint64_t b = 0);
+
+    /* run all test cases, returns the exit code. */
+    int runAll();
+};
+
+#define TEST(name) \
+    static void test_##name(); \
+    static STestCase __TEST_##name = { #name, test_##name, nullptr }; \
+    static const bool __TEST_REG_##name = TestRunner::get()->add(&__TEST_##name); \
+    static void test_##name()
+
+#define EXPECT(expr) \
+    do { \
+        if (!(expr)) { \
+            TestRunner::get()->fail(__FILE__, __LINE__, #expr); \
+        } \
+    } while(0)
+
+#define EXPECT_EQ(a, b) \
+    do { \
+        const uint64_t __A__ = uint64_t(a), __B__ = uint64_t(b); \
+        if (__A__ != __B__) { \
+            TestRunner::get()->fail(__FILE__, __LINE__, #a " == " #b, __A__, __B__); \
+        } \
+    } while(0)
+
+#endif
@@ -1,6 +1,7 @@
 #include "tft.h"
 #include "../board/config.h"
 #include "../task/task.h"
+#include "../task/taskqueue.h"
 #include "hardware/pwm.h"
 #include <stdio.h>
 #include <stdarg.h>
@@ -9,6 +10,7 @@ Tft::Tft() {
     _backlight = 1.0f;
     _pwmValue = 0;
     _mode = ETFTM_TTY;
+    _drawPos = 0;
 
     for(uint16_t i = 0; i < MAX_BUF; ++i) {
         _ttyBuf[i].fg = TFT_FONT_COLOR;
@@ -64,49 +66,75 @@ void Tft::applyPwm() {
     }
 }
 
-void Tft::redraw() {
+void Tft::markDirty() {
+    _dirty = 1;
+
+    // --> wake core1 up to redraw.
+    TaskQueue::wakeup();
+}
+
+bool Tft::redraw() {
     uint8_t mode = _mode;
     if (_prevMode != mode) {
         _prevMode = mode;
         _dirty = 1;
+        _drawPos = 0;
         _tft.TFTfillScreen(TFT_SCREEN_COLOR);
+        return true;
     }
 
-    if (_dirty == 0) {
-        return;
-    }
+    // --> start a new pass only if dirty.
+    if (_drawPos == 0) {
+        if (_dirty == 0) {
+            return false;
+        }
 
-    _dirty = 0;
+        _dirty = 0;
+    }
 
     if (mode != ETFTM_TTY) {
-        drawGrp();
-        return;
+        _drawPos = drawGrp(_drawPos);
+        return true;
     }
 
     //_tft.TFTdrawText(10, 10, "hello", TFT_FONT_COLOR, TFT_SCREEN_COLOR, 2);
-    drawTty();
+    _drawPos = drawTty(_drawPos);
+    return true;
 }
 
-void Tft::drawGrp() {
-    _tft.TFTdrawBitmap16Data(0, 0,
-        (uint8_t*) _graphicBuf,
-        MAX_GRP_COL, MAX_GRP_ROW);
+uint8_t Tft::drawGrp(uint8_t chunk) {
+    const uint32_t row = chunk * GRP_CHUNK_ROW;
+
+    _tft.TFTdrawBitmap16Data(0, row,
+        (uint8_t*) &_graphicBuf[row * MAX_GRP_COL],
+        MAX_GRP_COL, GRP_CHUNK_ROW);
+
+    if (row + GRP_CHUNK_ROW >= MAX_GRP_ROW) {
+        return 0;
+    }
+
+    return chunk + 1;
 }
 
-void Tft::drawTty() {
-    for(uint8_t row = 0; row < MAX_ROW; ++row) {
-        const uint32_t offset = MAX_COL * row;
+uint8_t Tft::drawTty(uint8_t chunk) {
+    const uint8_t row = chunk;
+    const uint32_t offset = MAX_COL * row;
 
-        for(uint8_t col = 0; col < MAX_COL; ++col) {
-            const STftChar& ch = _ttyBuf[offset + col];
-            const char value = ch.ch ? ch.ch : ' ';
+    for(uint8_t col = 0; col < MAX_COL; ++col) {
+        const STftChar& ch = _ttyBuf[offset + col];
+        const char value = ch.ch ? ch.ch : ' ';
 
-            _tft.TFTdrawChar(
-                col * 11, row * 20,
-                value, ch.fg, ch.bg, 2
-            );
-        }
+        _tft.TFTdrawChar(
+            col * 11, row * 20,
+            value, ch.fg, ch.bg, 2
+        );
+    }
+
+    if (row + 1 >= MAX_ROW) {
+        return 0;
     }
+
+    return chunk + 1;
 }
 
 void Tft::mode(uint8_t mode) {
@@ -116,7 +144,7 @@ void Tft::mode(uint8_t mode) {
 
     if (_mode != mode) {
         _mode = mode;
-        _dirty = 1;
+        markDirty();
     }
 }
 
@@ -159,7 +187,7 @@ void Tft::scroll(uint8_t n) {
 
     // --> move position to begining of line.
     _ttyPos = lp * MAX_COL;
-    _dirty = 1;
+    markDirty();
 }
 
 void Tft::clear() {
@@ -183,7 +211,7 @@ void Tft::clear() {
     }
 
     _ttyPos = 0;    
-    _dirty = 1;
+    markDirty();
 }
 
 void Tft::print(const char* format, ...) {
@@ -207,7 +235,7 @@ void Tft::printText(const char* text) {
         printChar(*text++);
     }
     
-    _dirty = 1;
+    markDirty();
 }
 
 void Tft::printChar(char ch) {
@@ -233,7 +261,7 @@ void Tft::printChar(char ch) {
     _ttyBuf[pos].fg = _ttyFg;
     _ttyBuf[pos].bg = _ttyBg;
 
-    _dirty = 1;
+    markDirty();
 }
 
 uint16_t Tft::getPixel(uint8_t x, uint8_t y) {
@@ -250,7 +278,7 @@ void Tft::setPixel(uint8_t x, uint8_t y, uint16_t value) {
     }
 
     _graphicBuf[uint16_t(y) * MAX_GRP_COL + x] = value;
-    _dirty = 1;
+    markDirty();
 }
 
 void Tft::drawBitmap(int16_t x, int16_t y, const uint16_t* data, uint8_t w, uint8_t h) {
@@ -292,7 +320,7 @@ void Tft::drawBitmap(int16_t x, int16_t y, const uint16_t* data, uint8_t w, uint
 
         uint16_t* dst = &_graphicBuf[x + ay * MAX_COL];
         memcpy(dst, row, rowLen * sizeof(uint16_t));
-        _dirty = 1;
+        markDirty();
     }
     
 }
\ No newline at end of file
@@ -43,6 +43,9 @@ private:
     static constexpr uint32_t MAX_GRP_ROW = 80;
     static constexpr uint32_t MAX_GRP_BUF = MAX_GRP_COL * MAX_GRP_ROW;
 
+    /* graphic rows per redraw chunk. */
+    static constexpr uint32_t GRP_CHUNK_ROW = 10;
+
 private:
     ST7735_TFT _tft;
     float _backlight;                   // --> backlight brightness, 0.0f to 1.0f.
@@ -55,7 +58,8 @@ private:
 
     uint16_t _graphicBuf[MAX_GRP_BUF];   // --> graphic buffer.
     STftChar _ttyBuf[MAX_BUF];          // --> TTY buffer.
-    int32_t _dirty;
+    volatile int32_t _dirty;
+    uint8_t _drawPos;                   // --> next chunk to draw, 0: idle.
 
 private:
     Tft();
@@ -67,12 +71,22 @@ private:
     void setupGpio();
     void applyPwm();
 
+    /* mark the display dirty and ring the core1 doorbell. */
+    void markDirty();
+
 protected:
-    void redraw();
+    /* redraw a chunk, returns false if nothing to draw. */
+    bool redraw();
+
+    /* test whether redraw is needed or not. */
+    bool isDirty() const { 
+        return _dirty != 0 || _prevMode != _mode || _drawPos != 0;
+    }
     
 private:
-    void drawGrp();
-    void drawTty();
+    /* draw a chunk and return the next chunk, 0 if done. */
+    uint8_t drawGrp(uint8_t chunk);
+    uint8_t drawTty(uint8_t chunk);
 
 public:
     /* get the raw device. */